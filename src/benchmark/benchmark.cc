@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "../model/model.h"
+
+namespace {
+
+constexpr size_t kPointsCount = 1 << 20;  ///< Количество точек развертки.
+
+constexpr int kRepeats = 10;  ///< Количество повторов, берется лучшее время.
+
+/**
+ * @brief Развертка выражения по одной переменной.
+ */
+struct Sweep {
+  const char *name;        ///< Название замера.
+  const char *expression;  ///< Выражение.
+  bool scalar;             ///< Вычислять по одной точке, а не пакетно.
+  bool jit = false;        ///< Вычислять машинным кодом JIT.
+};
+
+/**
+ * @brief Замер одной развертки.
+ * @return Миллионов точек в секунду (лучший из kRepeats повторов).
+ * @details Развертка идет по иксу, остальные переменные равны 2, 10 и т.д.
+ * по порядку появления.
+ */
+double Measure(const s21::PolishNotation &calculator, const Sweep &sweep) {
+  s21::CompiledExpression expression = calculator.Compile(sweep.expression);
+  expression.SetJitMode(sweep.jit ? s21::CompiledExpression::jit_always
+                                  : s21::CompiledExpression::jit_off);
+  const std::vector<std::string> &variables = expression.GetVariables();
+  size_t slot = std::find(variables.begin(), variables.end(), "x") -
+                variables.begin();
+  std::vector<double> bindings(variables.size() + 1);
+  for (size_t i = 0; i < bindings.size(); ++i) {
+    bindings[i] = i == 0 ? 2 : 10 * i;
+  }
+  std::vector<double> x_values(kPointsCount);
+  std::vector<double> results(kPointsCount);
+  for (size_t i = 0; i < kPointsCount; ++i) {
+    x_values[i] = 0.001 + 10.0 * i / kPointsCount;
+  }
+
+  double best = 0;
+  for (int repeat = 0; repeat < kRepeats; ++repeat) {
+    auto start = std::chrono::steady_clock::now();
+    if (sweep.scalar) {
+      for (size_t i = 0; i < kPointsCount; ++i) {
+        bindings[slot] = x_values[i];
+        results[i] = expression.Evaluate(bindings.data(), bindings.size());
+      }
+    } else {
+      expression.Evaluate(bindings.data(), slot, x_values.data(),
+                          results.data(), kPointsCount);
+    }
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    best = std::max(best, kPointsCount / elapsed.count() / 1e6);
+  }
+  return best;
+}
+
+}  // namespace
+
+/**
+ * @brief Воспроизводимый замер оптимизаций выражений в одном потоке.
+ * @details Пары замеров сравнивают выражение, которое оптимизатор сворачивает
+ * в константы, с тем же выражением, где константы - переменные, и пакетную
+ * развертку, где не зависящие от икса подвыражения считаются один раз на
+ * блок, с вычислением по одной точке. Последние пары сравнивают пакетную
+ * развертку блоками интерпретатора с векторной пакетной функцией JIT.
+ */
+int main() {
+  const Sweep sweeps[] = {
+      {"folded constants, batch", "sqrt(2) * sin(x) + ln(10)^2 - (-x)", false},
+      {"constants as variables, batch", "sqrt(a) * sin(x) + ln(b)^2 - (-x)",
+       false},
+      {"constants as variables, scalar", "sqrt(a) * sin(x) + ln(b)^2 - (-x)",
+       true},
+      {"invariant subtree, batch", "sin(a) * cos(a) * x + atan(a)", false},
+      {"invariant subtree, scalar", "sin(a) * cos(a) * x + atan(a)", true},
+      {"arithmetic, batch", "x*x + 2*x/3 - x", false},
+      {"arithmetic, JIT batch", "x*x + 2*x/3 - x", false, true},
+      {"functions, batch", "sin(x)*x + cos(x)", false},
+      {"functions, JIT batch", "sin(x)*x + cos(x)", false, true},
+      {"roots and powers, batch", "sqrt(x) * (x + 1) / (x - 3) + x^2.5",
+       false},
+      {"roots and powers, JIT batch", "sqrt(x) * (x + 1) / (x - 3) + x^2.5",
+       false, true},
+  };
+  s21::PolishNotation calculator;
+  std::printf("%-32s %s\n", "sweep", "Mpoints/s");
+  for (const Sweep &sweep : sweeps) {
+    std::printf("%-32s %9.1f\n", sweep.name, Measure(calculator, sweep));
+  }
+  return 0;
+}
@@ -0,0 +1,304 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../controller/controller.h"
+
+namespace {
+
+constexpr size_t kBlockSize = 1 << 22;  ///< Размер блока чтения (4 МБ).
+
+constexpr int kExitLineErrors = 1;  ///< Код возврата, если в каких-то строках
+                                    ///< были ошибки.
+
+constexpr int kExitFailure = 2;  ///< Код возврата при ошибке аргументов или
+                                 ///< ввода-вывода.
+
+/**
+ * @brief Параметры запуска.
+ */
+struct Options {
+  size_t threads_count = 0;         ///< Количество потоков (ноль - все ядра).
+  char separator = ';';             ///< Разделитель выражения и икса.
+  std::vector<const char *> files;  ///< Входные файлы ("-" - stdin).
+  const char *column_expression = nullptr;  ///< Выражение для режима
+                                            ///< столбцов (nullptr - режим
+                                            ///< строк).
+};
+
+/**
+ * @brief Потоковый вычислитель строк: копит строки блока, вычисляет их
+ * контроллером и пишет ответы в stdout в порядке ввода.
+ */
+class LineEvaluator {
+ public:
+  LineEvaluator(s21::Controller &controller, char separator)
+      : controller_(controller), separator_(separator) {}
+
+  bool EvaluateStream(int input);
+
+  bool HasLineErrors() const { return has_line_errors_; }
+
+ private:
+  void AddLine(std::string_view line);
+
+  void Flush();
+
+  s21::Controller &controller_;  ///< Контроллер для вычислений.
+
+  char separator_;  ///< Разделитель выражения и икса.
+
+  bool has_line_errors_ = false;  ///< Были ли строки с ошибками.
+
+  std::vector<std::string_view> expressions_;  ///< Выражения блока.
+
+  std::vector<std::string_view> x_values_;  ///< Иксы блока.
+
+  std::vector<s21::Result<double>> results_;  ///< Результаты блока.
+
+  std::string output_;  ///< Текст ответов блока.
+};
+
+/**
+ * @brief Удаление пробельных символов по краям строки.
+ */
+std::string_view Trim(std::string_view text) {
+  size_t begin = text.find_first_not_of(" \t\r");
+  if (begin == std::string_view::npos) {
+    return {};
+  }
+  size_t end = text.find_last_not_of(" \t\r");
+  return text.substr(begin, end - begin + 1);
+}
+
+/**
+ * @brief Разбор строки на выражение и необязательный икс после последнего
+ * разделителя.
+ */
+void LineEvaluator::AddLine(std::string_view line) {
+  size_t separator = line.rfind(separator_);
+  if (separator == std::string_view::npos) {
+    expressions_.push_back(Trim(line));
+    x_values_.emplace_back();
+  } else {
+    expressions_.push_back(Trim(line.substr(0, separator)));
+    x_values_.push_back(Trim(line.substr(separator + 1)));
+  }
+}
+
+/**
+ * @brief Вычисление накопленных строк и вывод ответов.
+ * @details Строки вычисляются одним вызовом в пуле потоков модели, ответы
+ * форматируются кратчайшим точным представлением (to_chars) в общий буфер и
+ * выводятся одной записью, чтобы ответы на уже прочитанные строки не ждали
+ * конца ввода. Пустая строка дает пустую строку ответа.
+ */
+void LineEvaluator::Flush() {
+  size_t count = expressions_.size();
+  results_.assign(count, s21::Result<double>(0.0));
+  controller_.TryCalculateMany(expressions_.data(), x_values_.data(), count,
+                               results_.data());
+  output_.clear();
+  char number[32];
+  for (size_t i = 0; i < count; ++i) {
+    if (expressions_[i].empty()) {
+      output_ += '\n';
+      continue;
+    }
+    if (results_[i]) {
+      std::to_chars_result written = std::to_chars(
+          number, number + sizeof(number), results_[i].GetValue());
+      output_.append(number, written.ptr);
+    } else {
+      has_line_errors_ = true;
+      output_ += "error: ";
+      output_ += results_[i].GetError().GetMessage();
+    }
+    output_ += '\n';
+  }
+  std::fwrite(output_.data(), 1, output_.size(), stdout);
+  std::fflush(stdout);
+  expressions_.clear();
+  x_values_.clear();
+}
+
+/**
+ * @brief Вычисление всех строк потока.
+ * @param input Дескриптор входного файла.
+ * @return false при ошибке чтения.
+ * @details Поток читается блоками до kBlockSize; read возвращает то, что уже
+ * есть в канале, поэтому из медленного канала строки вычисляются по мере
+ * поступления, а из файла - большими блоками. Неполная последняя строка
+ * блока переносится в начало буфера и дочитывается со следующим блоком, так
+ * что память не зависит от размера входа.
+ */
+bool LineEvaluator::EvaluateStream(int input) {
+  std::vector<char> buffer(kBlockSize);
+  size_t filled = 0;
+  bool end_of_input = false;
+  while (!end_of_input) {
+    if (filled == buffer.size()) {
+      buffer.resize(buffer.size() * 2);
+    }
+    ssize_t read_count =
+        read(input, buffer.data() + filled, buffer.size() - filled);
+    if (read_count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    filled += read_count;
+    end_of_input = read_count == 0;
+
+    std::string_view text(buffer.data(), filled);
+    size_t line_begin = 0;
+    for (size_t line_end = text.find('\n'); line_end != std::string_view::npos;
+         line_end = text.find('\n', line_begin)) {
+      AddLine(text.substr(line_begin, line_end - line_begin));
+      line_begin = line_end + 1;
+    }
+    if (end_of_input && line_begin < filled) {
+      AddLine(text.substr(line_begin));
+      line_begin = filled;
+    }
+    if (!expressions_.empty()) {
+      Flush();
+    }
+    std::memmove(buffer.data(), buffer.data() + line_begin,
+                 filled - line_begin);
+    filled -= line_begin;
+  }
+  return true;
+}
+
+/**
+ * @brief Вывод справки о запуске.
+ */
+void PrintUsage(std::FILE *stream) {
+  std::fputs(
+      "Usage: smartcalc-cli [-j THREADS] [-d SEPARATOR] [FILE...]\n"
+      "       smartcalc-cli [-j THREADS] --column EXPRESSION INPUT OUTPUT\n"
+      "Evaluates one expression per line of FILEs (or stdin) and prints one\n"
+      "result per line. A line may end with SEPARATOR (';' by default) and\n"
+      "a value of x: \"sin(x) * 2; 0.5\".\n"
+      "With --column, evaluates EXPRESSION for every x in INPUT, a raw array\n"
+      "of native float64, and writes the results to OUTPUT in the same\n"
+      "format.\n"
+      "Exit status: 0 on success, 1 if some lines failed, 2 on usage or\n"
+      "I/O errors.\n",
+      stream);
+}
+
+/**
+ * @brief Разбор аргументов командной строки.
+ * @return false, если аргументы некорректны.
+ */
+bool ParseOptions(int argc, char *argv[], Options &options) {
+  for (int i = 1; i < argc; ++i) {
+    std::string_view argument = argv[i];
+    if ((argument == "-j" || argument == "-d" || argument == "--column") &&
+        i + 1 == argc) {
+      return false;
+    }
+    if (argument == "--column") {
+      options.column_expression = argv[++i];
+    } else if (argument == "-j") {
+      std::string_view value = argv[++i];
+      std::from_chars_result parsed = std::from_chars(
+          value.data(), value.data() + value.size(), options.threads_count);
+      if (parsed.ec != std::errc() ||
+          parsed.ptr != value.data() + value.size()) {
+        return false;
+      }
+    } else if (argument == "-d") {
+      std::string_view value = argv[++i];
+      if (value.size() != 1) {
+        return false;
+      }
+      options.separator = value[0];
+    } else if (argument == "-h" || argument == "--help") {
+      PrintUsage(stdout);
+      std::exit(EXIT_SUCCESS);
+    } else if (argument.size() > 1 && argument[0] == '-') {
+      return false;
+    } else {
+      options.files.push_back(argv[i]);
+    }
+  }
+  if (options.column_expression != nullptr) {
+    return options.files.size() == 2;
+  }
+  if (options.files.empty()) {
+    options.files.push_back("-");
+  }
+  return true;
+}
+
+/**
+ * @brief Режим столбцов: вычисление выражения по файлу иксов в файл
+ * результатов.
+ * @return Код возврата.
+ * @details Одно выражение вычисляется для миллионов иксов, поэтому включается
+ * JIT.
+ */
+int EvaluateColumn(s21::Controller &controller, const Options &options) {
+  controller.SetJitMode(s21::CompiledExpression::jit_auto);
+  try {
+    controller.EvaluateColumn(options.column_expression, options.files[0],
+                              options.files[1]);
+  } catch (const std::exception &ex) {
+    std::fprintf(stderr, "smartcalc-cli: %s\n", ex.what());
+    return kExitFailure;
+  }
+  return EXIT_SUCCESS;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  Options options;
+  if (!ParseOptions(argc, argv, options)) {
+    PrintUsage(stderr);
+    return kExitFailure;
+  }
+  s21::Controller controller;
+  controller.SetThreadsCount(options.threads_count);
+  if (options.column_expression != nullptr) {
+    return EvaluateColumn(controller, options);
+  }
+  LineEvaluator evaluator(controller, options.separator);
+  int status = EXIT_SUCCESS;
+  for (const char *file_name : options.files) {
+    bool is_stdin = std::strcmp(file_name, "-") == 0;
+    int input = is_stdin ? STDIN_FILENO : open(file_name, O_RDONLY);
+    if (input < 0) {
+      std::fprintf(stderr, "smartcalc-cli: cannot open %s\n", file_name);
+      status = kExitFailure;
+      continue;
+    }
+    if (!evaluator.EvaluateStream(input)) {
+      std::fprintf(stderr, "smartcalc-cli: cannot read %s\n", file_name);
+      status = kExitFailure;
+    }
+    if (!is_stdin) {
+      close(input);
+    }
+  }
+  if (std::fflush(stdout) != 0) {
+    status = kExitFailure;
+  }
+  if (status == EXIT_SUCCESS && evaluator.HasLineErrors()) {
+    status = kExitLineErrors;
+  }
+  return status;
+}
@@ -9,9 +9,154 @@ namespace s21 {
  * @throw std::invalid_argument В случае некорректности строки.
  * @return Число - вычисленный ответ.
  */
-double Controller::CalculateValue(std::string &expression, std::string &x) {
-  model_.Calculate(expression, x);
-  return model_.GetAnswer();
+double Controller::CalculateValue(const std::string &expression,
+                                  const std::string &x) {
+  return model_.Calculate(*GetCompiled(expression), x);
+}
+
+/**
+ * @brief Компиляция выражения для многократного вычисления.
+ * @param expression Строка с выражением.
+ * @throw std::invalid_argument В случае некорректности строки.
+ * @return Скомпилированное выражение, вычисляемое без повторного разбора.
+ */
+CompiledExpression Controller::CompileExpression(
+    const std::string &expression) {
+  return *GetCompiled(expression);
+}
+
+/**
+ * @brief Символьная производная выражения в виде строки.
+ * @param expression Строка с выражением.
+ * @param variable Имя переменной дифференцирования.
+ * @param order Порядок производной.
+ * @throw std::invalid_argument В случае некорректности строки.
+ * @return Строка с упрощенной производной.
+ */
+std::string Controller::DifferentiateExpression(const std::string &expression,
+                                                const std::string &variable,
+                                                size_t order) {
+  return model_.Differentiate(expression, variable, order);
+}
+
+/**
+ * @brief Символьная производная выражения, скомпилированная для
+ * многократного вычисления.
+ * @param expression Строка с выражением.
+ * @param variable Имя переменной дифференцирования.
+ * @param order Порядок производной.
+ * @throw std::invalid_argument В случае некорректности строки.
+ * @return Скомпилированная производная. Она проходит те же оптимизации и
+ * попадает в тот же кэш, что и обычные выражения.
+ */
+CompiledExpression Controller::CompileDerivative(const std::string &expression,
+                                                 const std::string &variable,
+                                                 size_t order) {
+  return *GetCompiled(model_.Differentiate(expression, variable, order));
+}
+
+/**
+ * @brief Вычисление выражения без исключений.
+ * @param expression Строка с выражением для вычисления.
+ * @param x Строка со значением икса.
+ * @return Вычисленный ответ или ошибка с кодом и позицией в строке.
+ */
+Result<double> Controller::TryCalculateValue(const std::string &expression,
+                                             const std::string &x) noexcept {
+  Result<ExpressionCache::ExpressionPtr> compiled = TryGetCompiled(expression);
+  if (!compiled) {
+    return compiled.GetError();
+  }
+  return model_.TryCalculate(*compiled.GetValue(), x);
+}
+
+/**
+ * @brief Компиляция выражения без исключений.
+ * @param expression Строка с выражением.
+ * @return Скомпилированное выражение или ошибка с кодом и позицией в строке.
+ */
+Result<CompiledExpression> Controller::TryCompileExpression(
+    const std::string &expression) noexcept {
+  Result<ExpressionCache::ExpressionPtr> compiled = TryGetCompiled(expression);
+  if (!compiled) {
+    return compiled.GetError();
+  }
+  return *compiled.GetValue();
+}
+
+/**
+ * @brief Пакетное вычисление выражения для массива значений икса.
+ * @param expression Строка с выражением.
+ * @param x_values Значения икса.
+ * @param results Вектор для вычисленных значений (по одному на каждый икс).
+ * @throw std::invalid_argument В случае некорректности строки.
+ */
+void Controller::CalculateBatch(const std::string &expression,
+                                const std::vector<double> &x_values,
+                                std::vector<double> &results) {
+  CalculationError error = TryCalculateBatch(expression, x_values, results);
+  if (error.code != err_none) {
+    error.Throw();
+  }
+}
+
+/**
+ * @brief Пакетное вычисление выражения без исключений.
+ * @param expression Строка с выражением.
+ * @param x_values Значения икса.
+ * @param results Вектор для вычисленных значений (по одному на каждый икс).
+ * @return Ошибка (err_none, если выражение корректно).
+ */
+CalculationError Controller::TryCalculateBatch(
+    const std::string &expression, const std::vector<double> &x_values,
+    std::vector<double> &results) noexcept {
+  Result<ExpressionCache::ExpressionPtr> compiled = TryGetCompiled(expression);
+  if (!compiled) {
+    return compiled.GetError();
+  }
+  try {
+    results.resize(x_values.size());
+  } catch (const std::bad_alloc &ex) {
+    return {err_out_of_memory};
+  }
+  compiled.GetValue()->Evaluate(x_values.data(), results.data(),
+                                x_values.size());
+  return {};
+}
+
+/**
+ * @brief Вычисление многих независимых выражений без исключений.
+ * @param expressions Массив из count строк с выражениями.
+ * @param x_values Массив из count строк со значениями икса (nullptr, если
+ * иксы не заданы).
+ * @param count Количество выражений.
+ * @param results Массив из count результатов (значение или ошибка).
+ * @details Выражения вычисляются в пуле потоков модели в обход кэша: поток
+ * строк обычно состоит из разных выражений, и общий мьютекс кэша ограничил
+ * бы масштабирование.
+ */
+void Controller::TryCalculateMany(const std::string_view *expressions,
+                                  const std::string_view *x_values,
+                                  size_t count,
+                                  Result<double> *results) noexcept {
+  model_.TryCalculateMany(expressions, x_values, count, results);
+}
+
+/**
+ * @brief Вычисление выражения для столбца иксов из файла в файл.
+ * @param expression Строка с выражением от икса.
+ * @param input_path Файл с иксами (плотный массив double).
+ * @param output_path Файл для результатов (создается или перезаписывается).
+ * @throw std::invalid_argument В случае некорректности строки или ошибки
+ * файлов.
+ * @return Количество вычисленных значений.
+ */
+size_t Controller::EvaluateColumn(const std::string &expression,
+                                  const std::string &input_path,
+                                  const std::string &output_path) {
+  return model_
+      .TryEvaluateColumn(*GetCompiled(expression), input_path, output_path)
+      .GetValueOrThrow();
 }
 
 /**
@@ -21,12 +166,191 @@ double Controller::CalculateValue(std::string &expression, std::string &x) {
  * @param x_max Максимальное значение икса.
  * @param x_data Вектор для выисленных значений X для построения графика.
  * @param y_data Вектор для выисленных значений Y для построения графика.
+ * @param points_count Количество точек графика.
+ * @throw std::invalid_argument В случае некорректности строки.
+ */
+void Controller::GetDataForGraph(const std::string &expression,
+                                 double x_min, double x_max,
+                                 std::vector<double> &x_data,
+                                 std::vector<double> &y_data,
+                                 size_t points_count) {
+  model_.GetGraph(*GetCompiled(expression), x_min, x_max, x_data, y_data,
+                  points_count);
+}
+
+/**
+ * @brief Вычисление значений и производных для графика производной.
+ * @param expression Строка с выражением для вычисления.
+ * @param x_min Минимальное значение икса.
+ * @param x_max Максимальное значение икса.
+ * @param x_data Вектор для вычисленных значений X.
+ * @param y_data Вектор для вычисленных значений Y.
+ * @param dy_data Вектор для вычисленных значений производной.
+ * @param points_count Количество точек графика.
+ * @throw std::invalid_argument В случае некорректности строки.
+ */
+void Controller::GetDataForDerivativeGraph(const std::string &expression,
+                                           double x_min, double x_max,
+                                           std::vector<double> &x_data,
+                                           std::vector<double> &y_data,
+                                           std::vector<double> &dy_data,
+                                           size_t points_count) {
+  model_.GetDerivativeGraph(*GetCompiled(expression), x_min, x_max, x_data,
+                            y_data, dy_data, points_count);
+}
+
+/**
+ * @brief Адаптивное вычисление значений для пострения графика.
+ * @param expression Строка с выражением для вычисления.
+ * @param x_min Минимальное значение икса.
+ * @param x_max Максимальное значение икса.
+ * @param settings Бюджет точек и допустимая погрешность в пикселях.
+ * @param x_data Вектор для выисленных значений X для построения графика.
+ * @param y_data Вектор для выисленных значений Y для построения графика.
+ * @throw std::invalid_argument В случае некорректности строки.
+ */
+void Controller::GetAdaptiveDataForGraph(const std::string &expression,
+                                         double x_min, double x_max,
+                                         const AdaptiveSampling &settings,
+                                         std::vector<double> &x_data,
+                                         std::vector<double> &y_data) {
+  model_.GetAdaptiveGraph(*GetCompiled(expression), x_min, x_max, settings,
+                          x_data, y_data);
+}
+
+/**
+ * @brief Вычисление автоматических границ по Y для графика.
+ * @param expression Строка с выражением для вычисления.
+ * @param x_min Минимальное значение икса.
+ * @param x_max Максимальное значение икса.
+ * @throw std::invalid_argument В случае некорректности строки.
+ * @return Отрезок, содержащий значения функции (пустой, если функция нигде
+ * не определена).
+ */
+Interval Controller::GetRangeForGraph(const std::string &expression,
+                                      double x_min, double x_max) {
+  return model_.GetGraphRange(*GetCompiled(expression), x_min, x_max);
+}
+
+/**
+ * @brief Поиск корней и локальных экстремумов функции.
+ * @param expression Строка с выражением.
+ * @param x_min Минимальное значение икса.
+ * @param x_max Максимальное значение икса.
+ * @param settings Размер сетки сканирования и допустимая ошибка по X.
+ * @throw std::invalid_argument В случае некорректности строки.
+ * @return Корни и экстремумы по возрастанию X.
+ */
+std::vector<CriticalPoint> Controller::FindCriticalPoints(
+    const std::string &expression, double x_min, double x_max,
+    const RootSearch &settings) {
+  return model_.FindCriticalPoints(*GetCompiled(expression), x_min, x_max,
+                                   settings);
+}
+
+/**
+ * @brief Вычисление определенного интеграла.
+ * @param expression Строка с выражением.
+ * @param a Нижний предел.
+ * @param b Верхний предел.
+ * @param settings Допустимая ошибка и бюджет отрезков.
+ * @throw std::invalid_argument В случае некорректности строки или пределов.
+ * @return Значение, оценка ошибки и количество вычислений функции.
+ */
+IntegrationResult Controller::Integrate(const std::string &expression,
+                                        double a, double b,
+                                        const Integration &settings) {
+  return model_.Integrate(*GetCompiled(expression), a, b, settings);
+}
+
+/**
+ * @brief Вычисление значений поверхности z = f(x, y) для тепловой карты.
+ * @param expression Строка с выражением от x и y.
+ * @param grid Сетка.
+ * @param z_data Массив из grid.width * grid.height значений, заполняется по
+ * строкам.
+ * @throw std::invalid_argument В случае некорректности строки или сетки.
+ */
+void Controller::GetDataForSurface(const std::string &expression,
+                                   const SurfaceGrid &grid, double *z_data) {
+  model_.GetSurface(*GetCompiled(expression), grid, z_data);
+}
+
+/**
+ * @brief Задает количество потоков для вычисления графиков.
+ * @param threads_count Количество потоков. Ноль означает количество
+ * аппаратных потоков.
+ */
+void Controller::SetThreadsCount(size_t threads_count) {
+  model_.SetThreadsCount(threads_count);
+}
+
+/**
+ * @brief Задает режим JIT (генерации машинного кода) для выражений.
+ * @param mode Режим: выключен, после порога вычислений или сразу.
+ */
+void Controller::SetJitMode(CompiledExpression::JitMode mode) {
+  model_.SetJitMode(mode);
+  cache_.Clear();
+}
+
+/**
+ * @brief Задает бюджет памяти кэша скомпилированных выражений.
+ * @param memory_budget Бюджет памяти в байтах. Ноль отключает кэш.
+ */
+void Controller::SetCacheBudget(size_t memory_budget) {
+  cache_.SetMemoryBudget(memory_budget);
+}
+
+/**
+ * @brief Функция-геттер, возвращающая статистику кэша выражений.
+ */
+CacheStatistics Controller::GetCacheStatistics() const {
+  return cache_.GetStatistics();
+}
+
+/**
+ * @brief Получение скомпилированного выражения из кэша или компиляция при
+ * промахе.
+ * @param expression Строка с выражением.
  * @throw std::invalid_argument В случае некорректности строки.
+ * @return Скомпилированное выражение.
+ * @details Компиляция идет вне мьютекса кэша, поэтому потоки не ждут друг
+ * друга. Если два потока одновременно промахнулись по одному ключу, в кэше
+ * останется выражение, добавленное последним.
+ */
+ExpressionCache::ExpressionPtr Controller::GetCompiled(
+    const std::string &expression) {
+  return TryGetCompiled(expression).GetValueOrThrow();
+}
+
+/**
+ * @brief Получение скомпилированного выражения без исключений.
+ * @param expression Строка с выражением.
+ * @return Скомпилированное выражение или ошибка.
+ * @details Нормализованный текст служит только ключом кэша, а при промахе
+ * компилируется исходная строка: она дает то же выражение, а позиция ошибки
+ * сразу относится к ней.
  */
-void Controller::GetDataForGraph(std::string &expression, double x_min,
-                                 double x_max, std::vector<double> &x_data,
-                                 std::vector<double> &y_data) {
-  model_.GetGraph(expression, x_min, x_max, x_data, y_data);
+Result<ExpressionCache::ExpressionPtr> Controller::TryGetCompiled(
+    const std::string &expression) noexcept {
+  try {
+    std::string key = model_.Normalize(expression);
+    ExpressionCache::ExpressionPtr compiled = cache_.Find(key);
+    if (compiled) {
+      return compiled;
+    }
+    Result<CompiledExpression> result = model_.TryCompile(expression);
+    if (!result) {
+      return result.GetError();
+    }
+    compiled = std::make_shared<const CompiledExpression>(
+        std::move(result).GetValue());
+    cache_.Insert(key, compiled);
+    return compiled;
+  } catch (const std::bad_alloc &ex) {
+    return err_out_of_memory;
+  }
 }
 
 }  // namespace s21
\ No newline at end of file
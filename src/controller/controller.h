@@ -2,6 +2,7 @@
 #define SMARTCALC_CONTROLLER_H_
 
 #include "../model/model.h"
+#include "expression_cache.h"
 
 namespace s21 {
 /**
@@ -13,14 +14,85 @@ class Controller {
 
   ~Controller() = default;
 
-  double CalculateValue(std::string &expression, std::string &x);
+  double CalculateValue(const std::string &expression, const std::string &x);
 
-  void GetDataForGraph(std::string &expression, double x_min, double x_max,
-                       std::vector<double> &x_data,
-                       std::vector<double> &y_data);
+  CompiledExpression CompileExpression(const std::string &expression);
+
+  std::string DifferentiateExpression(const std::string &expression,
+                                      const std::string &variable = "x",
+                                      size_t order = 1);
+
+  CompiledExpression CompileDerivative(const std::string &expression,
+                                       const std::string &variable = "x",
+                                       size_t order = 1);
+
+  Result<double> TryCalculateValue(const std::string &expression,
+                                   const std::string &x) noexcept;
+
+  Result<CompiledExpression> TryCompileExpression(
+      const std::string &expression) noexcept;
+
+  CalculationError TryCalculateBatch(const std::string &expression,
+                                     const std::vector<double> &x_values,
+                                     std::vector<double> &results) noexcept;
+
+  void TryCalculateMany(const std::string_view *expressions,
+                        const std::string_view *x_values, size_t count,
+                        Result<double> *results) noexcept;
+
+  size_t EvaluateColumn(const std::string &expression,
+                        const std::string &input_path,
+                        const std::string &output_path);
+
+  void CalculateBatch(const std::string &expression,
+                      const std::vector<double> &x_values,
+                      std::vector<double> &results);
+
+  void GetDataForGraph(const std::string &expression, double x_min,
+                       double x_max, std::vector<double> &x_data,
+                       std::vector<double> &y_data, size_t points_count = 500);
+
+  void GetDataForDerivativeGraph(const std::string &expression, double x_min,
+                                 double x_max, std::vector<double> &x_data,
+                                 std::vector<double> &y_data,
+                                 std::vector<double> &dy_data,
+                                 size_t points_count = 500);
+
+  void GetAdaptiveDataForGraph(const std::string &expression, double x_min,
+                               double x_max, const AdaptiveSampling &settings,
+                               std::vector<double> &x_data,
+                               std::vector<double> &y_data);
+
+  Interval GetRangeForGraph(const std::string &expression, double x_min,
+                            double x_max);
+
+  std::vector<CriticalPoint> FindCriticalPoints(
+      const std::string &expression, double x_min, double x_max,
+      const RootSearch &settings = RootSearch());
+
+  IntegrationResult Integrate(const std::string &expression, double a,
+                              double b,
+                              const Integration &settings = Integration());
+
+  void GetDataForSurface(const std::string &expression,
+                         const SurfaceGrid &grid, double *z_data);
+
+  void SetThreadsCount(size_t threads_count);
+
+  void SetJitMode(CompiledExpression::JitMode mode);
+
+  void SetCacheBudget(size_t memory_budget);
+
+  CacheStatistics GetCacheStatistics() const;
 
  private:
+  ExpressionCache::ExpressionPtr GetCompiled(const std::string &expression);
+
+  Result<ExpressionCache::ExpressionPtr> TryGetCompiled(
+      const std::string &expression) noexcept;
+
   PolishNotation model_;
+  ExpressionCache cache_;
 };
 }  // namespace s21
 
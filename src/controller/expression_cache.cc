@@ -0,0 +1,116 @@
+#include "expression_cache.h"
+
+namespace s21 {
+
+/**
+ * @brief Конструктор.
+ * @param memory_budget Бюджет памяти в байтах.
+ */
+ExpressionCache::ExpressionCache(size_t memory_budget)
+    : memory_budget_(memory_budget) {}
+
+/**
+ * @brief Поиск выражения в кэше. Найденное выражение становится самым недавно
+ * использованным, а если для него уже сгенерирован машинный код, его размер
+ * добавляется к оценке памяти записи.
+ * @param key Нормализованный текст выражения.
+ * @return Выражение или nullptr, если его нет в кэше.
+ */
+ExpressionCache::ExpressionPtr ExpressionCache::Find(
+    const std::string &key) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto iter = index_.find(key);
+  if (iter == index_.end()) {
+    ++statistics_.misses;
+    return nullptr;
+  }
+  ++statistics_.hits;
+  entries_.splice(entries_.begin(), entries_, iter->second);
+  Entry &entry = *iter->second;
+  ExpressionPtr expression = entry.expression;
+  if (!entry.jit_counted && expression->IsJitCompiled()) {
+    size_t bytes = GetEntrySize(entry.key, *expression);
+    statistics_.bytes += bytes - entry.bytes;
+    entry.bytes = bytes;
+    entry.jit_counted = true;
+    Evict();
+  }
+  return expression;
+}
+
+/**
+ * @brief Добавление выражения в кэш с вытеснением давно использованных, если
+ * бюджет памяти превышен.
+ * @param key Нормализованный текст выражения.
+ * @param expression Скомпилированное выражение.
+ */
+void ExpressionCache::Insert(const std::string &key, ExpressionPtr expression) {
+  bool jit_counted = expression->IsJitCompiled();
+  size_t bytes = GetEntrySize(key, *expression);
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto iter = index_.find(key);
+  if (iter != index_.end()) {
+    statistics_.bytes -= iter->second->bytes;
+    entries_.erase(iter->second);
+    index_.erase(iter);
+  }
+  entries_.push_front({key, std::move(expression), bytes, jit_counted});
+  index_.emplace(key, entries_.begin());
+  statistics_.bytes += bytes;
+  Evict();
+}
+
+/**
+ * @brief Очистка кэша (статистика обращений сохраняется).
+ */
+void ExpressionCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  index_.clear();
+  statistics_.bytes = 0;
+}
+
+/**
+ * @brief Задает бюджет памяти и вытесняет лишние записи.
+ * @param memory_budget Бюджет памяти в байтах.
+ */
+void ExpressionCache::SetMemoryBudget(size_t memory_budget) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  memory_budget_ = memory_budget;
+  Evict();
+}
+
+/**
+ * @brief Функция-геттер, возвращающая статистику кэша.
+ */
+CacheStatistics ExpressionCache::GetStatistics() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  CacheStatistics statistics = statistics_;
+  statistics.entries = entries_.size();
+  return statistics;
+}
+
+/**
+ * @brief Оценка памяти, занятой записью: сама запись, ключ в ней и в индексе
+ * и выражение вместе с машинным кодом, если он уже сгенерирован.
+ * @param key Нормализованный текст выражения.
+ * @param expression Скомпилированное выражение.
+ */
+size_t ExpressionCache::GetEntrySize(const std::string &key,
+                                     const CompiledExpression &expression) {
+  return sizeof(Entry) + 2 * key.capacity() + expression.GetMemoryUsage();
+}
+
+/**
+ * @brief Вытеснение давно использованных записей, пока кэш не уложится в
+ * бюджет. Вызывается под мьютексом.
+ */
+void ExpressionCache::Evict() {
+  while (!entries_.empty() && statistics_.bytes > memory_budget_) {
+    statistics_.bytes -= entries_.back().bytes;
+    index_.erase(entries_.back().key);
+    entries_.pop_back();
+  }
+}
+
+}  // namespace s21
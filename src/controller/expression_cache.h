@@ -0,0 +1,86 @@
+#ifndef SMARTCALC_CONTROLLER_EXPRESSION_CACHE_H_
+#define SMARTCALC_CONTROLLER_EXPRESSION_CACHE_H_
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "../model/compiled_expression.h"
+
+namespace s21 {
+
+/**
+ * @brief Статистика кэша выражений.
+ */
+struct CacheStatistics {
+  size_t hits = 0;     ///< Количество найденных в кэше выражений.
+  size_t misses = 0;   ///< Количество выражений, которых не было в кэше.
+  size_t entries = 0;  ///< Количество выражений в кэше.
+  size_t bytes = 0;    ///< Оценка памяти, занятой кэшем.
+};
+
+/**
+ * @brief Класс для LRU-кэша скомпилированных выражений, ограниченного по
+ * памяти.
+ * @details Ключ - нормализованный текст выражения. Выражения хранятся через
+ * shared_ptr, поэтому вытеснение из кэша не мешает тем, кто уже получил
+ * выражение. Машинный код JIT появляется у выражения уже после добавления,
+ * поэтому его размер добавляется к записи при следующем обращении к ней. Все
+ * методы берут внутренний мьютекс только на время работы со списком, поэтому
+ * кэш можно использовать из нескольких потоков.
+ */
+class ExpressionCache {
+ public:
+  using ExpressionPtr = std::shared_ptr<const CompiledExpression>;
+
+  explicit ExpressionCache(size_t memory_budget = kDefaultBudget);
+
+  ~ExpressionCache() = default;
+
+  ExpressionPtr Find(const std::string &key);
+
+  void Insert(const std::string &key, ExpressionPtr expression);
+
+  void Clear();
+
+  void SetMemoryBudget(size_t memory_budget);
+
+  CacheStatistics GetStatistics() const;
+
+ private:
+  static constexpr size_t kDefaultBudget = 4 << 20;  ///< Бюджет памяти по
+                                                     ///< умолчанию (4 МБ).
+
+  /**
+   * @brief Запись кэша.
+   */
+  struct Entry {
+    std::string key;           ///< Нормализованный текст выражения.
+    ExpressionPtr expression;  ///< Скомпилированное выражение.
+    size_t bytes;              ///< Оценка памяти, занятой записью.
+    bool jit_counted;          ///< Оценка уже включает машинный код.
+  };
+
+  static size_t GetEntrySize(const std::string &key,
+                             const CompiledExpression &expression);
+
+  void Evict();
+
+  std::list<Entry> entries_;  ///< Записи от недавно использованных к давно.
+
+  std::unordered_map<std::string, std::list<Entry>::iterator>
+      index_;  ///< Поиск записи по ключу.
+
+  size_t memory_budget_;  ///< Бюджет памяти в байтах.
+
+  CacheStatistics statistics_;  ///< Статистика.
+
+  mutable std::mutex mutex_;  ///< Защищает записи и статистику.
+};
+
+}  // namespace s21
+
+#endif  // SMARTCALC_CONTROLLER_EXPRESSION_CACHE_H_
@@ -0,0 +1,232 @@
+#include "adaptive_sampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <utility>
+
+namespace s21 {
+
+namespace {
+
+/**
+ * @brief Отрезок графика с вычисленными значениями на концах и в середине.
+ */
+struct Segment {
+  double x_left, y_left;      ///< Левый конец.
+  double x_middle, y_middle;  ///< Середина.
+  double x_right, y_right;    ///< Правый конец.
+  double error;               ///< Оценка ошибки в пикселях.
+  bool broken;                ///< На отрезке полюс: линия рвется в середине.
+
+  bool operator<(const Segment &other) const { return error < other.error; }
+};
+
+/**
+ * @brief Оценка ошибки отрезка: насколько значение в середине отклоняется от
+ * прямой между концами.
+ * @param segment Отрезок.
+ * @param enclosure Отрезок, гарантированно содержащий значения функции на
+ * отрезке графика.
+ * @param settings Параметры построения (с вычисленными размерами пикселя).
+ * @return Ошибка в пикселях. Бесконечность - если на отрезке меняется
+ * конечность значений или функция может быть разрывна (полюс, скачок,
+ * граница области определения), ноль - если отрезок делить дальше не нужно:
+ * он целиком вне видимой области или кривая на нем доказанно уже пикселя.
+ */
+double EstimateError(const Segment &segment, const Interval &enclosure,
+                     const AdaptiveSampling &settings) {
+  if (enclosure.IsEmpty() || enclosure.high < settings.y_min ||
+      enclosure.low > settings.y_max) {
+    return 0;
+  }
+  double width = segment.x_right - segment.x_left;
+  bool left_finite = std::isfinite(segment.y_left);
+  bool middle_finite = std::isfinite(segment.y_middle);
+  bool right_finite = std::isfinite(segment.y_right);
+
+  if (left_finite != middle_finite || middle_finite != right_finite ||
+      !enclosure.continuous) {
+    return width > settings.x_pixel / 64
+               ? std::numeric_limits<double>::infinity()
+               : 0;
+  }
+  if (!middle_finite || width <= settings.x_pixel / 2 ||
+      enclosure.high - enclosure.low <= settings.tolerance * settings.y_pixel) {
+    return 0;
+  }
+  double linear = (segment.y_left + segment.y_right) / 2;
+  return std::fabs(segment.y_middle - linear) / settings.y_pixel;
+}
+
+/**
+ * @brief Создание отрезка с вычислением значения в его середине и оценки
+ * значений на нем в интервальной арифметике.
+ * @details Отрезок с полюсом, который уже не делится (например, tan у pi / 2),
+ * помечается разорванным: оба конца конечны, а оценка значений неограничена.
+ */
+Segment MakeSegment(const CompiledExpression &expression, double x_left,
+                    double y_left, double x_right, double y_right,
+                    const AdaptiveSampling &settings) {
+  Segment segment;
+  segment.x_left = x_left;
+  segment.y_left = y_left;
+  segment.x_right = x_right;
+  segment.y_right = y_right;
+  segment.x_middle = x_left + (x_right - x_left) / 2;
+  segment.y_middle = expression.Evaluate(segment.x_middle);
+  Interval enclosure = expression.EvaluateInterval({x_left, x_right, true});
+  segment.error = EstimateError(segment, enclosure, settings);
+  segment.broken = segment.error == 0 && !enclosure.continuous &&
+                   !enclosure.IsEmpty() &&
+                   (!std::isfinite(enclosure.low) ||
+                    !std::isfinite(enclosure.high)) &&
+                   std::isfinite(y_left) && std::isfinite(y_right);
+  return segment;
+}
+
+}  // namespace
+
+/**
+ * @brief Адаптивное вычисление точек графика.
+ * @param expression Скомпилированное выражение.
+ * @param x_min Нижняя граница области определения графика.
+ * @param x_max Верхняя граница области определения графика.
+ * @param settings Бюджет точек и допустимая погрешность.
+ * @param x_data Вектор для значений X (по возрастанию).
+ * @param y_data Вектор для значений Y.
+ * @details Сначала вычисляется равномерная сетка, затем отрезок с наибольшей
+ * ошибкой делится пополам, пока ошибка всех отрезков не станет меньше
+ * допустимой или не закончится бюджет точек. На гладких участках точек
+ * получается мало, у крутых участков, разрывов и границ области определения -
+ * много, а общее количество вычислений ограничено бюджетом.
+ *
+ * Каждый отрезок дополнительно оценивается в интервальной арифметике.
+ * Отрезки, значения на которых гарантированно вне видимой области
+ * [settings.y_min, settings.y_max] или укладываются в допустимую
+ * погрешность, не делятся, поэтому точки тратятся только на видимую часть
+ * кривой. Отрезки, на которых функция может быть разрывна, делятся до
+ * 1/64 пикселя, даже если значения на концах похожи. Если в таком отрезке
+ * остается полюс, значение в его середине заменяется на NaN, и линия
+ * графика в этом месте рвется вместо вертикального отрезка через весь экран.
+ */
+void SampleAdaptively(const CompiledExpression &expression, double x_min,
+                      double x_max, const AdaptiveSampling &settings,
+                      std::vector<double> &x_data,
+                      std::vector<double> &y_data) {
+  AdaptiveSampling actual = settings;
+  size_t initial_count = std::max<size_t>(
+      2, std::min(actual.initial_points, (actual.max_points + 1) / 2));
+  if (actual.x_pixel <= 0) {
+    actual.x_pixel = (x_max - x_min) / 1000;
+  }
+
+  std::vector<double> grid_x(initial_count);
+  std::vector<double> grid_y(initial_count);
+  double step = (x_max - x_min) / (initial_count - 1);
+  for (size_t i = 0; i < initial_count; ++i) {
+    grid_x[i] = x_min + step * i;
+  }
+  grid_x.back() = x_max;
+  expression.Evaluate(grid_x.data(), grid_y.data(), initial_count);
+
+  if (actual.y_pixel <= 0) {
+    double y_low = std::numeric_limits<double>::infinity();
+    double y_high = -y_low;
+    for (double y : grid_y) {
+      if (std::isfinite(y)) {
+        y_low = std::min(y_low, y);
+        y_high = std::max(y_high, y);
+      }
+    }
+    actual.y_pixel = y_high > y_low ? (y_high - y_low) / 1000 : 1e-3;
+  }
+
+  std::priority_queue<Segment> segments;
+  size_t used_points = initial_count;
+  for (size_t i = 0; i + 1 < initial_count; ++i) {
+    segments.push(MakeSegment(expression, grid_x[i], grid_y[i], grid_x[i + 1],
+                              grid_y[i + 1], actual));
+    ++used_points;
+  }
+
+  while (!segments.empty() && segments.top().error > actual.tolerance &&
+         used_points + 2 <= actual.max_points) {
+    Segment segment = segments.top();
+    segments.pop();
+    segments.push(MakeSegment(expression, segment.x_left, segment.y_left,
+                              segment.x_middle, segment.y_middle, actual));
+    segments.push(MakeSegment(expression, segment.x_middle, segment.y_middle,
+                              segment.x_right, segment.y_right, actual));
+    used_points += 2;
+  }
+
+  std::vector<std::pair<double, double>> points;
+  points.reserve(segments.size() * 2 + 1);
+  points.emplace_back(x_max, grid_y.back());
+  for (; !segments.empty(); segments.pop()) {
+    const Segment &segment = segments.top();
+    points.emplace_back(segment.x_left, segment.y_left);
+    points.emplace_back(segment.x_middle,
+                        segment.broken
+                            ? std::numeric_limits<double>::quiet_NaN()
+                            : segment.y_middle);
+  }
+  std::sort(points.begin(), points.end(),
+            [](const auto &a, const auto &b) { return a.first < b.first; });
+
+  x_data.resize(points.size());
+  y_data.resize(points.size());
+  for (size_t i = 0; i < points.size(); ++i) {
+    x_data[i] = points[i].first;
+    y_data[i] = points[i].second;
+  }
+}
+
+/**
+ * @brief Гарантированная оценка значений функции на области определения
+ * графика для автоматического выбора границ по Y.
+ * @param expression Скомпилированное выражение от одной переменной.
+ * @param x_min Нижняя граница области определения графика.
+ * @param x_max Верхняя граница области определения графика.
+ * @param pieces_count Количество частей, на которые делится область.
+ * @return Отрезок, содержащий значения функции на области определения, кроме
+ * окрестностей полюсов, или пустой отрезок, если функция нигде не
+ * определена. Флаг continuous сброшен, если на области есть полюс.
+ * @details Область делится на равные части, и каждая вычисляется в
+ * интервальной арифметике: на узких частях оценка близка к точной, поэтому
+ * объединение оценок дает плотные границы. Части с неограниченной оценкой
+ * (полюса) отбрасываются вместе с соседними: иначе у tan границы ушли бы в
+ * бесконечность.
+ */
+Interval EncloseGraph(const CompiledExpression &expression, double x_min,
+                      double x_max, size_t pieces_count) {
+  pieces_count = std::max<size_t>(pieces_count, 1);
+  std::vector<Interval> pieces(pieces_count);
+  std::vector<bool> poles(pieces_count);
+  double step = (x_max - x_min) / pieces_count;
+  for (size_t i = 0; i < pieces_count; ++i) {
+    double right = i + 1 == pieces_count ? x_max : x_min + step * (i + 1);
+    pieces[i] = expression.EvaluateInterval({x_min + step * i, right, true});
+    poles[i] = !pieces[i].IsEmpty() && (!std::isfinite(pieces[i].low) ||
+                                        !std::isfinite(pieces[i].high));
+  }
+
+  Interval result = Interval::Empty();
+  bool has_poles = false;
+  for (size_t i = 0; i < pieces_count; ++i) {
+    has_poles = has_poles || poles[i];
+    bool near_pole = poles[i] || (i > 0 && poles[i - 1]) ||
+                     (i + 1 < pieces_count && poles[i + 1]);
+    if (!near_pole) {
+      result = Hull(result, pieces[i]);
+    }
+  }
+  if (has_poles) {
+    result.continuous = false;
+  }
+  return result;
+}
+
+}  // namespace s21
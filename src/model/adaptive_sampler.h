@@ -0,0 +1,50 @@
+#ifndef SMARTCALC_MODEL_ADAPTIVE_SAMPLER_H_
+#define SMARTCALC_MODEL_ADAPTIVE_SAMPLER_H_
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include "compiled_expression.h"
+
+namespace s21 {
+
+/**
+ * @brief Параметры адаптивного построения графика.
+ */
+struct AdaptiveSampling {
+  size_t max_points = 4000;  ///< Максимальное количество вычисляемых точек.
+
+  size_t initial_points = 64;  ///< Количество точек начальной равномерной
+                               ///< сетки.
+
+  double x_pixel = 0;  ///< Ширина пикселя в единицах X. Ноль означает
+                       ///< тысячную долю области определения.
+
+  double y_pixel = 0;  ///< Высота пикселя в единицах Y. Ноль означает
+                       ///< тысячную долю разброса значений начальной сетки.
+
+  double tolerance = 0.5;  ///< Допустимое отклонение кривой от отрезка
+                           ///< ломаной в пикселях.
+
+  double y_min = -std::numeric_limits<double>::infinity();  ///< Нижняя
+                                                            ///< граница
+                                                            ///< видимой
+                                                            ///< области.
+
+  double y_max = std::numeric_limits<double>::infinity();  ///< Верхняя
+                                                           ///< граница
+                                                           ///< видимой
+                                                           ///< области.
+};
+
+void SampleAdaptively(const CompiledExpression &expression, double x_min,
+                      double x_max, const AdaptiveSampling &settings,
+                      std::vector<double> &x_data, std::vector<double> &y_data);
+
+Interval EncloseGraph(const CompiledExpression &expression, double x_min,
+                      double x_max, size_t pieces_count = 512);
+
+}  // namespace s21
+
+#endif  // SMARTCALC_MODEL_ADAPTIVE_SAMPLER_H_
@@ -0,0 +1,73 @@
+#include "arena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace s21 {
+
+/**
+ * @brief Конструктор. Память выделяется при первом запросе.
+ * @param block_size Размер первого блока в байтах. Следующие блоки вдвое
+ * больше предыдущих.
+ */
+Arena::Arena(size_t block_size) : block_size_(block_size) {}
+
+/**
+ * @brief Освобождение всей выделенной из арены памяти за O(1). Блоки
+ * остаются в арене и используются заново.
+ */
+void Arena::Reset() {
+  current_ = 0;
+  offset_ = 0;
+}
+
+/**
+ * @brief Функция-геттер, возвращающая суммарный размер блоков арены.
+ */
+size_t Arena::GetCapacity() const {
+  size_t capacity = 0;
+  for (const Block &block : blocks_) {
+    capacity += block.size;
+  }
+  return capacity;
+}
+
+/**
+ * @brief Выделение памяти сдвигом указателя. Если в текущем блоке не хватает
+ * места, берется следующий подходящий блок или выделяется новый.
+ * @param bytes Размер.
+ * @param alignment Выравнивание.
+ * @return Указатель на выделенную память.
+ */
+void *Arena::do_allocate(size_t bytes, size_t alignment) {
+  for (; current_ < blocks_.size(); ++current_, offset_ = 0) {
+    Block &block = blocks_[current_];
+    uintptr_t begin = reinterpret_cast<uintptr_t>(block.data.get());
+    uintptr_t aligned = (begin + offset_ + alignment - 1) & ~(alignment - 1);
+    if (aligned + bytes <= begin + block.size) {
+      offset_ = aligned + bytes - begin;
+      return reinterpret_cast<void *>(aligned);
+    }
+  }
+  size_t size = blocks_.empty() ? block_size_ : blocks_.back().size * 2;
+  size = std::max(size, bytes + alignment);
+  blocks_.push_back({std::unique_ptr<std::byte[]>(new std::byte[size]), size});
+  current_ = blocks_.size() - 1;
+  offset_ = 0;
+  return do_allocate(bytes, alignment);
+}
+
+/**
+ * @brief Освобождение отдельного объекта ничего не делает: память
+ * возвращается арене целиком в Reset.
+ */
+void Arena::do_deallocate(void *, size_t, size_t) {}
+
+/**
+ * @brief Арены равны, только если это один и тот же объект.
+ */
+bool Arena::do_is_equal(const std::pmr::memory_resource &other) const noexcept {
+  return this == &other;
+}
+
+}  // namespace s21
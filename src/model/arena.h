@@ -0,0 +1,72 @@
+#ifndef SMARTCALC_MODEL_ARENA_H_
+#define SMARTCALC_MODEL_ARENA_H_
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace s21 {
+
+/**
+ * @brief Арена (bump allocator) для временных структур разбора и компиляции.
+ * @details Память выделяется сдвигом указателя внутри больших блоков, а
+ * освобождение отдельных объектов ничего не делает. Reset за O(1) делает всю
+ * память арены снова свободной, не возвращая блоки системе, поэтому после
+ * первых вычислений разбор выражений вообще не обращается к malloc.
+ */
+class Arena : public std::pmr::memory_resource {
+ public:
+  explicit Arena(size_t block_size = kDefaultBlockSize);
+
+  Arena(const Arena &) = delete;
+
+  Arena &operator=(const Arena &) = delete;
+
+  ~Arena() override = default;
+
+  void Reset();
+
+  size_t GetCapacity() const;
+
+ private:
+  static constexpr size_t kDefaultBlockSize = 16384;  ///< Размер первого
+                                                      ///< блока в байтах.
+
+  /**
+   * @brief Блок памяти арены.
+   */
+  struct Block {
+    std::unique_ptr<std::byte[]> data;  ///< Память блока.
+    size_t size;                        ///< Размер блока.
+  };
+
+  void *do_allocate(size_t bytes, size_t alignment) override;
+
+  void do_deallocate(void *pointer, size_t bytes, size_t alignment) override;
+
+  bool do_is_equal(const std::pmr::memory_resource &other)
+      const noexcept override;
+
+  std::vector<Block> blocks_;  ///< Блоки в порядке выделения.
+
+  size_t block_size_;  ///< Размер первого блока.
+
+  size_t current_ = 0;  ///< Индекс блока, из которого идет выделение.
+
+  size_t offset_ = 0;  ///< Занятая часть текущего блока.
+};
+
+/**
+ * @brief Освобождение памяти pmr-контейнера целиком (нужно перед сбросом
+ * арены, из которой контейнер брал память).
+ * @param container Контейнер.
+ */
+template <typename Container>
+void ReleaseMemory(Container &container) {
+  Container(container.get_allocator()).swap(container);
+}
+
+}  // namespace s21
+
+#endif  // SMARTCALC_MODEL_ARENA_H_
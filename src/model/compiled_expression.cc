@@ -0,0 +1,1218 @@
+#include "compiled_expression.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <mutex>
+
+#include "jit_compiler.h"
+#include "lexer.h"
+#include "operations.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SMARTCALC_AVX_DISPATCH 1
+#endif
+
+#if defined(SMARTCALC_AVX_DISPATCH) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace s21 {
+
+namespace {
+
+/**
+ * @brief Перечисление арифметических операций, для которых есть векторные
+ * ядра.
+ */
+enum Arithmetic { a_plus, a_minus, a_mult, a_div };
+
+#ifdef SMARTCALC_AVX_DISPATCH
+
+/**
+ * @brief Поддерживает ли процессор AVX (проверяется один раз при запуске).
+ * @details Сборка по умолчанию не включает -mavx, поэтому AVX-ядра собираются
+ * с атрибутом target("avx") и выбираются во время выполнения, а на
+ * процессорах без AVX работают ядра SSE2.
+ */
+const bool kHasAvx = [] {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx") != 0;
+}();
+
+/**
+ * @brief AVX-часть ядра арифметической операции.
+ * @return Количество обработанных значений (кратно четырем).
+ */
+template <Arithmetic operation>
+__attribute__((target("avx"))) size_t ArithmeticKernelAvx(double *left,
+                                                         const double *right,
+                                                         size_t count) {
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m256d a = _mm256_loadu_pd(left + i);
+    __m256d b = _mm256_loadu_pd(right + i);
+    if constexpr (operation == a_plus) {
+      a = _mm256_add_pd(a, b);
+    } else if constexpr (operation == a_minus) {
+      a = _mm256_sub_pd(a, b);
+    } else if constexpr (operation == a_mult) {
+      a = _mm256_mul_pd(a, b);
+    } else {
+      a = _mm256_div_pd(a, b);
+    }
+    _mm256_storeu_pd(left + i, a);
+  }
+  return i;
+}
+
+/**
+ * @brief AVX-часть ядра квадратного корня.
+ * @return Количество обработанных значений (кратно четырем).
+ */
+__attribute__((target("avx"))) size_t SqrtKernelAvx(double *values,
+                                                   size_t count) {
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    _mm256_storeu_pd(values + i, _mm256_sqrt_pd(_mm256_loadu_pd(values + i)));
+  }
+  return i;
+}
+
+#endif  // SMARTCALC_AVX_DISPATCH
+
+/**
+ * @brief Векторное ядро арифметической операции над блоком значений.
+ * @param left Левые аргументы, сюда же записывается результат.
+ * @param right Правые аргументы.
+ * @param count Количество значений в блоке.
+ * @details Операции IEEE 754 выполняются с одинаковым округлением в векторных
+ * и скалярных инструкциях, поэтому результат совпадает со скалярным побитово.
+ * AVX-часть обрабатывает четверки значений, остаток - SSE2 и скалярный цикл.
+ */
+template <Arithmetic operation>
+void ArithmeticKernel(double *left, const double *right, size_t count) {
+  size_t i = 0;
+#ifdef SMARTCALC_AVX_DISPATCH
+  if (kHasAvx) {
+    i = ArithmeticKernelAvx<operation>(left, right, count);
+  }
+#endif
+#if defined(__SSE2__)
+  for (; i + 2 <= count; i += 2) {
+    __m128d a = _mm_loadu_pd(left + i);
+    __m128d b = _mm_loadu_pd(right + i);
+    if constexpr (operation == a_plus) {
+      a = _mm_add_pd(a, b);
+    } else if constexpr (operation == a_minus) {
+      a = _mm_sub_pd(a, b);
+    } else if constexpr (operation == a_mult) {
+      a = _mm_mul_pd(a, b);
+    } else {
+      a = _mm_div_pd(a, b);
+    }
+    _mm_storeu_pd(left + i, a);
+  }
+#endif
+  for (; i < count; ++i) {
+    if constexpr (operation == a_plus) {
+      left[i] = left[i] + right[i];
+    } else if constexpr (operation == a_minus) {
+      left[i] = left[i] - right[i];
+    } else if constexpr (operation == a_mult) {
+      left[i] = left[i] * right[i];
+    } else {
+      left[i] = left[i] / right[i];
+    }
+  }
+}
+
+/**
+ * @brief Векторное ядро квадратного корня над блоком значений.
+ * @param values Аргументы, сюда же записывается результат.
+ * @param count Количество значений в блоке.
+ */
+void SqrtKernel(double *values, size_t count) {
+  size_t i = 0;
+#ifdef SMARTCALC_AVX_DISPATCH
+  if (kHasAvx) {
+    i = SqrtKernelAvx(values, count);
+  }
+#endif
+#if defined(__SSE2__)
+  for (; i + 2 <= count; i += 2) {
+    _mm_storeu_pd(values + i, _mm_sqrt_pd(_mm_loadu_pd(values + i)));
+  }
+#endif
+  for (; i < count; ++i) {
+    values[i] = sqrt(values[i]);
+  }
+}
+
+/**
+ * @brief Ядро функции одного аргумента над блоком значений.
+ * @param values Аргументы, сюда же записывается результат.
+ * @param count Количество значений в блоке.
+ * @param function Функция, применяемая к каждому значению.
+ */
+template <typename Function>
+void UnaryKernel(double *values, size_t count, Function function) {
+  for (size_t i = 0; i < count; ++i) {
+    values[i] = function(values[i]);
+  }
+}
+
+/**
+ * @brief Ядро функции двух аргументов над блоком значений.
+ * @param left Левые аргументы, сюда же записывается результат.
+ * @param right Правые аргументы.
+ * @param count Количество значений в блоке.
+ * @param function Функция, применяемая к каждой паре значений.
+ */
+template <typename Function>
+void BinaryKernel(double *left, const double *right, size_t count,
+                  Function function) {
+  for (size_t i = 0; i < count; ++i) {
+    left[i] = function(left[i], right[i]);
+  }
+}
+
+/**
+ * @brief Ядро схемы Горнера над блоком значений.
+ * @param values Аргументы, сюда же записывается результат.
+ * @param count Количество значений в блоке (не больше размера блока).
+ * @param coefficients Количество коэффициентов, затем коэффициенты от
+ * старшего.
+ */
+template <size_t kBlockSize>
+void HornerKernel(double *values, size_t count, const double *coefficients) {
+  size_t coefficients_count = static_cast<size_t>(coefficients[0]);
+  double accumulator[kBlockSize];
+  std::fill(accumulator, accumulator + count, coefficients[1]);
+  for (size_t k = 2; k <= coefficients_count; ++k) {
+    double coefficient = coefficients[k];
+    for (size_t i = 0; i < count; ++i) {
+      accumulator[i] = accumulator[i] * values[i] + coefficient;
+    }
+  }
+  std::memcpy(values, accumulator, count * sizeof(double));
+}
+
+/**
+ * @brief Вычисление функции или оператора над числами.
+ * @tparam kCode Код операции (от op_cos до op_minus, кроме op_powi и
+ * op_horner, которым нужны константы байт-кода).
+ * @param left Левый (или единственный) аргумент.
+ * @param right Правый аргумент.
+ * @details Общая часть цикла интерпретации Run и свертки констант Apply. Код
+ * операции - параметр шаблона, чтобы в Run не было второго ветвления по коду.
+ */
+template <CompiledExpression::OpCode kCode>
+inline double Operate(double left, double right) {
+  using Op = CompiledExpression;
+  if constexpr (kCode == Op::op_cos) {
+    return cos(left);
+  } else if constexpr (kCode == Op::op_sin) {
+    return sin(left);
+  } else if constexpr (kCode == Op::op_tan) {
+    return tan(left);
+  } else if constexpr (kCode == Op::op_acos) {
+    return acos(left);
+  } else if constexpr (kCode == Op::op_asin) {
+    return asin(left);
+  } else if constexpr (kCode == Op::op_atan) {
+    return atan(left);
+  } else if constexpr (kCode == Op::op_ln) {
+    return log(left);
+  } else if constexpr (kCode == Op::op_log) {
+    return log10(left);
+  } else if constexpr (kCode == Op::op_sqrt) {
+    return sqrt(left);
+  } else if constexpr (kCode == Op::op_neg) {
+    return 0.0 - left;
+  } else if constexpr (kCode == Op::op_pow) {
+    return pow(left, right);
+  } else if constexpr (kCode == Op::op_mult) {
+    return left * right;
+  } else if constexpr (kCode == Op::op_div) {
+    return left / right;
+  } else if constexpr (kCode == Op::op_mod) {
+    return Modulo(left, right);
+  } else if constexpr (kCode == Op::op_plus) {
+    return left + right;
+  } else {
+    static_assert(kCode == Op::op_minus, "Not an operation");
+    return left - right;
+  }
+}
+
+}  // namespace
+
+/**
+ * @brief Состояние JIT выражения.
+ */
+struct CompiledExpression::JitState {
+  std::atomic<uint64_t> values_count{0};  ///< Сколько значений вычислено.
+  std::once_flag compile_once;            ///< Генерация выполняется один раз.
+  std::atomic<bool> ready{false};         ///< Машинный код готов.
+  JitFunction function;                   ///< Машинный код.
+};
+
+/**
+ * @brief Вычисление скомпилированного выражения от одной переменной.
+ * @param x Значение переменной (икса) для подстановки в выражение.
+ * @return Число - результат вычисления или NaN, если в выражении больше
+ * одной переменной.
+ */
+double CompiledExpression::Evaluate(double x) const {
+  if (variables_.size() > 1) {
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+  return RunScalar(&x);
+}
+
+/**
+ * @brief Вычисление скомпилированного выражения для значений переменных.
+ * @param bindings Значения переменных по номерам ячеек (GetVariables).
+ * @param bindings_count Количество значений.
+ * @return Число - результат вычисления или NaN, если значений меньше, чем
+ * переменных.
+ */
+double CompiledExpression::Evaluate(const double *bindings,
+                                    size_t bindings_count) const {
+  if (bindings_count < variables_.size()) {
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+  return RunScalar(bindings);
+}
+
+/**
+ * @brief Пакетное вычисление скомпилированного выражения от одной
+ * переменной.
+ * @param x_values Массив значений икса.
+ * @param results Массив для результатов, не меньше count элементов.
+ * @param count Количество значений икса.
+ * @details Результаты совпадают с результатами скалярного Evaluate.
+ */
+void CompiledExpression::Evaluate(const double *x_values, double *results,
+                                  size_t count) const {
+  if (variables_.size() > 1) {
+    std::fill(results, results + count,
+              std::numeric_limits<double>::quiet_NaN());
+    return;
+  }
+  Evaluate(nullptr, 0, x_values, results, count);
+}
+
+/**
+ * @brief Пакетное вычисление, в котором меняется значение одной переменной.
+ * @param bindings Значения остальных переменных по номерам ячеек (не меньше
+ * количества переменных) или nullptr, если других переменных нет.
+ * @param slot Номер ячейки, в которую подставляются values. Если номер не
+ * меньше количества переменных, values не используются.
+ * @param values Массив значений переменной.
+ * @param results Массив для результатов, не меньше count элементов.
+ * @param count Количество значений.
+ * @details Для каждого значения результат совпадает со скалярным Evaluate.
+ * Если bindings равен nullptr, а в выражении есть переменные кроме slot, все
+ * результаты - NaN, как при нехватке значений в скалярном Evaluate. Векторная
+ * пакетная функция JIT рассчитана на одну переменную; развертки выражений от
+ * нескольких переменных идут блоками интерпретатора, где не зависящие от
+ * slot подвыражения считаются один раз на блок.
+ */
+void CompiledExpression::Evaluate(const double *bindings, size_t slot,
+                                  const double *values, double *results,
+                                  size_t count) const {
+  if (bindings == nullptr &&
+      variables_.size() > (slot < variables_.size() ? 1 : 0)) {
+    std::fill(results, results + count,
+              std::numeric_limits<double>::quiet_NaN());
+    return;
+  }
+  JitState *jit = GetJit(count);
+  if (jit != nullptr && jit->function.GetBatch() != nullptr &&
+      (variables_.empty() || (variables_.size() == 1 && slot == 0))) {
+    jit->function.GetBatch()(values, results, count);
+    return;
+  }
+  thread_local std::vector<double> block_stack;
+  thread_local std::unique_ptr<bool[]> block_uniform;
+  thread_local size_t block_frame_size = 0;
+  if (block_frame_size < GetFrameSize()) {
+    block_frame_size = GetFrameSize();
+    block_stack.resize(block_frame_size * kBlockSize);
+    block_uniform.reset(new bool[block_frame_size]);
+  }
+  for (size_t offset = 0; offset < count; offset += kBlockSize) {
+    size_t block_count = std::min(kBlockSize, count - offset);
+    RunBlock(bindings, slot, values + offset, results + offset, block_count,
+             block_stack.data(), block_uniform.get());
+  }
+}
+
+/**
+ * @brief Вычисление скомпилированного выражения от одной переменной на
+ * отрезке.
+ * @param x Отрезок значений переменной (икса).
+ * @return Отрезок, содержащий значения выражения во всех точках x, или вся
+ * прямая с разрывом, если в выражении больше одной переменной.
+ */
+Interval CompiledExpression::EvaluateInterval(const Interval &x) const {
+  if (variables_.size() > 1) {
+    return Interval::Entire();
+  }
+  return EvaluateInterval(&x, 1);
+}
+
+/**
+ * @brief Вычисление скомпилированного выражения на отрезках переменных.
+ * @param bindings Отрезки значений переменных по номерам ячеек.
+ * @param bindings_count Количество отрезков.
+ * @return Отрезок, содержащий значения выражения во всех точках, или вся
+ * прямая с разрывом, если отрезков меньше, чем переменных.
+ * @details Вычисление всегда идет интерпретатором: машинный код JIT работает
+ * только с числами.
+ */
+Interval CompiledExpression::EvaluateInterval(const Interval *bindings,
+                                              size_t bindings_count) const {
+  if (bindings_count < variables_.size()) {
+    return Interval::Entire();
+  }
+  thread_local std::vector<Interval> interval_stack;
+  if (interval_stack.size() < GetFrameSize()) {
+    interval_stack.resize(GetFrameSize());
+  }
+  return RunInterval(bindings, interval_stack.data());
+}
+
+/**
+ * @brief Вычисление значения и производных выражения от одной переменной.
+ * @param x Значение переменной (икса).
+ * @return Значение, первая и вторая производные по переменной или NaN, если
+ * в выражении больше одной переменной.
+ */
+Dual CompiledExpression::EvaluateDerivative(double x) const {
+  if (variables_.size() > 1) {
+    double nan = std::numeric_limits<double>::quiet_NaN();
+    return {nan, nan, nan};
+  }
+  return EvaluateDerivative(&x, 1, 0);
+}
+
+/**
+ * @brief Вычисление значения и частных производных по одной переменной.
+ * @param bindings Значения переменных по номерам ячеек.
+ * @param bindings_count Количество значений.
+ * @param slot Номер ячейки переменной, по которой берутся производные. Если
+ * такой переменной нет, производные равны нулю.
+ * @return Значение и производные или NaN, если значений меньше, чем
+ * переменных.
+ */
+Dual CompiledExpression::EvaluateDerivative(const double *bindings,
+                                            size_t bindings_count,
+                                            size_t slot) const {
+  if (bindings_count < variables_.size()) {
+    double nan = std::numeric_limits<double>::quiet_NaN();
+    return {nan, nan, nan};
+  }
+  thread_local std::vector<Dual> dual_bindings;
+  dual_bindings.resize(variables_.size());
+  for (size_t i = 0; i < variables_.size(); ++i) {
+    dual_bindings[i] = i == slot ? Dual::Variable(bindings[i])
+                                 : Dual::Constant(bindings[i]);
+  }
+  thread_local std::vector<Dual> dual_stack;
+  if (dual_stack.size() < GetFrameSize()) {
+    dual_stack.resize(GetFrameSize());
+  }
+  return RunDual(dual_bindings.data(), dual_stack.data());
+}
+
+/**
+ * @brief Пакетное вычисление значений и производных выражения от одной
+ * переменной.
+ * @param x_values Массив значений икса.
+ * @param values Массив для значений (может быть nullptr).
+ * @param derivatives Массив для первых производных (может быть nullptr).
+ * @param second_derivatives Массив для вторых производных (может быть
+ * nullptr).
+ * @param count Количество значений икса.
+ * @details Значение и производные получаются за один проход байт-кода, без
+ * повторных вычислений, как у конечных разностей.
+ */
+void CompiledExpression::EvaluateDerivative(const double *x_values,
+                                            double *values,
+                                            double *derivatives,
+                                            double *second_derivatives,
+                                            size_t count) const {
+  thread_local std::vector<Dual> dual_stack;
+  if (dual_stack.size() < GetFrameSize()) {
+    dual_stack.resize(GetFrameSize());
+  }
+  for (size_t i = 0; i < count; ++i) {
+    Dual x = Dual::Variable(x_values[i]);
+    Dual result = variables_.size() > 1 ? EvaluateDerivative(x_values[i])
+                                        : RunDual(&x, dual_stack.data());
+    if (values != nullptr) {
+      values[i] = result.value;
+    }
+    if (derivatives != nullptr) {
+      derivatives[i] = result.first;
+    }
+    if (second_derivatives != nullptr) {
+      second_derivatives[i] = result.second;
+    }
+  }
+}
+
+/**
+ * @brief Функция-геттер, сообщающая, есть ли в выражении переменная x.
+ */
+bool CompiledExpression::UsesX() const { return FindVariable("x") >= 0; }
+
+/**
+ * @brief Функция-геттер, возвращающая имена переменных по номерам ячеек.
+ */
+const std::vector<std::string> &CompiledExpression::GetVariables() const {
+  return variables_;
+}
+
+/**
+ * @brief Поиск ячейки переменной по имени (без учета регистра).
+ * @param name Имя переменной.
+ * @return Номер ячейки или -1, если такой переменной в выражении нет.
+ */
+int CompiledExpression::FindVariable(std::string_view name) const {
+  for (size_t slot = 0; slot < variables_.size(); ++slot) {
+    if (IsSameName(name, variables_[slot])) {
+      return static_cast<int>(slot);
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Проверка, является ли операция бинарной.
+ * @param code Код операции.
+ */
+bool CompiledExpression::IsBinary(OpCode code) { return code >= op_pow; }
+
+/**
+ * @brief Вычисление одной операции над числами.
+ * @param code Код операции (функция или оператор).
+ * @param left Левый (или единственный) аргумент.
+ * @param right Правый аргумент.
+ * @return Результат операции, совпадающий с результатом байт-кода.
+ * @details Операция вычисляется той же функцией Operate, что и в цикле
+ * интерпретации, без выделения памяти. Для op_powi, op_horner и кодов, не
+ * являющихся операциями, возвращается NaN.
+ */
+double CompiledExpression::Apply(OpCode code, double left, double right) {
+  switch (code) {
+    case op_cos:
+      return Operate<op_cos>(left, right);
+    case op_sin:
+      return Operate<op_sin>(left, right);
+    case op_tan:
+      return Operate<op_tan>(left, right);
+    case op_acos:
+      return Operate<op_acos>(left, right);
+    case op_asin:
+      return Operate<op_asin>(left, right);
+    case op_atan:
+      return Operate<op_atan>(left, right);
+    case op_ln:
+      return Operate<op_ln>(left, right);
+    case op_log:
+      return Operate<op_log>(left, right);
+    case op_sqrt:
+      return Operate<op_sqrt>(left, right);
+    case op_neg:
+      return Operate<op_neg>(left, right);
+    case op_pow:
+      return Operate<op_pow>(left, right);
+    case op_mult:
+      return Operate<op_mult>(left, right);
+    case op_div:
+      return Operate<op_div>(left, right);
+    case op_mod:
+      return Operate<op_mod>(left, right);
+    case op_plus:
+      return Operate<op_plus>(left, right);
+    case op_minus:
+      return Operate<op_minus>(left, right);
+    default:
+      return std::numeric_limits<double>::quiet_NaN();
+  }
+}
+
+/**
+ * @brief Функция-геттер, возвращающая количество операций байт-кода.
+ */
+size_t CompiledExpression::GetSize() const { return code_.size(); }
+
+/**
+ * @brief Функция-геттер, возвращающая максимальную глубину стэка значений.
+ */
+int CompiledExpression::GetMaxDepth() const { return max_depth_; }
+
+/**
+ * @brief Функция-геттер, возвращающая количество ячеек для общих
+ * подвыражений.
+ */
+int CompiledExpression::GetSlotsCount() const { return slots_count_; }
+
+/**
+ * @brief Задает режим JIT для выражения.
+ * @param mode Режим. В режиме jit_always машинный код генерируется сразу.
+ */
+void CompiledExpression::SetJitMode(JitMode mode) {
+  if (mode == jit_off || !JitFunction::IsSupported()) {
+    jit_.reset();
+    return;
+  }
+  jit_ = std::make_shared<JitState>();
+  if (mode == jit_always) {
+    GetJit(kJitThreshold);
+  }
+}
+
+/**
+ * @brief Проверка, вычисляется ли выражение машинным кодом.
+ */
+bool CompiledExpression::IsJitCompiled() const {
+  return jit_ && jit_->ready.load(std::memory_order_acquire);
+}
+
+/**
+ * @brief Учет вычисленных значений и получение машинного кода.
+ * @param values_count Сколько значений сейчас будет вычислено.
+ * @return Состояние JIT с готовым машинным кодом или nullptr, если
+ * выражение нужно вычислять интерпретатором.
+ * @details Когда общее количество значений достигает kJitThreshold, код
+ * генерируется (один раз, даже при вызовах из нескольких потоков). Если
+ * генерация не удалась, выражение остается на интерпретаторе.
+ */
+CompiledExpression::JitState *CompiledExpression::GetJit(
+    uint64_t values_count) const {
+  JitState *jit = jit_.get();
+  if (jit == nullptr) {
+    return nullptr;
+  }
+  if (jit->ready.load(std::memory_order_acquire)) {
+    return jit;
+  }
+  if (jit->values_count.fetch_add(values_count, std::memory_order_relaxed) +
+          values_count <
+      kJitThreshold) {
+    return nullptr;
+  }
+  std::call_once(jit->compile_once, [this, jit] {
+    if (jit->function.Compile(*this)) {
+      jit->ready.store(true, std::memory_order_release);
+    }
+  });
+  return jit->ready.load(std::memory_order_acquire) ? jit : nullptr;
+}
+
+/**
+ * @brief Оценка памяти, занимаемой выражением, в байтах.
+ * @details Машинный код учитывается, только когда он уже сгенерирован: в
+ * режиме jit_auto оценка растет после kJitThreshold вычислений.
+ */
+size_t CompiledExpression::GetMemoryUsage() const {
+  size_t names_size = variables_.capacity() * sizeof(std::string);
+  for (const std::string &name : variables_) {
+    names_size += name.capacity();
+  }
+  size_t jit_size = 0;
+  if (jit_) {
+    jit_size = sizeof(JitState);
+    if (IsJitCompiled()) {
+      jit_size += jit_->function.GetMemoryUsage();
+    }
+  }
+  return sizeof(*this) + code_.capacity() * sizeof(OpCode) +
+         operands_.capacity() * sizeof(uint32_t) +
+         constants_.capacity() * sizeof(double) + names_size + jit_size;
+}
+
+/**
+ * @brief Размер буфера для вычисления: стэк значений и ячейки после него.
+ */
+size_t CompiledExpression::GetFrameSize() const {
+  return static_cast<size_t>(max_depth_ + slots_count_);
+}
+
+/**
+ * @brief Запись в байт-код операции, кладущей в стэк константу.
+ * @param number Число.
+ */
+void CompiledExpression::PushNumber(double number) {
+  code_.push_back(op_number);
+  operands_.push_back(static_cast<uint32_t>(constants_.size()));
+  constants_.push_back(number);
+  if (++depth_ > max_depth_) {
+    max_depth_ = depth_;
+  }
+}
+
+/**
+ * @brief Запись в байт-код операции, кладущей в стэк значение переменной.
+ * @param slot Номер ячейки переменной.
+ */
+void CompiledExpression::PushVariable(int slot) {
+  code_.push_back(op_variable);
+  operands_.push_back(static_cast<uint32_t>(slot));
+  if (++depth_ > max_depth_) {
+    max_depth_ = depth_;
+  }
+}
+
+/**
+ * @brief Запись в байт-код операции, кладущей в стэк значение общего
+ * подвыражения.
+ * @param slot Номер ячейки.
+ */
+void CompiledExpression::PushLoad(int slot) {
+  code_.push_back(op_load);
+  operands_.push_back(static_cast<uint32_t>(slot));
+  if (++depth_ > max_depth_) {
+    max_depth_ = depth_;
+  }
+}
+
+/**
+ * @brief Запись в байт-код операции, сохраняющей верхушку стэка в ячейку
+ * общего подвыражения (значение остается в стэке).
+ * @param slot Номер ячейки.
+ */
+void CompiledExpression::PushStore(int slot) {
+  code_.push_back(op_store);
+  operands_.push_back(static_cast<uint32_t>(slot));
+  slots_count_ = std::max(slots_count_, slot + 1);
+}
+
+/**
+ * @brief Запись в байт-код функции или бинарного оператора.
+ * @param code Код операции.
+ */
+void CompiledExpression::PushOperation(OpCode code) {
+  code_.push_back(code);
+  operands_.push_back(0);
+  if (IsBinary(code)) {
+    --depth_;
+  }
+}
+
+/**
+ * @brief Запись в байт-код функции с параметром (например, показателем
+ * степени для op_powi).
+ * @param code Код операции.
+ * @param parameter Параметр, записываемый в таблицу констант.
+ */
+void CompiledExpression::PushOperation(OpCode code, double parameter) {
+  PushOperation(code);
+  operands_.back() = static_cast<uint32_t>(constants_.size());
+  constants_.push_back(parameter);
+}
+
+/**
+ * @brief Запись в байт-код многочлена от верхушки стэка по схеме Горнера.
+ * @param coefficients Коэффициенты от старшего к свободному члену.
+ * @param count Количество коэффициентов.
+ */
+void CompiledExpression::PushPolynomial(const double *coefficients,
+                                        size_t count) {
+  PushOperation(op_horner, static_cast<double>(count));
+  constants_.insert(constants_.end(), coefficients, coefficients + count);
+}
+
+/**
+ * @brief Резервирование памяти под байт-код, чтобы запись выражения
+ * обходилась одним выделением памяти на массив.
+ * @param code_size Количество операций.
+ * @param constants_size Размер таблицы констант.
+ */
+void CompiledExpression::Reserve(size_t code_size, size_t constants_size) {
+  code_.reserve(code_size);
+  operands_.reserve(code_size);
+  constants_.reserve(constants_size);
+}
+
+/**
+ * @brief Задает имена переменных (в нижнем регистре) по номерам ячеек.
+ * @param names Имена в порядке ячеек.
+ * @param count Количество переменных.
+ */
+void CompiledExpression::SetVariables(const std::string_view *names,
+                                      size_t count) {
+  variables_.assign(names, names + count);
+  for (std::string &name : variables_) {
+    for (char &symbol : name) {
+      symbol = ToLower(symbol);
+    }
+  }
+}
+
+/**
+ * @brief Вычисление для значений переменных машинным кодом или
+ * интерпретатором.
+ * @param bindings Значения переменных по номерам ячеек.
+ * @details Для выражений обычной глубины стэк значений и ячейки размещаются на
+ * стэке вызова, для очень глубоких - в буфере потока, который
+ * переиспользуется.
+ */
+double CompiledExpression::RunScalar(const double *bindings) const {
+  if (JitState *jit = GetJit(1)) {
+    return jit->function.GetScalar()(bindings);
+  }
+  size_t frame_size = GetFrameSize();
+  if (frame_size <= kInlineStackSize) {
+    double stack[kInlineStackSize];
+    return Run(bindings, stack);
+  }
+  thread_local std::vector<double> deep_stack;
+  if (deep_stack.size() < frame_size) {
+    deep_stack.resize(frame_size);
+  }
+  return Run(bindings, deep_stack.data());
+}
+
+/**
+ * @brief Цикл интерпретации байт-кода.
+ * @param bindings Значения переменных по номерам ячеек.
+ * @param stack Буфер размером GetFrameSize(): стэк значений, затем ячейки.
+ * @return Значение, оставшееся на верхушке стэка.
+ */
+double CompiledExpression::Run(const double *bindings, double *stack) const {
+  const OpCode *code = code_.data();
+  const uint32_t *operands = operands_.data();
+  const double *constants = constants_.data();
+  const size_t size = code_.size();
+  double *slots = stack + max_depth_;
+  double *top = stack - 1;
+
+  for (size_t i = 0; i < size; ++i) {
+    switch (code[i]) {
+      case op_number:
+        *++top = constants[operands[i]];
+        break;
+      case op_variable:
+        *++top = bindings[operands[i]];
+        break;
+      case op_load:
+        *++top = slots[operands[i]];
+        break;
+      case op_store:
+        slots[operands[i]] = *top;
+        break;
+      case op_cos:
+        *top = Operate<op_cos>(*top, 0);
+        break;
+      case op_sin:
+        *top = Operate<op_sin>(*top, 0);
+        break;
+      case op_tan:
+        *top = Operate<op_tan>(*top, 0);
+        break;
+      case op_acos:
+        *top = Operate<op_acos>(*top, 0);
+        break;
+      case op_asin:
+        *top = Operate<op_asin>(*top, 0);
+        break;
+      case op_atan:
+        *top = Operate<op_atan>(*top, 0);
+        break;
+      case op_ln:
+        *top = Operate<op_ln>(*top, 0);
+        break;
+      case op_log:
+        *top = Operate<op_log>(*top, 0);
+        break;
+      case op_sqrt:
+        *top = Operate<op_sqrt>(*top, 0);
+        break;
+      case op_neg:
+        *top = Operate<op_neg>(*top, 0);
+        break;
+      case op_powi:
+        *top = PowerByParts(*top, constants[operands[i]]);
+        break;
+      case op_horner:
+        *top = HornerScheme(*top, constants + operands[i]);
+        break;
+      case op_pow:
+        --top;
+        *top = Operate<op_pow>(top[0], top[1]);
+        break;
+      case op_mult:
+        --top;
+        *top = Operate<op_mult>(top[0], top[1]);
+        break;
+      case op_div:
+        --top;
+        *top = Operate<op_div>(top[0], top[1]);
+        break;
+      case op_mod:
+        --top;
+        *top = Operate<op_mod>(top[0], top[1]);
+        break;
+      case op_plus:
+        --top;
+        *top = Operate<op_plus>(top[0], top[1]);
+        break;
+      case op_minus:
+        --top;
+        *top = Operate<op_minus>(top[0], top[1]);
+        break;
+    }
+  }
+  return *top;
+}
+
+/**
+ * @brief Цикл интерпретации байт-кода в интервальной арифметике.
+ * @param bindings Отрезки значений переменных по номерам ячеек.
+ * @param stack Буфер размером GetFrameSize(): стэк отрезков, затем ячейки.
+ * @return Отрезок, оставшийся на верхушке стэка.
+ */
+Interval CompiledExpression::RunInterval(const Interval *bindings,
+                                         Interval *stack) const {
+  const OpCode *code = code_.data();
+  const uint32_t *operands = operands_.data();
+  const double *constants = constants_.data();
+  const size_t size = code_.size();
+  Interval *slots = stack + max_depth_;
+  Interval *top = stack - 1;
+
+  for (size_t i = 0; i < size; ++i) {
+    switch (code[i]) {
+      case op_number:
+        *++top = Interval::Point(constants[operands[i]]);
+        break;
+      case op_variable:
+        *++top = bindings[operands[i]];
+        break;
+      case op_load:
+        *++top = slots[operands[i]];
+        break;
+      case op_store:
+        slots[operands[i]] = *top;
+        break;
+      case op_cos:
+        *top = Cos(*top);
+        break;
+      case op_sin:
+        *top = Sin(*top);
+        break;
+      case op_tan:
+        *top = Tan(*top);
+        break;
+      case op_acos:
+        *top = Acos(*top);
+        break;
+      case op_asin:
+        *top = Asin(*top);
+        break;
+      case op_atan:
+        *top = Atan(*top);
+        break;
+      case op_ln:
+        *top = Ln(*top);
+        break;
+      case op_log:
+        *top = Log(*top);
+        break;
+      case op_sqrt:
+        *top = Sqrt(*top);
+        break;
+      case op_neg:
+        *top = -*top;
+        break;
+      case op_powi:
+        *top = PowerByParts(*top, constants[operands[i]]);
+        break;
+      case op_horner:
+        *top = HornerScheme(*top, constants + operands[i]);
+        break;
+      case op_pow:
+        --top;
+        *top = Pow(top[0], top[1]);
+        break;
+      case op_mult:
+        --top;
+        *top = top[0] * top[1];
+        break;
+      case op_div:
+        --top;
+        *top = top[0] / top[1];
+        break;
+      case op_mod:
+        --top;
+        *top = Modulo(top[0], top[1]);
+        break;
+      case op_plus:
+        --top;
+        *top = top[0] + top[1];
+        break;
+      case op_minus:
+        --top;
+        *top = top[0] - top[1];
+        break;
+    }
+  }
+  return *top;
+}
+
+/**
+ * @brief Цикл интерпретации байт-кода над дуальными числами.
+ * @param bindings Значения переменных с производными по номерам ячеек.
+ * @param stack Буфер размером GetFrameSize(): стэк значений, затем ячейки.
+ * @return Значение с производными, оставшееся на верхушке стэка.
+ */
+Dual CompiledExpression::RunDual(const Dual *bindings, Dual *stack) const {
+  const OpCode *code = code_.data();
+  const uint32_t *operands = operands_.data();
+  const double *constants = constants_.data();
+  const size_t size = code_.size();
+  Dual *slots = stack + max_depth_;
+  Dual *top = stack - 1;
+
+  for (size_t i = 0; i < size; ++i) {
+    switch (code[i]) {
+      case op_number:
+        *++top = Dual::Constant(constants[operands[i]]);
+        break;
+      case op_variable:
+        *++top = bindings[operands[i]];
+        break;
+      case op_load:
+        *++top = slots[operands[i]];
+        break;
+      case op_store:
+        slots[operands[i]] = *top;
+        break;
+      case op_cos:
+        *top = Cos(*top);
+        break;
+      case op_sin:
+        *top = Sin(*top);
+        break;
+      case op_tan:
+        *top = Tan(*top);
+        break;
+      case op_acos:
+        *top = Acos(*top);
+        break;
+      case op_asin:
+        *top = Asin(*top);
+        break;
+      case op_atan:
+        *top = Atan(*top);
+        break;
+      case op_ln:
+        *top = Ln(*top);
+        break;
+      case op_log:
+        *top = Log(*top);
+        break;
+      case op_sqrt:
+        *top = Sqrt(*top);
+        break;
+      case op_neg:
+        *top = -*top;
+        break;
+      case op_powi:
+        *top = PowerByParts(*top, constants[operands[i]]);
+        break;
+      case op_horner:
+        *top = HornerScheme(*top, constants + operands[i]);
+        break;
+      case op_pow:
+        --top;
+        *top = Pow(top[0], top[1]);
+        break;
+      case op_mult:
+        --top;
+        *top = top[0] * top[1];
+        break;
+      case op_div:
+        --top;
+        *top = top[0] / top[1];
+        break;
+      case op_mod:
+        --top;
+        *top = Modulo(top[0], top[1]);
+        break;
+      case op_plus:
+        --top;
+        *top = top[0] + top[1];
+        break;
+      case op_minus:
+        --top;
+        *top = top[0] - top[1];
+        break;
+    }
+  }
+  return *top;
+}
+
+/**
+ * @brief Цикл интерпретации байт-кода для блока значений одной переменной.
+ * @param bindings Значения остальных переменных по номерам ячеек.
+ * @param slot Номер ячейки, в которую подставляются values.
+ * @param values Значения переменной (не больше kBlockSize).
+ * @param results Массив для результатов.
+ * @param count Количество значений в блоке.
+ * @param stack Буфер размером GetFrameSize() * kBlockSize: стэк блоков, затем
+ * ячейки.
+ * @param uniform Буфер из GetFrameSize() флагов для элементов стэка и ячеек.
+ * @details Элемент, который не зависит от переменной slot (числа, остальные
+ * переменные и операции только над ними), помечается флагом uniform и
+ * хранится одним значением в начале блока. Операции над такими элементами
+ * выполняются один раз на блок, а не для каждого значения: например, в
+ * sin(a) * x синус считается один раз. Значение размножается на весь блок,
+ * только когда встречается с зависящим от переменной операндом. Ядра
+ * вызываются с count = 1 и считают так же, как для всего блока, поэтому
+ * результат совпадает со скалярным побитово.
+ */
+void CompiledExpression::RunBlock(const double *bindings, size_t slot,
+                                  const double *values, double *results,
+                                  size_t count, double *stack,
+                                  bool *uniform) const {
+  const OpCode *code = code_.data();
+  const uint32_t *operands = operands_.data();
+  const double *constants = constants_.data();
+  const size_t size = code_.size();
+  double *slots = stack + max_depth_ * kBlockSize;
+  bool *slots_uniform = uniform + max_depth_;
+  double *top = stack - kBlockSize;
+  bool *top_uniform = uniform - 1;
+
+  // Количество значений, которые нужно считать для вершины стэка.
+  auto width = [&]() -> size_t { return *top_uniform ? 1 : count; };
+  // Снятие правого операнда со стэка и выравнивание операндов: если зависит
+  // только один, второй размножается на весь блок.
+  auto pop_operand = [&]() -> size_t {
+    top -= kBlockSize;
+    --top_uniform;
+    if (top_uniform[0] != top_uniform[1]) {
+      double *block = top_uniform[0] ? top : top + kBlockSize;
+      std::fill(block + 1, block + count, block[0]);
+      top_uniform[0] = false;
+    }
+    return width();
+  };
+
+  for (size_t i = 0; i < size; ++i) {
+    switch (code[i]) {
+      case op_number:
+        top += kBlockSize;
+        *++top_uniform = true;
+        top[0] = constants[operands[i]];
+        break;
+      case op_variable:
+        top += kBlockSize;
+        *++top_uniform = operands[i] != slot;
+        if (operands[i] == slot) {
+          std::memcpy(top, values, count * sizeof(double));
+        } else {
+          top[0] = bindings[operands[i]];
+        }
+        break;
+      case op_load:
+        top += kBlockSize;
+        *++top_uniform = slots_uniform[operands[i]];
+        std::memcpy(top, slots + operands[i] * kBlockSize,
+                    width() * sizeof(double));
+        break;
+      case op_store:
+        slots_uniform[operands[i]] = *top_uniform;
+        std::memcpy(slots + operands[i] * kBlockSize, top,
+                    width() * sizeof(double));
+        break;
+      case op_cos:
+        UnaryKernel(top, width(), [](double n) { return cos(n); });
+        break;
+      case op_sin:
+        UnaryKernel(top, width(), [](double n) { return sin(n); });
+        break;
+      case op_tan:
+        UnaryKernel(top, width(), [](double n) { return tan(n); });
+        break;
+      case op_acos:
+        UnaryKernel(top, width(), [](double n) { return acos(n); });
+        break;
+      case op_asin:
+        UnaryKernel(top, width(), [](double n) { return asin(n); });
+        break;
+      case op_atan:
+        UnaryKernel(top, width(), [](double n) { return atan(n); });
+        break;
+      case op_ln:
+        UnaryKernel(top, width(), [](double n) { return log(n); });
+        break;
+      case op_log:
+        UnaryKernel(top, width(), [](double n) { return log10(n); });
+        break;
+      case op_sqrt:
+        SqrtKernel(top, width());
+        break;
+      case op_neg:
+        UnaryKernel(top, width(), [](double n) { return 0.0 - n; });
+        break;
+      case op_powi: {
+        double exponent = constants[operands[i]];
+        UnaryKernel(top, width(),
+                    [exponent](double n) { return PowerByParts(n, exponent); });
+        break;
+      }
+      case op_horner:
+        HornerKernel<kBlockSize>(top, width(), constants + operands[i]);
+        break;
+      case op_pow: {
+        size_t lanes = pop_operand();
+        BinaryKernel(top, top + kBlockSize, lanes,
+                     [](double n, double m) { return pow(n, m); });
+        break;
+      }
+      case op_mult: {
+        size_t lanes = pop_operand();
+        ArithmeticKernel<a_mult>(top, top + kBlockSize, lanes);
+        break;
+      }
+      case op_div: {
+        size_t lanes = pop_operand();
+        ArithmeticKernel<a_div>(top, top + kBlockSize, lanes);
+        break;
+      }
+      case op_mod: {
+        size_t lanes = pop_operand();
+        BinaryKernel(top, top + kBlockSize, lanes,
+                     [](double n, double m) { return Modulo(n, m); });
+        break;
+      }
+      case op_plus: {
+        size_t lanes = pop_operand();
+        ArithmeticKernel<a_plus>(top, top + kBlockSize, lanes);
+        break;
+      }
+      case op_minus: {
+        size_t lanes = pop_operand();
+        ArithmeticKernel<a_minus>(top, top + kBlockSize, lanes);
+        break;
+      }
+    }
+  }
+  if (*top_uniform) {
+    std::fill(results, results + count, top[0]);
+  } else {
+    std::memcpy(results, top, count * sizeof(double));
+  }
+}
+
+}  // namespace s21
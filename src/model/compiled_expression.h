@@ -0,0 +1,224 @@
+#ifndef SMARTCALC_MODEL_COMPILED_EXPRESSION_H_
+#define SMARTCALC_MODEL_COMPILED_EXPRESSION_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "dual.h"
+#include "interval.h"
+
+namespace s21 {
+
+/**
+ * @brief Класс для выражения, разобранного один раз и готового к многократному
+ * вычислению.
+ * @details Выражение хранится в виде байт-кода обратной польской записи: в
+ * массиве code_ лежат коды операций, в массиве operands_ - индексы операндов
+ * (для чисел - индекс в таблице констант constants_). Вычисление идет по
+ * стэку значений, размер которого известен заранее (max_depth_), поэтому не
+ * требует выделения памяти и вызовов через std::function. Общие подвыражения
+ * вычисляются один раз: результат записывается в ячейку (op_store), а
+ * остальные использования читают его оттуда (op_load). Ячейки лежат в том же
+ * буфере сразу после стэка.
+ *
+ * Пакетное вычисление обрабатывает иксы блоками по kBlockSize: каждая ячейка
+ * стэка хранит значения для всего блока (структура массивов), и каждая
+ * операция байт-кода выполняется сразу над блоком векторными инструкциями
+ * SSE2 или AVX (выбирается во время выполнения по возможностям процессора).
+ *
+ * Переменные пронумерованы в порядке первого появления в выражении
+ * (GetVariables), и вычисление принимает плотный массив их значений по этим
+ * номерам, поэтому смена значений не требует повторного разбора. Evaluate от
+ * одного числа подставляет его в нулевую ячейку - это удобно для выражений от
+ * одного икса.
+ *
+ * EvaluateInterval вычисляет тот же байт-код в интервальной арифметике:
+ * результат гарантированно содержит значения выражения во всех точках
+ * отрезков переменных и сообщает, непрерывно ли выражение на них.
+ *
+ * EvaluateDerivative вычисляет байт-код над дуальными числами (Dual) и за
+ * один проход возвращает значение вместе с первой и второй производными.
+ *
+ * Для часто вычисляемых выражений можно включить JIT (SetJitMode): байт-код
+ * переводится в машинный код x86-64, и дальше вычисление идет через обычный
+ * указатель на функцию.
+ */
+class CompiledExpression {
+ public:
+  /**
+   * @brief Перечисление кодов операций байт-кода.
+   */
+  enum OpCode : uint8_t {
+    op_number,  ///< Положить в стэк константу
+    op_variable,  ///< Положить в стэк значение переменной из ячейки
+    op_load,    ///< Положить в стэк значение из ячейки общего подвыражения
+    op_store,   ///< Записать верхушку стэка в ячейку общего подвыражения
+    op_cos,
+    op_sin,
+    op_tan,
+    op_acos,
+    op_asin,
+    op_atan,
+    op_ln,
+    op_log,
+    op_sqrt,
+    op_neg,     ///< Унарный минус (вычисляется как 0 - a)
+    op_powi,    ///< Степень с целым или полуцелым показателем из таблицы
+                ///< констант (цепочка умножений и корень)
+    op_horner,  ///< Многочлен от аргумента по схеме Горнера, коэффициенты в
+                ///< таблице констант: их количество, затем от старшего
+    op_pow,
+    op_mult,
+    op_div,
+    op_mod,
+    op_plus,
+    op_minus
+  };
+
+  /**
+   * @brief Перечисление режимов JIT.
+   */
+  enum JitMode {
+    jit_off,    ///< Только интерпретатор
+    jit_auto,   ///< Машинный код после kJitThreshold вычислений
+    jit_always  ///< Машинный код сразу
+  };
+
+  CompiledExpression() = default;
+
+  CompiledExpression(const CompiledExpression &) = default;
+
+  CompiledExpression(CompiledExpression &&) noexcept = default;
+
+  CompiledExpression &operator=(const CompiledExpression &) = default;
+
+  CompiledExpression &operator=(CompiledExpression &&) noexcept = default;
+
+  ~CompiledExpression() = default;
+
+  double Evaluate(double x) const;
+
+  double Evaluate(const double *bindings, size_t bindings_count) const;
+
+  void Evaluate(const double *x_values, double *results, size_t count) const;
+
+  void Evaluate(const double *bindings, size_t slot, const double *values,
+                double *results, size_t count) const;
+
+  Interval EvaluateInterval(const Interval &x) const;
+
+  Interval EvaluateInterval(const Interval *bindings,
+                            size_t bindings_count) const;
+
+  Dual EvaluateDerivative(double x) const;
+
+  Dual EvaluateDerivative(const double *bindings, size_t bindings_count,
+                          size_t slot) const;
+
+  void EvaluateDerivative(const double *x_values, double *values,
+                          double *derivatives, double *second_derivatives,
+                          size_t count) const;
+
+  bool UsesX() const;
+
+  const std::vector<std::string> &GetVariables() const;
+
+  int FindVariable(std::string_view name) const;
+
+  static bool IsBinary(OpCode code);
+
+  static double Apply(OpCode code, double left, double right);
+
+  size_t GetSize() const;
+
+  int GetMaxDepth() const;
+
+  int GetSlotsCount() const;
+
+  size_t GetMemoryUsage() const;
+
+  void SetJitMode(JitMode mode);
+
+  bool IsJitCompiled() const;
+
+ private:
+  friend class ExpressionParser;
+  friend class ExpressionTree;
+  friend class JitFunction;
+
+  struct JitState;
+
+  static constexpr int kInlineStackSize = 64;  ///< Глубина стэка, для которой
+                                               ///< хватает буфера на стэке
+                                               ///< вызова.
+
+  static constexpr size_t kBlockSize = 256;  ///< Количество иксов, которые
+                                            ///< пакетно вычисляются за раз.
+
+  static constexpr uint64_t kJitThreshold = 1000;  ///< Количество вычисленных
+                                                  ///< значений, после которого
+                                                  ///< в режиме jit_auto
+                                                  ///< генерируется машинный
+                                                  ///< код.
+
+  void PushNumber(double number);
+
+  void PushVariable(int slot);
+
+  void PushLoad(int slot);
+
+  void PushStore(int slot);
+
+  void PushOperation(OpCode code);
+
+  void PushOperation(OpCode code, double parameter);
+
+  void PushPolynomial(const double *coefficients, size_t count);
+
+  void Reserve(size_t code_size, size_t constants_size);
+
+  void SetVariables(const std::string_view *names, size_t count);
+
+  size_t GetFrameSize() const;
+
+  JitState *GetJit(uint64_t values_count) const;
+
+  double RunScalar(const double *bindings) const;
+
+  double Run(const double *bindings, double *stack) const;
+
+  Interval RunInterval(const Interval *bindings, Interval *stack) const;
+
+  Dual RunDual(const Dual *bindings, Dual *stack) const;
+
+  void RunBlock(const double *bindings, size_t slot, const double *values,
+                double *results, size_t count, double *stack,
+                bool *uniform) const;
+
+  std::vector<OpCode> code_;  ///< Коды операций.
+
+  std::vector<uint32_t> operands_;  ///< Индексы операндов для каждой операции.
+
+  std::vector<double> constants_;  ///< Таблица констант выражения.
+
+  int depth_ = 0;  ///< Глубина стэка после последней записанной операции.
+
+  int max_depth_ = 0;  ///< Максимальная глубина стэка при вычислении.
+
+  int slots_count_ = 0;  ///< Количество ячеек для общих подвыражений.
+
+  std::vector<std::string> variables_;  ///< Имена переменных по номерам
+                                        ///< ячеек (в нижнем регистре).
+
+  std::shared_ptr<JitState> jit_;  ///< Состояние JIT (общее для копий
+                                   ///< выражения), nullptr - если JIT
+                                   ///< выключен.
+};
+
+}  // namespace s21
+
+#endif  // SMARTCALC_MODEL_COMPILED_EXPRESSION_H_
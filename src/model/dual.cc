@@ -0,0 +1,158 @@
+#include "dual.h"
+
+#include <cmath>
+#include <cstddef>
+
+#include "operations.h"
+
+namespace s21 {
+
+namespace {
+
+constexpr double kLn10 = 2.30258509299404568402;  ///< Натуральный логарифм
+                                                  ///< десяти.
+
+/**
+ * @brief Правило цепочки для функции одного аргумента.
+ * @param a Аргумент.
+ * @param value Значение функции f(a.value).
+ * @param first Первая производная f'(a.value).
+ * @param second Вторая производная f''(a.value).
+ */
+Dual Chain(const Dual &a, double value, double first, double second) {
+  return {value, first * a.first,
+          second * a.first * a.first + first * a.second};
+}
+
+/**
+ * @brief Произведение, в котором ноль на бесконечность дает ноль.
+ * @details Нужно для производных степеней: у x^0 и x^1 при x = 0
+ * коэффициенты нулевые, а степени с отрицательным показателем бесконечны.
+ */
+double Scale(double factor, double value) {
+  return factor == 0 ? 0 : factor * value;
+}
+
+}  // namespace
+
+Dual operator+(const Dual &a, const Dual &b) {
+  return {a.value + b.value, a.first + b.first, a.second + b.second};
+}
+
+Dual operator-(const Dual &a, const Dual &b) {
+  return {a.value - b.value, a.first - b.first, a.second - b.second};
+}
+
+/**
+ * @details Значение вычисляется как 0 - a, как и в байт-коде.
+ */
+Dual operator-(const Dual &a) {
+  return {0.0 - a.value, 0.0 - a.first, 0.0 - a.second};
+}
+
+Dual operator*(const Dual &a, const Dual &b) {
+  return {a.value * b.value, a.first * b.value + a.value * b.first,
+          a.second * b.value + 2 * a.first * b.first + a.value * b.second};
+}
+
+Dual operator/(const Dual &a, const Dual &b) {
+  double quotient = a.value / b.value;
+  double first = (a.first - quotient * b.first) / b.value;
+  return {quotient, first,
+          (a.second - 2 * first * b.first - quotient * b.second) / b.value};
+}
+
+Dual Sin(const Dual &a) {
+  double sine = std::sin(a.value);
+  return Chain(a, sine, std::cos(a.value), -sine);
+}
+
+Dual Cos(const Dual &a) {
+  double cosine = std::cos(a.value);
+  return Chain(a, cosine, -std::sin(a.value), -cosine);
+}
+
+Dual Tan(const Dual &a) {
+  double tangent = std::tan(a.value);
+  double first = 1 + tangent * tangent;
+  return Chain(a, tangent, first, 2 * tangent * first);
+}
+
+Dual Acos(const Dual &a) {
+  double rest = 1 - a.value * a.value;
+  double root = std::sqrt(rest);
+  return Chain(a, std::acos(a.value), -1 / root, -a.value / (rest * root));
+}
+
+Dual Asin(const Dual &a) {
+  double rest = 1 - a.value * a.value;
+  double root = std::sqrt(rest);
+  return Chain(a, std::asin(a.value), 1 / root, a.value / (rest * root));
+}
+
+Dual Atan(const Dual &a) {
+  double first = 1 / (1 + a.value * a.value);
+  return Chain(a, std::atan(a.value), first, -2 * a.value * first * first);
+}
+
+Dual Ln(const Dual &a) {
+  double first = 1 / a.value;
+  return Chain(a, std::log(a.value), first, -first * first);
+}
+
+Dual Log(const Dual &a) {
+  double first = 1 / (a.value * kLn10);
+  return Chain(a, std::log10(a.value), first, -first / a.value);
+}
+
+Dual Sqrt(const Dual &a) {
+  double root = std::sqrt(a.value);
+  double first = 0.5 / root;
+  return Chain(a, root, first, -first / (2 * a.value));
+}
+
+/**
+ * @details Если показатель - константа, производная берется как у степенной
+ * функции (и определена при отрицательном основании), иначе - как у
+ * exp(exponent * ln(base)).
+ */
+Dual Pow(const Dual &base, const Dual &exponent) {
+  double value = std::pow(base.value, exponent.value);
+  if (exponent.first == 0 && exponent.second == 0) {
+    double power = exponent.value;
+    return Chain(base, value,
+                 Scale(power, std::pow(base.value, power - 1)),
+                 Scale(power * (power - 1), std::pow(base.value, power - 2)));
+  }
+  Dual logarithm = exponent * Ln(base);
+  return {value, value * logarithm.first,
+          value * (logarithm.second + logarithm.first * logarithm.first)};
+}
+
+Dual PowerByParts(const Dual &base, double exponent) {
+  return Chain(base, PowerByParts(base.value, exponent),
+               Scale(exponent, PowerByParts(base.value, exponent - 1)),
+               Scale(exponent * (exponent - 1),
+                     PowerByParts(base.value, exponent - 2)));
+}
+
+Dual HornerScheme(const Dual &x, const double *coefficients) {
+  size_t coefficients_count = static_cast<size_t>(coefficients[0]);
+  Dual accumulator = Dual::Constant(coefficients[1]);
+  for (size_t k = 2; k <= coefficients_count; ++k) {
+    accumulator = accumulator * x + Dual::Constant(coefficients[k]);
+  }
+  return accumulator;
+}
+
+/**
+ * @details Остаток равен n - trunc(n / m) * m, и между скачками целая часть
+ * частного постоянна.
+ */
+Dual Modulo(const Dual &n, const Dual &m) {
+  double quotient = std::trunc(n.value / m.value);
+  return {Modulo(n.value, m.value), n.first - quotient * m.first,
+          n.second - quotient * m.second};
+}
+
+}  // namespace s21
@@ -0,0 +1,68 @@
+#ifndef SMARTCALC_MODEL_DUAL_H_
+#define SMARTCALC_MODEL_DUAL_H_
+
+namespace s21 {
+
+/**
+ * @brief Значение функции вместе с первой и второй производными для
+ * автоматического дифференцирования вперед.
+ * @details Операция над такими числами вычисляет значение и применяет к
+ * производным аргументов правило цепочки, поэтому производные выражения
+ * получаются за один проход байт-кода без конечных разностей и их ошибок
+ * округления.
+ */
+struct Dual {
+  double value = 0;   ///< Значение.
+  double first = 0;   ///< Первая производная.
+  double second = 0;  ///< Вторая производная.
+
+  /**
+   * @brief Константа (производные равны нулю).
+   */
+  static Dual Constant(double value) { return {value, 0, 0}; }
+
+  /**
+   * @brief Переменная, по которой идет дифференцирование.
+   */
+  static Dual Variable(double value) { return {value, 1, 0}; }
+};
+
+Dual operator+(const Dual &a, const Dual &b);
+
+Dual operator-(const Dual &a, const Dual &b);
+
+Dual operator-(const Dual &a);
+
+Dual operator*(const Dual &a, const Dual &b);
+
+Dual operator/(const Dual &a, const Dual &b);
+
+Dual Sin(const Dual &a);
+
+Dual Cos(const Dual &a);
+
+Dual Tan(const Dual &a);
+
+Dual Acos(const Dual &a);
+
+Dual Asin(const Dual &a);
+
+Dual Atan(const Dual &a);
+
+Dual Ln(const Dual &a);
+
+Dual Log(const Dual &a);
+
+Dual Sqrt(const Dual &a);
+
+Dual Pow(const Dual &base, const Dual &exponent);
+
+Dual PowerByParts(const Dual &base, double exponent);
+
+Dual HornerScheme(const Dual &x, const double *coefficients);
+
+Dual Modulo(const Dual &n, const Dual &m);
+
+}  // namespace s21
+
+#endif  // SMARTCALC_MODEL_DUAL_H_
@@ -0,0 +1,635 @@
+#include "expression_parser.h"
+
+#include <algorithm>
+#include <iterator>
+#include <new>
+#include <type_traits>
+
+namespace s21 {
+
+namespace {
+
+/**
+ * @brief Проверка, что строки таблицы операторов стоят в порядке типов.
+ */
+template <typename Table>
+constexpr bool IsIndexedByType(const Table &table) {
+  for (size_t i = 0; i < std::size(table); ++i) {
+    if (static_cast<size_t>(table[i].type) != i) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Оценка количества лексем выражения без разбора.
+ * @param input Строка с выражением.
+ * @details Слово или число дает одну лексему, знак + или - - две (с нулем
+ * перед унарным знаком), остальные символы, кроме пробелов, - по одной.
+ * Слитные записи вроде 2x или xmod2 дают больше лексем, чем слов, тогда
+ * вектор просто дорастет.
+ */
+size_t EstimateLexemasCount(std::string_view input) {
+  size_t count = 0;
+  bool in_word = false;
+  for (char symbol : input) {
+    char lower = ToLower(symbol);
+    bool is_word = (lower >= 'a' && lower <= 'z') ||
+                   (symbol >= '0' && symbol <= '9') || symbol == '.' ||
+                   symbol == '_';
+    if (is_word) {
+      count += !in_word;
+    } else if (symbol != ' ') {
+      count += symbol == '+' || symbol == '-' ? 2 : 1;
+    }
+    in_word = is_word;
+  }
+  return count;
+}
+
+}  // namespace
+
+/**
+ * @brief Компиляция выражения: парсинг, валидация, перевод в дерево обратной
+ * польской записи, оптимизация дерева и запись байт-кода.
+ * @param input_expression Строка с выражением.
+ * @return Скомпилированное выражение или ошибка с позицией в строке.
+ * @details Ошибки передаются кодами возврата, поэтому некорректная строка
+ * обходится так же дешево, как корректная.
+ */
+Result<CompiledExpression> ExpressionParser::Compile(
+    std::string_view input_expression) noexcept {
+  CalculationError error;
+  CompiledExpression expression;
+  try {
+    error = BuildTree(input_expression);
+    if (error.code == err_none) {
+      tree_.Optimize();
+      tree_.Emit(expression);
+      expression.SetVariables(variables_.data(), variables_.size());
+    }
+  } catch (const std::bad_alloc &ex) {
+    error = CalculationError{err_out_of_memory};
+  }
+  ClearAll();
+  if (error.code != err_none) {
+    return error;
+  }
+  return expression;
+}
+
+/**
+ * @brief Символьное дифференцирование выражения.
+ * @param input_expression Строка с выражением.
+ * @param variable Имя переменной дифференцирования (без учета регистра).
+ * @return Строка с упрощенной производной или ошибка разбора исходной
+ * строки. Если переменной в выражении нет, производная - "0".
+ * @details Выражение разбирается в дерево, как при компиляции, но вместо
+ * оптимизаций для байт-кода дерево заменяется производной и записывается
+ * обратно в строку. Ее можно компилировать и дифференцировать дальше как
+ * любое выражение.
+ */
+Result<std::string> ExpressionParser::Differentiate(
+    std::string_view input_expression, std::string_view variable) noexcept {
+  CalculationError error;
+  std::string derivative;
+  try {
+    error = BuildTree(input_expression);
+    if (error.code == err_none) {
+      tree_.Differentiate(FindVariable(variable));
+      derivative = tree_.ToString(variables_.data());
+    }
+  } catch (const std::bad_alloc &ex) {
+    error = CalculationError{err_out_of_memory};
+  }
+  ClearAll();
+  if (error.code != err_none) {
+    return error;
+  }
+  return derivative;
+}
+
+/**
+ * @brief Конструктор.
+ * @param type Тип лексемы.
+ * @param group Группа лексемы.
+ * @param prior Приоритет лексемы.
+ * @param value Значение числа (для лексемы-числа).
+ */
+ExpressionParser::Lexema::Lexema(Type type, Group group, int prior,
+                                 double value)
+    : value_(value),
+      type_(type),
+      group_(group),
+      priority_(static_cast<uint8_t>(prior)) {
+  static_assert(sizeof(Lexema) == 16 && std::is_trivially_copyable_v<Lexema>,
+                "Lexema must stay a compact trivially copyable token");
+}
+
+/**
+ * @brief Функиця-геттер, возвращающая тип лексемы.
+ */
+ExpressionParser::Type ExpressionParser::Lexema::GetType() const {
+  return type_;
+}
+
+/**
+ * @brief Функиця-геттер, возвращающая группу лексемы.
+ */
+ExpressionParser::Group ExpressionParser::Lexema::GetGroup() const {
+  return group_;
+}
+
+/**
+ * @brief Функиця-геттер, возвращающая приоритет лексемы.
+ * @return Тип лексемы (число от 1 до 4).
+ */
+int ExpressionParser::Lexema::GetPrioroty() const { return priority_; }
+
+/**
+ * @brief Функиця-геттер, возвращающая значение числа.
+ */
+double ExpressionParser::Lexema::GetValue() const { return value_; }
+
+/**
+ * @brief Функция для разбивки выражения на лексемы и их валидации.
+ * @param input_expression Строка с выражением.
+ * @return Ошибка (err_none, если выражение корректно).
+ */
+CalculationError ExpressionParser::ParseExpression(
+    std::string_view input_expression) {
+  source_ = input_expression;
+  parsed_lexemas_.reserve(EstimateLexemasCount(input_expression));
+  Lexer lexer(input_expression);
+  int brackets_count = 0;
+
+  Lexer::Token token;
+  ErrorCode code = err_none;
+  while ((code = lexer.Read(token)) == err_none &&
+         token.kind != Lexer::tk_end) {
+    if (token.kind == Lexer::tk_number) {
+      PushNumberLexema(token.value);
+    } else if (token.kind == Lexer::tk_keyword) {
+      code = ParseKeyword(token.keyword);
+    } else if (token.kind == Lexer::tk_name) {
+      PushVariableLexema(input_expression.substr(token.position, token.length));
+    } else {
+      code = ParseSymbol(token.symbol, brackets_count);
+    }
+    if (code != err_none) {
+      break;
+    }
+  }
+  if (code != err_none) {
+    return {code, lexer.GetTokenPosition()};
+  }
+  if (parsed_lexemas_.empty()) {
+    return {err_empty_input};
+  }
+  return ValidateParsedLexemas(brackets_count);
+}
+
+/**
+ * @brief Лексема (число) кладется в массив прочитанных лексем.
+ * @param number Число.
+ */
+void ExpressionParser::PushNumberLexema(double number) {
+  parsed_lexemas_.push_back(Lexema(t_number, g_number, 0, number));
+}
+
+/**
+ * @brief Переменная кладется в массив прочитанных лексем.
+ * @param name Имя переменной.
+ * @details Переменной назначается ячейка: номер ее первого появления в
+ * выражении. Регистр букв в имени не учитывается.
+ */
+void ExpressionParser::PushVariableLexema(std::string_view name) {
+  auto same_name = [name](std::string_view other) {
+    return IsSameName(name, other);
+  };
+  size_t slot = std::find_if(variables_.begin(), variables_.end(), same_name) -
+                variables_.begin();
+  if (slot == variables_.size()) {
+    variables_.push_back(name);
+  }
+  parsed_lexemas_.push_back(
+      Lexema(t_variable, g_number, 0, static_cast<double>(slot)));
+}
+
+/**
+ * @brief Поиск лексемы (функции или опертора) по типу в таблице kOperators.
+ * @param type Тип искомой лексемы.
+ * @return Лексема или лексема группы g_none, если оператор не поддерживается.
+ */
+ExpressionParser::Lexema ExpressionParser::FindLexemaInTable(Type type) {
+  static_assert(std::size(kOperators) == t_none + 1 &&
+                    IsIndexedByType(kOperators),
+                "kOperators must be indexed by Type");
+  const OperatorInfo &info = kOperators[type];
+  if (info.group == g_number || info.group == g_none) {
+    return Lexema(t_none, g_none, 0);
+  }
+  return Lexema(type, info.group, info.priority);
+}
+
+/**
+ * @brief Лексема (функция или оператор) кладется в массив прочитанных
+ * лексем.
+ * @param type Тип лексемы.
+ * @return err_none или err_unsupported_operator.
+ */
+ErrorCode ExpressionParser::PushOperatorLexema(Type type) {
+  Lexema lexema = FindLexemaInTable(type);
+  if (lexema.GetGroup() == g_none) {
+    return err_unsupported_operator;
+  }
+  parsed_lexemas_.push_back(lexema);
+  return err_none;
+}
+
+/**
+ * @brief Ключевое слово (функция или оператор mod) кладется в массив
+ * прочитанных лексем.
+ * @param keyword Ключевое слово, прочитанное лексером.
+ * @return Код ошибки (err_none, если слово допустимо).
+ */
+ErrorCode ExpressionParser::ParseKeyword(Lexer::Keyword keyword) {
+  switch (keyword) {
+    case Lexer::kw_cos:
+      return PushOperatorLexema(t_cos);
+    case Lexer::kw_sin:
+      return PushOperatorLexema(t_sin);
+    case Lexer::kw_tan:
+      return PushOperatorLexema(t_tan);
+    case Lexer::kw_acos:
+      return PushOperatorLexema(t_acos);
+    case Lexer::kw_asin:
+      return PushOperatorLexema(t_asin);
+    case Lexer::kw_atan:
+      return PushOperatorLexema(t_atan);
+    case Lexer::kw_ln:
+      return PushOperatorLexema(t_ln);
+    case Lexer::kw_log:
+      return PushOperatorLexema(t_log);
+    case Lexer::kw_sqrt:
+      return PushOperatorLexema(t_sqrt);
+    case Lexer::kw_mod:
+      return PushOperatorLexema(t_mod);
+    default:
+      return err_incorrect_input;
+  }
+}
+
+/**
+ * @brief Определение, является ли оператор унарным.
+ * @return Результат определения: true - если оператор унарный, false - если
+ * не унарный.
+ */
+bool ExpressionParser::IsUnary() {
+  if (parsed_lexemas_.empty() ||
+      parsed_lexemas_.back().GetType() == t_opening_br) {
+    return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Парсинг оператора: оператор кладется в массив прочитанных лексем.
+ * @param symbol Символ оператора.
+ * @param brackets_count Баланс скобок.
+ * @return Код ошибки (err_none, если символ допустим).
+ */
+ErrorCode ExpressionParser::ParseSymbol(char symbol, int &brackets_count) {
+  Type result = t_none;
+  switch (symbol) {
+    case '+': {
+      if (IsUnary()) {
+        PushNumberLexema(0);
+      }
+      result = t_plus;
+      break;
+    }
+    case '-': {
+      if (IsUnary()) {
+        PushNumberLexema(0);
+      }
+      result = t_minus;
+      break;
+    }
+    case '*': {
+      result = t_mult;
+      break;
+    }
+    case '/': {
+      result = t_div;
+      break;
+    }
+    case '^': {
+      result = t_pow;
+      break;
+    }
+    case '(': {
+      result = t_opening_br;
+      ++brackets_count;
+      break;
+    }
+    case ')': {
+      result = t_closing_br;
+      --brackets_count;
+      break;
+    }
+    default: {
+      return err_incorrect_symbol;
+    }
+  }
+  return PushOperatorLexema(result);
+}
+
+/**
+ * @brief Проверка корректности первой лексемы.
+ * @return Ошибка (err_none, если лексема корректна).
+ */
+CalculationError ExpressionParser::ValidateFirstLexema() const {
+  auto first_lexema = parsed_lexemas_.front();
+  auto first_group = first_lexema.GetGroup();
+  auto first_type = first_lexema.GetType();
+  if (first_group == g_closing_br ||
+      (first_group == g_binary_op && first_type != t_minus &&
+       first_type != t_plus)) {
+    return ErrorAtLexema(0, err_incorrect_input);
+  }
+  return {};
+}
+
+/**
+ * @brief Проверка корректности последней лексемы.
+ * @return Ошибка (err_none, если лексема корректна).
+ */
+CalculationError ExpressionParser::ValidateLastLexema() const {
+  auto last_lexema = parsed_lexemas_.back();
+  auto last_group = last_lexema.GetGroup();
+  if (last_group == g_binary_op || last_group == g_opening_br ||
+      last_group == g_function) {
+    return ErrorAtLexema(parsed_lexemas_.size() - 1, err_incorrect_input);
+  }
+  return {};
+}
+
+/**
+ * @brief Проверка корректности последовательности всех лексем.
+ * @param brackets_count Количество встреченных в выражении скобок (и
+ * открывающих, и закрывающих).
+ * @return Ошибка (err_none, если последовательность корректна).
+ */
+CalculationError ExpressionParser::ValidateParsedLexemas(
+    int brackets_count) const {
+  CalculationError error = ValidateFirstLexema();
+  if (error.code == err_none) {
+    error = ValidateLastLexema();
+  }
+  if (error.code != err_none) {
+    return error;
+  }
+  if (brackets_count != 0) {
+    return {err_incorrect_brackets};
+  }
+
+  for (size_t i = 1; i < parsed_lexemas_.size(); ++i) {
+    if (!ValidityMatrix[parsed_lexemas_[i - 1].GetGroup()]
+                       [parsed_lexemas_[i].GetGroup()]) {
+      return ErrorAtLexema(i, err_incorrect_input);
+    }
+  }
+  return {};
+}
+
+/**
+ * @brief Восстановление позиций лексем в исходной строке.
+ * @return Смещение в source_ для каждой лексемы из parsed_lexemas_.
+ * @details Позиции не хранятся в лексемах: при ошибке строка разбирается
+ * повторно с теми же правилами, включая ноль, который добавляется перед
+ * унарным плюсом или минусом.
+ */
+std::vector<size_t> ExpressionParser::LexemaPositions() const {
+  std::vector<size_t> positions;
+  positions.reserve(parsed_lexemas_.size());
+  Lexer lexer(source_);
+  bool unary_allowed = true;
+  Lexer::Token token;
+  while (lexer.Read(token) == err_none && token.kind != Lexer::tk_end) {
+    bool is_sign =
+        token.kind == Lexer::tk_symbol &&
+        (token.symbol == '+' || token.symbol == '-');
+    if (is_sign && unary_allowed) {
+      positions.push_back(token.position);
+    }
+    positions.push_back(token.position);
+    unary_allowed = token.kind == Lexer::tk_symbol && token.symbol == '(';
+  }
+  return positions;
+}
+
+/**
+ * @brief Ошибка с позицией лексемы в исходной строке.
+ * @param index Номер ошибочной лексемы в parsed_lexemas_.
+ * @param code Код ошибки.
+ * @return Ошибка.
+ */
+CalculationError ExpressionParser::ErrorAtLexema(size_t index,
+                                                 ErrorCode code) const {
+  std::vector<size_t> positions = LexemaPositions();
+  if (index >= positions.size()) {
+    return {code};
+  }
+  return {code, positions[index]};
+}
+
+/**
+ * @brief Цикл для обработки прочитанных лексем после парсинга.
+ * @details Лексемы по порядку берутся из parsed_lexemas_ и распределяются:
+ * числа сразу записываются в дерево tree_, остальное складывается в стэк
+ * stack_of_operators_. Если приоритет лексемы на верхушке
+ * стэка stack_of_operators_ выше приоритета текущей (взятой из массива)
+ * лексемы, лежащие в стэке лексемы выталкиваются в дерево.
+ * @return Код ошибки (err_none, если выражение корректно).
+ */
+ErrorCode ExpressionParser::LexemasProcessing() {
+  ErrorCode code = err_none;
+  for (const Lexema &current_lexema : parsed_lexemas_) {
+    if (current_lexema.GetGroup() == g_number) {
+      code = EmitLexema(current_lexema);
+      ++numbers_count_;
+    } else if (current_lexema.GetGroup() == g_closing_br) {
+      code = ClosingBracketProcessing();
+    } else if (current_lexema.GetGroup() == g_opening_br) {
+      stack_of_operators_.push_back(current_lexema);
+    } else if (stack_of_operators_.empty() ||
+               current_lexema.GetPrioroty() >
+                   stack_of_operators_.back().GetPrioroty()) {
+      stack_of_operators_.push_back(current_lexema);
+    } else {
+      while (code == err_none && !stack_of_operators_.empty() &&
+             current_lexema.GetPrioroty() <=
+                 stack_of_operators_.back().GetPrioroty()) {
+        Lexema prev_lex = GetOperationFromStack();
+        code = MakeOperation(prev_lex);
+      }
+      stack_of_operators_.push_back(current_lexema);
+    }
+    if (code != err_none) {
+      return code;
+    }
+  }
+  return err_none;
+}
+
+/**
+ * @brief Проверка, что в стэке с числами при вычислении будет достаточно
+ * аргументов для операции, и учет их извлечения.
+ * @param count Количество аргументов операции.
+ * @return err_none или err_incorrect_input, если аргументов не хватает.
+ */
+ErrorCode ExpressionParser::TakeNumbersFromStack(int count) {
+  if (numbers_count_ < count) {
+    return err_incorrect_input;
+  }
+  numbers_count_ -= count;
+  return err_none;
+}
+
+/**
+ * @brief Извлечение лексемы с верхушки стэка с не числами stack_of_operators_
+ * (функциями, операторами, скобками). Стэк не должен быть пустым.
+ * @return Лексема.
+ */
+ExpressionParser::Lexema ExpressionParser::GetOperationFromStack() {
+  Lexema lex = stack_of_operators_.back();
+  stack_of_operators_.pop_back();
+  return lex;
+}
+
+/**
+ * @brief Запись лексемы (числа, переменной, функции или оператора) в дерево.
+ * @param lex Лексема.
+ * @return err_none или err_unsupported_operator.
+ */
+ErrorCode ExpressionParser::EmitLexema(const Lexema &lex) {
+  Group group = kOperators[lex.GetType()].group;
+  if (lex.GetType() == t_number) {
+    tree_.PushNumber(lex.GetValue());
+  } else if (lex.GetType() == t_variable) {
+    tree_.PushVariable(static_cast<int>(lex.GetValue()));
+  } else if (group == g_function || group == g_binary_op) {
+    tree_.PushOperation(kOperators[lex.GetType()].code);
+  } else {
+    return err_unsupported_operator;
+  }
+  return err_none;
+}
+
+/**
+ * @brief Запись операции, соответствующей текущей лексеме, в дерево.
+ * @param lex Текущая лексема.
+ * @return Код ошибки (err_none, если аргументов достаточно).
+ */
+ErrorCode ExpressionParser::MakeOperation(Lexema &lex) {
+  ErrorCode code = err_none;
+  if (lex.GetGroup() == g_function) {
+    code = TakeNumbersFromStack(1);
+  } else if (lex.GetGroup() == g_binary_op) {
+    code = TakeNumbersFromStack(2);
+  }
+  if (code == err_none) {
+    code = EmitLexema(lex);
+  }
+  ++numbers_count_;
+  return code;
+}
+
+/**
+ * @brief Действия при встрече закрывающй скобки в стэке.
+ * @details Выталкиваются операторы и производятся соответствующие вычисления,
+ * пока не будет встречена открывающая скобка.
+ * @return Код ошибки (err_none, если скобки согласованы).
+ */
+ErrorCode ExpressionParser::ClosingBracketProcessing() {
+  while (!stack_of_operators_.empty()) {
+    Lexema lex = GetOperationFromStack();
+    if (lex.GetGroup() == g_opening_br) {
+      return err_none;
+    }
+    ErrorCode code = MakeOperation(lex);
+    if (code != err_none) {
+      return code;
+    }
+  }
+  return err_incorrect_brackets;
+}
+
+/**
+ * @brief Цикл для финальной обработки (в обратную польскую запись переносятся
+ * операции оставшихся в стэке лексем).
+ * @return Код ошибки (err_none, если выражение сводится к одному значению).
+ */
+ErrorCode ExpressionParser::FinalCalculations() {
+  while (!stack_of_operators_.empty()) {
+    Lexema current_lexema = GetOperationFromStack();
+    ErrorCode code = MakeOperation(current_lexema);
+    if (code != err_none) {
+      return code;
+    }
+  }
+  if (numbers_count_ != 1) {
+    return err_incorrect_string;
+  }
+  return err_none;
+}
+
+/**
+ * @brief Разбор строки в дерево обратной польской записи с валидацией.
+ * @param input_expression Строка с выражением.
+ * @return Ошибка (err_none, если выражение корректно).
+ */
+CalculationError ExpressionParser::BuildTree(
+    std::string_view input_expression) {
+  CalculationError error = ParseExpression(input_expression);
+  if (error.code == err_none) {
+    error.code = LexemasProcessing();
+  }
+  if (error.code == err_none) {
+    error.code = FinalCalculations();
+  }
+  return error;
+}
+
+/**
+ * @brief Поиск ячейки переменной разобранного выражения по имени (без учета
+ * регистра).
+ * @param name Имя переменной.
+ * @return Номер ячейки или -1, если такой переменной нет.
+ */
+int ExpressionParser::FindVariable(std::string_view name) const {
+  for (size_t slot = 0; slot < variables_.size(); ++slot) {
+    if (IsSameName(name, variables_[slot])) {
+      return static_cast<int>(slot);
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Очищает стэки и массивы (на случай некорректного завершения
+ * вычисления) и сбрасывает арену.
+ */
+void ExpressionParser::ClearAll() {
+  numbers_count_ = 0;
+  source_ = std::string_view();
+  ReleaseMemory(parsed_lexemas_);
+  ReleaseMemory(stack_of_operators_);
+  ReleaseMemory(variables_);
+  tree_.Clear();
+  arena_.Reset();
+}
+
+}  // namespace s21
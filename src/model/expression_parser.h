@@ -0,0 +1,236 @@
+#ifndef SMARTCALC_MODEL_EXPRESSION_PARSER_H_
+#define SMARTCALC_MODEL_EXPRESSION_PARSER_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "arena.h"
+#include "compiled_expression.h"
+#include "expression_tree.h"
+#include "lexer.h"
+#include "result.h"
+
+namespace s21 {
+
+/**
+ * @brief Класс для разбора строки с выражением в байт-код.
+ * @details Хранит все рабочее состояние компиляции: лексемы, стэк операторов,
+ * дерево и арену, из которой они берут память. Между компиляциями состояние
+ * сбрасывается, а память арены переиспользуется. Ошибки передаются кодами
+ * возврата (ErrorCode), без исключений. Объект не потокобезопасен:
+ * PolishNotation держит по одному объекту на поток, поэтому сам калькулятор
+ * можно вызывать из нескольких потоков.
+ */
+class ExpressionParser {
+ public:
+  ExpressionParser() = default;
+
+  ExpressionParser(const ExpressionParser &) = delete;
+
+  ExpressionParser &operator=(const ExpressionParser &) = delete;
+
+  ~ExpressionParser() = default;
+
+  Result<CompiledExpression> Compile(
+      std::string_view input_expression) noexcept;
+
+  Result<std::string> Differentiate(std::string_view input_expression,
+                                    std::string_view variable) noexcept;
+
+ private:
+  /**
+   * @brief Перечисление групп лексем.
+   */
+  enum Group : uint8_t {
+    g_number,      ///< Число
+    g_unary_op,    ///< Унарный оператор
+    g_binary_op,   ///< Бинарный оператор
+    g_function,    ///< Функиця
+    g_opening_br,  ///< Открывающая скобка
+    g_closing_br,  ///< Закрывающая скобка
+    g_none         ///< Не определена
+  };
+
+  /**
+   * @brief Перечисление типов лексем.
+   */
+  enum Type : uint8_t {
+    t_cos,
+    t_sin,
+    t_tan,
+    t_acos,
+    t_asin,
+    t_atan,
+    t_ln,
+    t_log,
+    t_sqrt,
+    t_pow,
+    t_mult,
+    t_div,
+    t_mod,
+    t_plus,
+    t_minus,
+    t_unary_plus,
+    t_unary_minus,
+    t_opening_br,
+    t_closing_br,
+    t_number,
+    t_variable,
+    t_none
+  };
+
+  /**
+   * @brief Подкласс для отдельной лексемы.
+   * @details Лексема занимает 16 байт и тривиально копируется. Название
+   * оператора берется из таблицы kOperators по типу, а позиция в исходной
+   * строке восстанавливается только при ошибке (LexemaPositions).
+   */
+  class Lexema {
+   public:
+    Lexema(Type type, Group group, int prior, double value = 0);
+
+    Type GetType() const;
+
+    Group GetGroup() const;
+
+    int GetPrioroty() const;
+
+    double GetValue() const;
+
+   private:
+    double value_;  ///< Значение числа или номер ячейки переменной.
+
+    Type type_;  ///< Тип лексемы.
+
+    Group group_;  ///< Группа лексемы.
+
+    uint8_t priority_;  ///< Приориет лексемы.
+  };
+
+  /**
+   * @brief Описание оператора или функции в таблице kOperators.
+   */
+  struct OperatorInfo {
+    Type type;                        ///< Тип лексемы (индекс в таблице).
+    std::string_view name;            ///< Название лексемы.
+    Group group;                      ///< Группа лексемы.
+    int priority;                     ///< Приоритет лексемы.
+    CompiledExpression::OpCode code;  ///< Код операции байт-кода (для
+                                      ///< функций и бинарных операторов).
+  };
+
+  Arena arena_;  ///< Арена для лексем и дерева, сбрасывается после каждой
+                 ///< компиляции.
+
+  std::string_view source_;  ///< Компилируемая строка (только на время
+                             ///< компиляции, для сообщений об ошибках).
+
+  std::pmr::vector<Lexema> parsed_lexemas_{
+      &arena_};  ///< Прочитанные лексемы.
+
+  ExpressionTree tree_{&arena_};  ///< Дерево, в которое записываются
+                                 ///< лексемы в порядке обратной польской
+                                 ///< записи.
+
+  std::pmr::vector<std::string_view> variables_{
+      &arena_};  ///< Имена переменных в порядке ячеек (части source_).
+
+  int numbers_count_ = 0;  ///< Количество чисел, которые окажутся в стэке
+                           ///< при вычислении записанных лексем.
+
+  std::pmr::vector<Lexema> stack_of_operators_{
+      &arena_};  ///< Стэк с нечислами из выражения (операторы, функции,
+                 ///< скобки).
+
+  CalculationError ParseExpression(std::string_view input_expression);
+
+  ErrorCode ParseKeyword(Lexer::Keyword keyword);
+
+  ErrorCode ParseSymbol(char symbol, int &brackets_count);
+
+  bool IsUnary();
+
+  Lexema FindLexemaInTable(Type type);
+
+  ErrorCode PushOperatorLexema(Type type);
+
+  void PushNumberLexema(double number);
+
+  void PushVariableLexema(std::string_view name);
+
+  std::vector<size_t> LexemaPositions() const;
+
+  CalculationError ErrorAtLexema(size_t index, ErrorCode code) const;
+
+  CalculationError ValidateFirstLexema() const;
+
+  CalculationError ValidateLastLexema() const;
+
+  CalculationError ValidateParsedLexemas(int brackets_count) const;
+
+  ErrorCode LexemasProcessing();
+
+  ErrorCode TakeNumbersFromStack(int count);
+
+  Lexema GetOperationFromStack();
+
+  ErrorCode EmitLexema(const Lexema &lex);
+
+  ErrorCode MakeOperation(Lexema &lex);
+
+  ErrorCode ClosingBracketProcessing();
+
+  ErrorCode FinalCalculations();
+
+  CalculationError BuildTree(std::string_view input_expression);
+
+  int FindVariable(std::string_view name) const;
+
+  void ClearAll();
+
+  /**
+  Таблица операторов и функций, общая для всех объектов. Индекс - тип лексемы.
+  */
+  static constexpr OperatorInfo kOperators[] = {
+      {t_cos, "cos", g_function, 4, CompiledExpression::op_cos},
+      {t_sin, "sin", g_function, 4, CompiledExpression::op_sin},
+      {t_tan, "tan", g_function, 4, CompiledExpression::op_tan},
+      {t_acos, "acos", g_function, 4, CompiledExpression::op_acos},
+      {t_asin, "asin", g_function, 4, CompiledExpression::op_asin},
+      {t_atan, "atan", g_function, 4, CompiledExpression::op_atan},
+      {t_ln, "ln", g_function, 4, CompiledExpression::op_ln},
+      {t_log, "log", g_function, 4, CompiledExpression::op_log},
+      {t_sqrt, "sqrt", g_function, 3, CompiledExpression::op_sqrt},
+      {t_pow, "^", g_binary_op, 3, CompiledExpression::op_pow},
+      {t_mult, "*", g_binary_op, 2, CompiledExpression::op_mult},
+      {t_div, "/", g_binary_op, 2, CompiledExpression::op_div},
+      {t_mod, "mod", g_binary_op, 2, CompiledExpression::op_mod},
+      {t_plus, "+", g_binary_op, 1, CompiledExpression::op_plus},
+      {t_minus, "-", g_binary_op, 1, CompiledExpression::op_minus},
+      {t_unary_plus, "+", g_none, 0, CompiledExpression::op_number},
+      {t_unary_minus, "-", g_none, 0, CompiledExpression::op_number},
+      {t_opening_br, "(", g_opening_br, 0, CompiledExpression::op_number},
+      {t_closing_br, ")", g_closing_br, 0, CompiledExpression::op_number},
+      {t_number, "", g_number, 0, CompiledExpression::op_number},
+      {t_variable, "", g_number, 0, CompiledExpression::op_variable},
+      {t_none, "", g_none, 0, CompiledExpression::op_number}};
+
+  /**
+  Матрица смежности для лексем. Определяет, могут ли две лексемы идти подряд в
+  корректном математичсеком выражении.
+  */
+  static constexpr bool ValidityMatrix[6][6] = {
+      {0, 0, 1, 0, 0, 1},  // number
+      {1, 0, 0, 1, 1, 0},  // unary
+      {1, 0, 0, 1, 1, 0},  // binary
+      {0, 0, 0, 0, 1, 0},  // funcs
+      {1, 1, 0, 1, 1, 0},  // (
+      {0, 0, 1, 0, 0, 1}   // )
+  };
+};
+
+}  // namespace s21
+
+#endif  // SMARTCALC_MODEL_EXPRESSION_PARSER_H_
@@ -0,0 +1,909 @@
+#include "expression_tree.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+#include "arena.h"
+#include "lexer.h"
+
+namespace s21 {
+
+namespace {
+
+/**
+ * @brief Ключ узла для поиска одинаковых поддеревьев: код операции, биты
+ * значения и индексы уже склеенных детей.
+ */
+using NodeKey = std::tuple<int, uint64_t, int, int>;
+
+/**
+ * @brief Хэш ключа узла.
+ */
+struct NodeKeyHash {
+  size_t operator()(const NodeKey &key) const {
+    size_t hash = std::hash<uint64_t>()(std::get<1>(key));
+    hash = hash * 31 + static_cast<size_t>(std::get<0>(key));
+    hash = hash * 1000003 + static_cast<size_t>(std::get<2>(key) + 1);
+    hash = hash * 1000003 + static_cast<size_t>(std::get<3>(key) + 1);
+    return hash;
+  }
+};
+
+/**
+ * @brief Приоритет операции при записи в строку (как у парсера), для
+ * констант, переменных и функций - наибольший.
+ */
+int GetPriority(CompiledExpression::OpCode code) {
+  switch (code) {
+    case CompiledExpression::op_plus:
+    case CompiledExpression::op_minus:
+      return 1;
+    case CompiledExpression::op_mult:
+    case CompiledExpression::op_div:
+    case CompiledExpression::op_mod:
+      return 2;
+    case CompiledExpression::op_pow:
+      return 3;
+    default:
+      return 5;
+  }
+}
+
+/**
+ * @brief Запись операции в строке: название функции или знак оператора.
+ */
+std::string_view GetOperationName(CompiledExpression::OpCode code) {
+  switch (code) {
+    case CompiledExpression::op_cos:
+      return "cos";
+    case CompiledExpression::op_sin:
+      return "sin";
+    case CompiledExpression::op_tan:
+      return "tan";
+    case CompiledExpression::op_acos:
+      return "acos";
+    case CompiledExpression::op_asin:
+      return "asin";
+    case CompiledExpression::op_atan:
+      return "atan";
+    case CompiledExpression::op_ln:
+      return "ln";
+    case CompiledExpression::op_log:
+      return "log";
+    case CompiledExpression::op_sqrt:
+      return "sqrt";
+    case CompiledExpression::op_pow:
+      return "^";
+    case CompiledExpression::op_mult:
+      return "*";
+    case CompiledExpression::op_div:
+      return "/";
+    case CompiledExpression::op_mod:
+      return " mod ";
+    case CompiledExpression::op_plus:
+      return "+";
+    default:
+      return "-";
+  }
+}
+
+}  // namespace
+
+/**
+ * @brief Конструктор.
+ * @param resource Источник памяти для узлов и временных массивов.
+ */
+ExpressionTree::ExpressionTree(std::pmr::memory_resource *resource)
+    : resource_(resource),
+      nodes_(resource),
+      polynomials_(resource),
+      stack_(resource) {}
+
+/**
+ * @brief Добавление константы.
+ * @param number Число.
+ */
+void ExpressionTree::PushNumber(double number) {
+  stack_.push_back(static_cast<int>(nodes_.size()));
+  nodes_.push_back({CompiledExpression::op_number, number});
+}
+
+/**
+ * @brief Добавление переменной.
+ * @param slot Номер ячейки переменной.
+ */
+void ExpressionTree::PushVariable(int slot) {
+  stack_.push_back(static_cast<int>(nodes_.size()));
+  nodes_.push_back(
+      {CompiledExpression::op_variable, static_cast<double>(slot)});
+}
+
+/**
+ * @brief Добавление функции или бинарного оператора, аргументы которых
+ * добавлены раньше.
+ * @param code Код операции.
+ */
+void ExpressionTree::PushOperation(OpCode code) {
+  Node node = {code, 0};
+  if (CompiledExpression::IsBinary(code)) {
+    node.right = stack_.back();
+    stack_.pop_back();
+  }
+  node.left = stack_.back();
+  stack_.back() = static_cast<int>(nodes_.size());
+  nodes_.push_back(node);
+}
+
+/**
+ * @brief Оптимизация дерева.
+ * @details Поддеревья, не зависящие от переменных, вычисляются один раз при
+ * компиляции и заменяются константой. Поддеревья, зависящие только от
+ * переменных, которые не меняются в пакетной развертке (sin(a) в
+ * sin(a) * x по иксу), здесь не сворачиваются: их значения неизвестны до
+ * вычисления, и RunBlock считает их один раз на блок. Из тождеств
+ * убирается только вычитание нуля "a - 0": оно не меняет ни одного значения,
+ * включая -0 и NaN, а "0 + a" и "0 - a" меняют знак нулевого результата.
+ *
+ * Затем суммы одночленов от одной переменной степени не меньше двух
+ * переводятся в схему
+ * Горнера, степени с целым и полуцелым показателем - в цепочки умножений и
+ * корень, деление на степень двойки - в умножение на точную обратную
+ * величину. Понижение идет только по достижимым от корня узлам: свертка
+ * оставляет недостижимые копии узлов с теми же детьми, и их обработка
+ * изменила бы общие константы второй раз.
+ */
+void ExpressionTree::Optimize() {
+  for (Node &node : nodes_) {
+    FoldNode(node);
+  }
+  LowerPolynomials();
+  std::pmr::vector<bool> reachable = MarkReachable();
+  std::pmr::vector<int> uses(nodes_.size(), 0, resource_);
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    if (reachable[i]) {
+      if (nodes_[i].left >= 0) ++uses[nodes_[i].left];
+      if (nodes_[i].right >= 0) ++uses[nodes_[i].right];
+    }
+  }
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    if (reachable[i]) {
+      ReduceStrength(nodes_[i], uses);
+    }
+  }
+  ShareSubexpressions();
+}
+
+/**
+ * @brief Запись графа в байт-код.
+ * @param expression Скомпилированное выражение, в которое записывается
+ * байт-код.
+ * @details Граф обходится в обратном порядке от корня. Узел, у которого
+ * несколько родителей, при первом обходе вычисляется и сохраняется в ячейку,
+ * при следующих - читается из нее. Константы и переменные в ячейки не
+ * сохраняются:
+ * положить их в стэк не дороже чтения ячейки.
+ */
+void ExpressionTree::Emit(CompiledExpression &expression) const {
+  std::pmr::vector<int> uses(nodes_.size(), 0, resource_);
+  for (const Node &node : nodes_) {
+    if (node.left >= 0) ++uses[node.left];
+    if (node.right >= 0) ++uses[node.right];
+  }
+  size_t code_size = 0;
+  size_t constants_size = 0;
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    size_t emitted = std::max(uses[i], 1);
+    if (nodes_[i].left >= 0) {
+      code_size += emitted > 1 ? emitted + 1 : 1;
+    } else {
+      code_size += emitted;
+    }
+    if (nodes_[i].code == CompiledExpression::op_number) {
+      constants_size += emitted;
+    } else if (nodes_[i].code == CompiledExpression::op_powi) {
+      constants_size += 1;
+    } else if (nodes_[i].code == CompiledExpression::op_horner) {
+      constants_size +=
+          1 + polynomials_[static_cast<size_t>(nodes_[i].value)].size();
+    }
+  }
+  expression.Reserve(code_size, constants_size);
+
+  std::pmr::vector<int> slots(nodes_.size(), -1, resource_);
+  int slots_count = 0;
+
+  std::pmr::vector<std::pair<int, bool>> pending(resource_);
+  pending.push_back({static_cast<int>(nodes_.size()) - 1, false});
+  while (!pending.empty()) {
+    auto [index, children_done] = pending.back();
+    pending.pop_back();
+    const Node &node = nodes_[index];
+    if (slots[index] >= 0) {
+      expression.PushLoad(slots[index]);
+    } else if (!children_done) {
+      pending.push_back({index, true});
+      if (node.right >= 0) pending.push_back({node.right, false});
+      if (node.left >= 0) pending.push_back({node.left, false});
+    } else {
+      if (node.code == CompiledExpression::op_number) {
+        expression.PushNumber(node.value);
+      } else if (node.code == CompiledExpression::op_variable) {
+        expression.PushVariable(static_cast<int>(node.value));
+      } else if (node.code == CompiledExpression::op_powi) {
+        expression.PushOperation(node.code, node.value);
+      } else if (node.code == CompiledExpression::op_horner) {
+        const std::pmr::vector<double> &coefficients =
+            polynomials_[static_cast<size_t>(node.value)];
+        expression.PushPolynomial(coefficients.data(), coefficients.size());
+      } else {
+        expression.PushOperation(node.code);
+      }
+      if (uses[index] > 1 && node.left >= 0) {
+        slots[index] = slots_count++;
+        expression.PushStore(slots[index]);
+      }
+    }
+  }
+}
+
+/**
+ * @brief Замена дерева его производной по переменной.
+ * @param slot Номер ячейки переменной (-1, если переменной в выражении нет:
+ * тогда производная равна нулю).
+ * @details Сначала сворачиваются константы и убираются нули перед унарными
+ * знаками, затем производные узлов вычисляются от детей к родителям и
+ * дописываются в конец массива узлов. Новые узлы сразу упрощаются (сложение
+ * с нулем, умножение на ноль и единицу, свертка констант), поэтому
+ * производная не разрастается из-за слагаемых вида 0 * x. Корнем становится
+ * производная старого корня.
+ */
+void ExpressionTree::Differentiate(int slot) {
+  for (Node &node : nodes_) {
+    FoldNode(node);
+    DropSignPadding(node);
+  }
+  size_t size = nodes_.size();
+  std::pmr::vector<int> derivatives(size, -1, resource_);
+  for (size_t i = 0; i < size; ++i) {
+    derivatives[i] = MakeDerivative(static_cast<int>(i), derivatives, slot);
+  }
+  int root = derivatives.back();
+  if (root != static_cast<int>(nodes_.size()) - 1) {
+    AddNode(nodes_[root]);
+  }
+}
+
+/**
+ * @brief Запись дерева в строку выражения.
+ * @param names Имена переменных по номерам ячеек.
+ * @return Строка, которая компилируется в то же выражение. Скобки ставятся
+ * только там, где без них изменился бы порядок операций.
+ */
+std::string ExpressionTree::ToString(const std::string_view *names) const {
+  std::string result;
+  WriteNode(static_cast<int>(nodes_.size()) - 1, 0, names, result);
+  return result;
+}
+
+/**
+ * @brief Очистка дерева. Память возвращается источнику целиком, чтобы
+ * арену можно было сбросить.
+ */
+void ExpressionTree::Clear() {
+  ReleaseMemory(nodes_);
+  ReleaseMemory(stack_);
+  ReleaseMemory(polynomials_);
+}
+
+/**
+ * @brief Проверка, является ли узел константой.
+ * @param index Индекс узла.
+ */
+bool ExpressionTree::IsConstant(int index) const {
+  return index >= 0 && nodes_[index].code == CompiledExpression::op_number;
+}
+
+/**
+ * @brief Проверка, является ли узел константой ноль.
+ * @param index Индекс узла.
+ */
+bool ExpressionTree::IsZero(int index) const {
+  return IsConstant(index) && nodes_[index].value == 0;
+}
+
+/**
+ * @brief Проверка, является ли узел константой один.
+ * @param index Индекс узла.
+ */
+bool ExpressionTree::IsOne(int index) const {
+  return IsConstant(index) && nodes_[index].value == 1;
+}
+
+/**
+ * @brief Проверка, что поддеревья записывают одно и то же выражение.
+ * @param first Индекс корня первого поддерева.
+ * @param second Индекс корня второго поддерева.
+ */
+bool ExpressionTree::IsSame(int first, int second) const {
+  if (first == second) {
+    return true;
+  }
+  if (first < 0 || second < 0) {
+    return false;
+  }
+  const Node &a = nodes_[first];
+  const Node &b = nodes_[second];
+  return a.code == b.code &&
+         (a.value == b.value || (std::isnan(a.value) && std::isnan(b.value))) &&
+         IsSame(a.left, b.left) && IsSame(a.right, b.right);
+}
+
+/**
+ * @brief Свертка узла, аргументы которого уже свернуты.
+ * @param node Узел.
+ */
+void ExpressionTree::FoldNode(Node &node) {
+  if (node.left < 0) {
+    return;
+  }
+  bool is_binary = node.right >= 0;
+  if (IsConstant(node.left) && (!is_binary || IsConstant(node.right))) {
+    double right = is_binary ? nodes_[node.right].value : 0;
+    node.value =
+        CompiledExpression::Apply(node.code, nodes_[node.left].value, right);
+    node.code = CompiledExpression::op_number;
+    node.left = node.right = -1;
+  } else if (node.code == CompiledExpression::op_minus &&
+             IsZero(node.right) && !std::signbit(nodes_[node.right].value)) {
+    node = nodes_[node.left];
+  }
+}
+
+/**
+ * @brief Удаление нулей, которые парсер подставляет перед унарными знаками:
+ * "0 + a" заменяется на "a", "0 - a" - на отрицание "a".
+ * @param node Узел, аргументы которого уже обработаны.
+ * @details Замена меняет знак нулевого результата (0 + -0 равно +0, а
+ * -(+0) равно -0), поэтому используется только при дифференцировании, где
+ * выражение и так упрощается символьно, а не при компиляции.
+ */
+void ExpressionTree::DropSignPadding(Node &node) {
+  if (node.code == CompiledExpression::op_plus && IsZero(node.left)) {
+    node = nodes_[node.right];
+  } else if (node.code == CompiledExpression::op_minus && IsZero(node.left)) {
+    node.code = CompiledExpression::op_neg;
+    node.left = node.right;
+    node.right = -1;
+  }
+}
+
+/**
+ * @brief Добавление узла в конец массива.
+ * @param node Узел, дети которого уже в массиве.
+ * @return Индекс нового узла.
+ */
+int ExpressionTree::AddNode(const Node &node) {
+  nodes_.push_back(node);
+  return static_cast<int>(nodes_.size()) - 1;
+}
+
+/**
+ * @brief Добавление константы при построении производной.
+ * @param number Число.
+ * @return Индекс узла.
+ */
+int ExpressionTree::MakeNumber(double number) {
+  return AddNode({CompiledExpression::op_number, number});
+}
+
+/**
+ * @brief Добавление функции или унарного минуса с упрощением.
+ * @param code Код операции.
+ * @param argument Индекс аргумента.
+ * @return Индекс узла (нового или уже существующего).
+ */
+int ExpressionTree::MakeUnary(OpCode code, int argument) {
+  if (IsConstant(argument)) {
+    return MakeNumber(
+        CompiledExpression::Apply(code, nodes_[argument].value, 0));
+  }
+  if (code == CompiledExpression::op_neg &&
+      nodes_[argument].code == CompiledExpression::op_neg) {
+    return nodes_[argument].left;
+  }
+  Node node = {code, 0};
+  node.left = argument;
+  return AddNode(node);
+}
+
+/**
+ * @brief Добавление бинарного оператора с упрощением.
+ * @param code Код операции.
+ * @param left Индекс левого аргумента.
+ * @param right Индекс правого аргумента.
+ * @return Индекс узла (нового или уже существующего).
+ * @details Убираются сложение с нулем, умножение на ноль и единицу, деление
+ * на единицу, степени 0 и 1, a - a и a / a; константы сворачиваются, минусы
+ * выносятся из произведений, a * (1 / b) записывается как a / b, степень
+ * степени с целыми показателями - одной степенью, а константный множитель
+ * ставится первым и сливается с константным множителем второго аргумента.
+ * Упрощения символьные (0 + a меняет знак -0, 0 * a теряет NaN от
+ * бесконечностей), поэтому используются только для производных.
+ */
+int ExpressionTree::MakeBinary(OpCode code, int left, int right) {
+  using Op = CompiledExpression;
+  if (IsConstant(left) && IsConstant(right)) {
+    return MakeNumber(
+        Op::Apply(code, nodes_[left].value, nodes_[right].value));
+  }
+  switch (code) {
+    case Op::op_plus:
+      if (IsZero(left)) return right;
+      if (IsZero(right)) return left;
+      if (nodes_[right].code == Op::op_neg) {
+        return MakeBinary(Op::op_minus, left, nodes_[right].left);
+      }
+      break;
+    case Op::op_minus:
+      if (IsZero(right)) return left;
+      if (IsZero(left)) return MakeUnary(Op::op_neg, right);
+      if (IsSame(left, right)) return MakeNumber(0);
+      if (nodes_[right].code == Op::op_neg) {
+        return MakeBinary(Op::op_plus, left, nodes_[right].left);
+      }
+      break;
+    case Op::op_mult:
+      if (IsZero(left) || IsZero(right)) return MakeNumber(0);
+      if (IsOne(left)) return right;
+      if (IsOne(right)) return left;
+      if (IsConstant(right)) std::swap(left, right);
+      if (IsConstant(left) && nodes_[left].value == -1) {
+        return MakeUnary(Op::op_neg, right);
+      }
+      if (nodes_[left].code == Op::op_neg) {
+        return MakeUnary(Op::op_neg,
+                         MakeBinary(code, nodes_[left].left, right));
+      }
+      if (nodes_[right].code == Op::op_neg) {
+        return MakeUnary(Op::op_neg,
+                         MakeBinary(code, left, nodes_[right].left));
+      }
+      if (nodes_[left].code == Op::op_div && IsOne(nodes_[left].left)) {
+        return MakeBinary(Op::op_div, right, nodes_[left].right);
+      }
+      if (nodes_[right].code == Op::op_div && IsOne(nodes_[right].left)) {
+        return MakeBinary(Op::op_div, left, nodes_[right].right);
+      }
+      if (IsConstant(left) && nodes_[right].code == Op::op_mult &&
+          IsConstant(nodes_[right].left)) {
+        double factor = nodes_[left].value * nodes_[nodes_[right].left].value;
+        return MakeBinary(code, MakeNumber(factor), nodes_[right].right);
+      }
+      break;
+    case Op::op_div:
+      if (IsZero(left)) return MakeNumber(0);
+      if (IsOne(right)) return left;
+      if (IsSame(left, right)) return MakeNumber(1);
+      if (nodes_[left].code == Op::op_neg) {
+        return MakeUnary(Op::op_neg,
+                         MakeBinary(code, nodes_[left].left, right));
+      }
+      break;
+    case Op::op_pow:
+      if (IsZero(right)) return MakeNumber(1);
+      if (IsOne(right)) return left;
+      if (IsConstant(right) && nodes_[left].code == Op::op_pow &&
+          IsConstant(nodes_[left].right)) {
+        double inner = nodes_[nodes_[left].right].value;
+        double outer = nodes_[right].value;
+        if (inner == std::trunc(inner) && outer == std::trunc(outer)) {
+          return MakeBinary(code, nodes_[left].left,
+                            MakeNumber(inner * outer));
+        }
+      }
+      break;
+    default:
+      break;
+  }
+  Node node = {code, 0};
+  node.left = left;
+  node.right = right;
+  return AddNode(node);
+}
+
+/**
+ * @brief Построение производной узла по производным его детей.
+ * @param index Индекс узла.
+ * @param derivatives Индексы производных предыдущих узлов.
+ * @param slot Номер ячейки переменной дифференцирования.
+ * @return Индекс узла производной.
+ */
+int ExpressionTree::MakeDerivative(int index,
+                                   const std::pmr::vector<int> &derivatives,
+                                   int slot) {
+  using Op = CompiledExpression;
+  Node node = nodes_[index];
+  int u = node.left;
+  int v = node.right;
+  int du = u >= 0 ? derivatives[u] : -1;
+  int dv = v >= 0 ? derivatives[v] : -1;
+  auto square = [this](int argument) {
+    return MakeBinary(Op::op_pow, argument, MakeNumber(2));
+  };
+  auto one_minus_square = [&](int argument) {
+    return MakeBinary(Op::op_minus, MakeNumber(1), square(argument));
+  };
+
+  switch (node.code) {
+    case Op::op_number:
+      return MakeNumber(0);
+    case Op::op_variable:
+      return MakeNumber(static_cast<int>(node.value) == slot ? 1 : 0);
+    case Op::op_cos:
+      return MakeBinary(Op::op_mult,
+                        MakeUnary(Op::op_neg, MakeUnary(Op::op_sin, u)), du);
+    case Op::op_sin:
+      return MakeBinary(Op::op_mult, MakeUnary(Op::op_cos, u), du);
+    case Op::op_tan:
+      return MakeBinary(Op::op_div, du, square(MakeUnary(Op::op_cos, u)));
+    case Op::op_acos:
+      return MakeUnary(
+          Op::op_neg,
+          MakeBinary(Op::op_div, du,
+                     MakeUnary(Op::op_sqrt, one_minus_square(u))));
+    case Op::op_asin:
+      return MakeBinary(Op::op_div, du,
+                        MakeUnary(Op::op_sqrt, one_minus_square(u)));
+    case Op::op_atan:
+      return MakeBinary(Op::op_div, du,
+                        MakeBinary(Op::op_plus, MakeNumber(1), square(u)));
+    case Op::op_ln:
+      return MakeBinary(Op::op_div, du, u);
+    case Op::op_log:
+      return MakeBinary(
+          Op::op_div, du,
+          MakeBinary(Op::op_mult, MakeNumber(std::log(10.0)), u));
+    case Op::op_sqrt:
+      return MakeBinary(Op::op_div, du,
+                        MakeBinary(Op::op_mult, MakeNumber(2), index));
+    case Op::op_neg:
+      return MakeUnary(Op::op_neg, du);
+    case Op::op_plus:
+    case Op::op_minus:
+      return MakeBinary(node.code, du, dv);
+    case Op::op_mult:
+      return MakeBinary(Op::op_plus, MakeBinary(Op::op_mult, du, v),
+                        MakeBinary(Op::op_mult, u, dv));
+    case Op::op_div:
+      if (IsZero(dv)) {
+        return MakeBinary(Op::op_div, du, v);
+      }
+      return MakeBinary(
+          Op::op_div,
+          MakeBinary(Op::op_minus, MakeBinary(Op::op_mult, du, v),
+                     MakeBinary(Op::op_mult, u, dv)),
+          square(v));
+    case Op::op_mod: {
+      if (IsZero(dv)) {
+        return du;
+      }
+      int quotient = MakeBinary(Op::op_div,
+                                MakeBinary(Op::op_minus, u, index), v);
+      return MakeBinary(Op::op_minus, du,
+                        MakeBinary(Op::op_mult, quotient, dv));
+    }
+    case Op::op_pow: {
+      if (IsZero(dv)) {
+        int exponent = MakeBinary(Op::op_minus, v, MakeNumber(1));
+        return MakeBinary(
+            Op::op_mult,
+            MakeBinary(Op::op_mult, v, MakeBinary(Op::op_pow, u, exponent)),
+            du);
+      }
+      int logarithm =
+          MakeBinary(Op::op_mult, dv, MakeUnary(Op::op_ln, u));
+      if (!IsZero(du)) {
+        logarithm = MakeBinary(
+            Op::op_plus, logarithm,
+            MakeBinary(Op::op_div, MakeBinary(Op::op_mult, v, du), u));
+      }
+      return MakeBinary(Op::op_mult, index, logarithm);
+    }
+    default:
+      return MakeNumber(std::numeric_limits<double>::quiet_NaN());
+  }
+}
+
+/**
+ * @brief Запись узла в строку.
+ * @param index Индекс узла.
+ * @param priority Наименьший приоритет, при котором узел записывается без
+ * скобок.
+ * @param names Имена переменных по номерам ячеек.
+ * @param result Строка, к которой дописывается запись.
+ * @details Унарный минус и отрицательные числа берутся в скобки везде, кроме
+ * начала выражения: парсер разрешает унарный знак только там. Бесконечности
+ * и NaN записываются делением на ноль.
+ */
+void ExpressionTree::WriteNode(int index, int priority,
+                               const std::string_view *names,
+                               std::string &result) const {
+  const Node &node = nodes_[index];
+  if (node.code == CompiledExpression::op_number) {
+    if (std::isnan(node.value)) {
+      result += "(0/0)";
+    } else if (std::isinf(node.value)) {
+      result += node.value > 0 ? "(1/0)" : "(-1/0)";
+    } else {
+      bool negative = std::signbit(node.value);
+      if (negative && priority > 0) result += '(';
+      char buffer[32];
+      result.append(
+          buffer,
+          std::to_chars(buffer, buffer + sizeof(buffer), node.value).ptr);
+      if (negative && priority > 0) result += ')';
+    }
+  } else if (node.code == CompiledExpression::op_variable) {
+    for (char symbol : names[static_cast<int>(node.value)]) {
+      result += ToLower(symbol);
+    }
+  } else if (node.code == CompiledExpression::op_neg) {
+    if (priority > 0) result += '(';
+    result += '-';
+    WriteNode(node.left, GetPriority(CompiledExpression::op_mult), names,
+              result);
+    if (priority > 0) result += ')';
+  } else if (node.right < 0) {
+    result += GetOperationName(node.code);
+    result += '(';
+    WriteNode(node.left, 0, names, result);
+    result += ')';
+  } else {
+    int own_priority = GetPriority(node.code);
+    if (own_priority < priority) result += '(';
+    WriteNode(node.left, own_priority, names, result);
+    result += GetOperationName(node.code);
+    WriteNode(node.right, own_priority + 1, names, result);
+    if (own_priority < priority) result += ')';
+  }
+}
+
+/**
+ * @brief Перевод многочленов от одной переменной в схему Горнера.
+ * @details Многочленом считается сумма одночленов вида c * x^k, где x - одна
+ * и та же переменная. Скобки вида
+ * (x + 1)^3 не раскрываются, чтобы не терять точность на взаимном
+ * уничтожении слагаемых. Заменяются только самые верхние такие поддеревья
+ * степени от двух и хотя бы с двумя слагаемыми.
+ */
+void ExpressionTree::LowerPolynomials() {
+  std::pmr::vector<Polynomial> polynomials(resource_);
+  polynomials.reserve(nodes_.size());
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    Polynomial &result = polynomials.emplace_back(resource_);
+    if (!MakePolynomial(nodes_[i], polynomials, result)) {
+      result.coefficients.clear();
+      result.terms = 0;
+      result.variable_node = -1;
+    }
+  }
+
+  std::pmr::vector<bool> reachable(nodes_.size(), false, resource_);
+  reachable.back() = true;
+  for (size_t i = nodes_.size(); i-- > 0;) {
+    if (!reachable[i]) {
+      continue;
+    }
+    const Polynomial &polynomial = polynomials[i];
+    if (polynomial.terms >= 2 && polynomial.coefficients.size() >= 3) {
+      nodes_[i].code = CompiledExpression::op_horner;
+      nodes_[i].value = static_cast<double>(polynomials_.size());
+      nodes_[i].left = polynomial.variable_node;
+      nodes_[i].right = -1;
+      polynomials_.emplace_back(polynomial.coefficients.rbegin(),
+                                polynomial.coefficients.rend());
+    }
+    if (nodes_[i].left >= 0) reachable[nodes_[i].left] = true;
+    if (nodes_[i].right >= 0) reachable[nodes_[i].right] = true;
+  }
+}
+
+/**
+ * @brief Разложение узла в многочлен от одной переменной по уже разложенным
+ * детям.
+ * @param node Узел.
+ * @param polynomials Многочлены для предыдущих узлов (пустые, если узел не
+ * многочлен).
+ * @param result Сюда записывается многочлен.
+ * @return true - если узел является суммой одночленов от одной переменной.
+ */
+bool ExpressionTree::MakePolynomial(
+    const Node &node, const std::pmr::vector<Polynomial> &polynomials,
+    Polynomial &result) const {
+  const Polynomial empty;
+  const Polynomial &left = node.left >= 0 ? polynomials[node.left] : empty;
+  const Polynomial &right = node.right >= 0 ? polynomials[node.right] : empty;
+  bool left_ok = !left.coefficients.empty();
+  bool right_ok = !right.coefficients.empty();
+  if (left.variable_node >= 0 && right.variable_node >= 0 &&
+      nodes_[left.variable_node].value != nodes_[right.variable_node].value) {
+    return false;
+  }
+  result.variable_node =
+      left.variable_node >= 0 ? left.variable_node : right.variable_node;
+
+  switch (node.code) {
+    case CompiledExpression::op_number:
+      result.coefficients = {node.value};
+      result.terms = 1;
+      return true;
+    case CompiledExpression::op_variable:
+      result.coefficients = {0, 1};
+      result.terms = 1;
+      result.variable_node = static_cast<int>(&node - nodes_.data());
+      return true;
+    case CompiledExpression::op_neg:
+      if (!left_ok) return false;
+      result.coefficients = left.coefficients;
+      for (double &coefficient : result.coefficients) {
+        coefficient = 0.0 - coefficient;
+      }
+      result.terms = left.terms;
+      return true;
+    case CompiledExpression::op_plus:
+    case CompiledExpression::op_minus: {
+      if (!left_ok || !right_ok) return false;
+      double sign = node.code == CompiledExpression::op_plus ? 1 : -1;
+      result.coefficients = left.coefficients;
+      result.coefficients.resize(
+          std::max(left.coefficients.size(), right.coefficients.size()), 0);
+      for (size_t k = 0; k < right.coefficients.size(); ++k) {
+        result.coefficients[k] += sign * right.coefficients[k];
+      }
+      result.terms = left.terms + right.terms;
+      return true;
+    }
+    case CompiledExpression::op_mult: {
+      if (!left_ok || !right_ok || (left.terms != 1 && right.terms != 1) ||
+          left.coefficients.size() + right.coefficients.size() >
+              kMaxDegree + 2) {
+        return false;
+      }
+      result.coefficients.assign(
+          left.coefficients.size() + right.coefficients.size() - 1, 0);
+      for (size_t i = 0; i < left.coefficients.size(); ++i) {
+        for (size_t j = 0; j < right.coefficients.size(); ++j) {
+          result.coefficients[i + j] +=
+              left.coefficients[i] * right.coefficients[j];
+        }
+      }
+      result.terms = left.terms * right.terms;
+      return true;
+    }
+    case CompiledExpression::op_pow: {
+      if (!left_ok || left.terms != 1 || !IsConstant(node.right)) {
+        return false;
+      }
+      double exponent = nodes_[node.right].value;
+      if (exponent < 1 || exponent > kMaxDegree ||
+          exponent != std::floor(exponent)) {
+        return false;
+      }
+      size_t degree =
+          (left.coefficients.size() - 1) * static_cast<size_t>(exponent);
+      if (degree > kMaxDegree) {
+        return false;
+      }
+      result.coefficients.assign(degree + 1, 0);
+      result.coefficients[degree] = pow(left.coefficients.back(), exponent);
+      result.terms = 1;
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+/**
+ * @brief Понижение стоимости операции, аргументы которой уже обработаны.
+ * @param node Узел.
+ * @param uses Количество достижимых родителей у каждого узла.
+ * @details a^n для целых и полуцелых n заменяется на op_powi, a / 2^k - на
+ * a * 2^-k (результат совпадает побитово, так как обратная величина точная).
+ * Делитель меняется на месте, только если у него нет других родителей,
+ * иначе деление остается.
+ */
+void ExpressionTree::ReduceStrength(Node &node,
+                                    const std::pmr::vector<int> &uses) {
+  if (node.code == CompiledExpression::op_pow && IsConstant(node.right)) {
+    double exponent = nodes_[node.right].value;
+    if (exponent * 2 == std::floor(exponent * 2) &&
+        std::fabs(exponent) <= kMaxExponent) {
+      if (exponent == 1) {
+        node = nodes_[node.left];
+      } else {
+        node.code = CompiledExpression::op_powi;
+        node.value = exponent;
+        node.right = -1;
+      }
+    }
+  } else if (node.code == CompiledExpression::op_div &&
+             IsConstant(node.right) && uses[node.right] == 1) {
+    int power = 0;
+    double divisor = nodes_[node.right].value;
+    double inverse = 1 / divisor;
+    if (std::isnormal(divisor) &&
+        std::fabs(std::frexp(divisor, &power)) == 0.5 &&
+        std::isnormal(inverse)) {
+      node.code = CompiledExpression::op_mult;
+      nodes_[node.right].value = inverse;
+    }
+  }
+}
+
+/**
+ * @brief Отметка узлов, до которых можно дойти от корня.
+ */
+std::pmr::vector<bool> ExpressionTree::MarkReachable() const {
+  std::pmr::vector<bool> reachable(nodes_.size(), false, resource_);
+  reachable.back() = true;
+  for (size_t i = nodes_.size(); i-- > 0;) {
+    if (reachable[i]) {
+      if (nodes_[i].left >= 0) reachable[nodes_[i].left] = true;
+      if (nodes_[i].right >= 0) reachable[nodes_[i].right] = true;
+    }
+  }
+  return reachable;
+}
+
+/**
+ * @brief Склейка одинаковых поддеревьев (hash consing).
+ * @details Узлы просматриваются от детей к родителям, каждому узлу
+ * сопоставляется первый ранее встреченный узел с той же операцией, тем же
+ * значением и теми же (уже склеенными) детьми. У сложения и умножения дети
+ * упорядочиваются, так как a + b и b + a в IEEE 754 дают один и тот же
+ * результат. Недостижимые от корня узлы при этом отбрасываются, а новый
+ * корень остается последним узлом.
+ */
+void ExpressionTree::ShareSubexpressions() {
+  std::pmr::vector<bool> reachable = MarkReachable();
+  std::pmr::vector<int> canonical(nodes_.size(), -1, resource_);
+  std::pmr::unordered_map<NodeKey, int, NodeKeyHash> known_nodes(
+      nodes_.size(), NodeKeyHash(), std::equal_to<NodeKey>(), resource_);
+  std::pmr::vector<Node> shared_nodes(resource_);
+  shared_nodes.reserve(nodes_.size());
+
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    if (!reachable[i]) {
+      continue;
+    }
+    Node node = nodes_[i];
+    if (node.left >= 0) node.left = canonical[node.left];
+    if (node.right >= 0) node.right = canonical[node.right];
+    if ((node.code == CompiledExpression::op_plus ||
+         node.code == CompiledExpression::op_mult) &&
+        node.left > node.right) {
+      std::swap(node.left, node.right);
+    }
+    uint64_t value_bits;
+    std::memcpy(&value_bits, &node.value, sizeof(value_bits));
+    NodeKey key(node.code, value_bits, node.left, node.right);
+    auto [iter, inserted] =
+        known_nodes.emplace(key, static_cast<int>(shared_nodes.size()));
+    if (inserted) {
+      shared_nodes.push_back(node);
+    }
+    canonical[i] = iter->second;
+  }
+  nodes_.swap(shared_nodes);
+}
+
+}  // namespace s21
@@ -0,0 +1,144 @@
+#ifndef SMARTCALC_MODEL_EXPRESSION_TREE_H_
+#define SMARTCALC_MODEL_EXPRESSION_TREE_H_
+
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "compiled_expression.h"
+
+namespace s21 {
+
+/**
+ * @brief Класс для дерева выражения, над которым выполняются оптимизации
+ * перед записью в байт-код.
+ * @details Узлы добавляются в порядке обратной польской записи, поэтому
+ * индексы детей всегда меньше индекса родителя, а корнем является последний
+ * узел. Это позволяет обходить дерево простыми циклами без рекурсии.
+ *
+ * Последний проход оптимизации превращает дерево в граф без повторов
+ * (hash consing): одинаковые поддеревья склеиваются в один узел, который
+ * вычисляется один раз, а его результат хранится в ячейке.
+ *
+ * Differentiate заменяет дерево его производной по переменной, упрощая
+ * узлы по мере построения, а ToString записывает дерево обратно в строку,
+ * которую можно скомпилировать как обычное выражение.
+ *
+ * Вся память дерева, включая временные массивы проходов, берется из
+ * переданного memory_resource (обычно арены вычислителя).
+ */
+class ExpressionTree {
+ public:
+  using OpCode = CompiledExpression::OpCode;
+
+  explicit ExpressionTree(
+      std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+  ~ExpressionTree() = default;
+
+  void PushNumber(double number);
+
+  void PushVariable(int slot);
+
+  void PushOperation(OpCode code);
+
+  void Optimize();
+
+  void Emit(CompiledExpression &expression) const;
+
+  void Differentiate(int slot);
+
+  std::string ToString(const std::string_view *names) const;
+
+  void Clear();
+
+ private:
+  /**
+   * @brief Узел дерева.
+   */
+  struct Node {
+    OpCode code;     ///< Код операции.
+    double value;    ///< Значение (для констант и показателя op_powi), номер
+                     ///< ячейки (для op_variable) или индекс коэффициентов
+                     ///< в polynomials_ (для op_horner).
+    int left = -1;   ///< Индекс левого (или единственного) аргумента.
+    int right = -1;  ///< Индекс правого аргумента.
+  };
+
+  /**
+   * @brief Многочлен от одной переменной, в который раскладывается поддерево.
+   */
+  struct Polynomial {
+    Polynomial() = default;
+
+    explicit Polynomial(std::pmr::memory_resource *resource)
+        : coefficients(resource) {}
+
+    std::pmr::vector<double> coefficients;  ///< Коэффициенты от свободного
+                                            ///< члена.
+    int terms = 0;                          ///< Количество слагаемых в записи.
+    int variable_node = -1;                 ///< Индекс узла переменной в
+                                            ///< поддереве.
+  };
+
+  static constexpr int kMaxDegree = 32;  ///< Максимальная степень многочлена
+                                         ///< для схемы Горнера.
+
+  static constexpr double kMaxExponent = 64;  ///< Максимальный показатель
+                                              ///< степени для op_powi.
+
+  bool IsConstant(int index) const;
+
+  bool IsZero(int index) const;
+
+  bool IsOne(int index) const;
+
+  bool IsSame(int first, int second) const;
+
+  void FoldNode(Node &node);
+
+  void DropSignPadding(Node &node);
+
+  int AddNode(const Node &node);
+
+  int MakeNumber(double number);
+
+  int MakeUnary(OpCode code, int argument);
+
+  int MakeBinary(OpCode code, int left, int right);
+
+  int MakeDerivative(int index, const std::pmr::vector<int> &derivatives,
+                     int slot);
+
+  void WriteNode(int index, int priority, const std::string_view *names,
+                 std::string &result) const;
+
+  void LowerPolynomials();
+
+  bool MakePolynomial(const Node &node,
+                      const std::pmr::vector<Polynomial> &polynomials,
+                      Polynomial &result) const;
+
+  void ReduceStrength(Node &node, const std::pmr::vector<int> &uses);
+
+  std::pmr::vector<bool> MarkReachable() const;
+
+  void ShareSubexpressions();
+
+  std::pmr::memory_resource *resource_;  ///< Источник памяти.
+
+  std::pmr::vector<Node> nodes_;  ///< Узлы в порядке обратной польской
+                                  ///< записи.
+
+  std::pmr::vector<std::pmr::vector<double>>
+      polynomials_;  ///< Коэффициенты многочленов (от старшего) для узлов
+                     ///< op_horner.
+
+  std::pmr::vector<int> stack_;  ///< Стэк индексов узлов при построении
+                                 ///< дерева.
+};
+
+}  // namespace s21
+
+#endif  // SMARTCALC_MODEL_EXPRESSION_TREE_H_
@@ -0,0 +1,267 @@
+#include "integrator.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace s21 {
+
+namespace {
+
+constexpr size_t kKronrodPoints = 15;  ///< Количество узлов правила G7K15.
+
+/**
+ * @brief Узлы правила Кронрода на [-1, 1] (неотрицательные, по убыванию).
+ * Узлы с нечетными индексами - узлы правила Гаусса из семи точек.
+ */
+constexpr double kNodes[8] = {
+    0.991455371120812639206854697526329, 0.949107912342758524526189684047851,
+    0.864864423359769072789712788640926, 0.741531185599394439863864773280788,
+    0.586087235467691130294144845693013, 0.405845151377397166906606412076961,
+    0.207784955007898467600689403773245, 0.000000000000000000000000000000000};
+
+/**
+ * @brief Веса правила Кронрода для узлов kNodes.
+ */
+constexpr double kKronrodWeights[8] = {
+    0.022935322010529224963732008058970, 0.063092092629978553290700663189204,
+    0.104790010322250183839876322541518, 0.140653259715525918745189590510238,
+    0.169004726639267902826583426598550, 0.190350578064785409913256402421014,
+    0.204432940075298892414161999234649, 0.209482141084727828012999174891714};
+
+/**
+ * @brief Веса правила Гаусса для узлов kNodes[1], kNodes[3], kNodes[5] и
+ * kNodes[7].
+ */
+constexpr double kGaussWeights[4] = {
+    0.129484966168869693270611432679082, 0.279705391489276667901467771423780,
+    0.381830050505118944950369775488975, 0.417959183673469387755102040816327};
+
+constexpr size_t kRoundSegments = 64;  ///< Наибольшее количество отрезков,
+                                       ///< которые делятся за один раунд.
+
+constexpr size_t kSegmentsGrain = 4;  ///< Количество отрезков, вычисляемых
+                                      ///< одной задачей пула.
+
+/**
+ * @brief Отрезок разбиения с оценкой интеграла и ошибки на нем.
+ */
+struct Segment {
+  double a, b;    ///< Концы отрезка.
+  double value;   ///< Оценка интеграла правилом Кронрода.
+  double error;   ///< Оценка ошибки.
+  bool splittable;  ///< Отрезок еще можно делить (он шире погрешности
+                    ///< округления в его середине).
+
+  bool operator<(const Segment &other) const { return error < other.error; }
+};
+
+/**
+ * @brief Вычисление интеграла по отрезку правилом Гаусса-Кронрода G7K15.
+ * @param expression Подынтегральная функция.
+ * @param segment Отрезок, заполняются value, error и splittable.
+ * @details Функция вычисляется пакетно во всех пятнадцати узлах. Ошибка
+ * оценивается по разности правил Кронрода и Гаусса с масштабированием, как
+ * в QUADPACK (QK15): для гладких функций оценка близка к реальной ошибке
+ * правила Кронрода, а не Гаусса. Неопределенная ошибка (функция не конечна
+ * в узлах) считается бесконечной, чтобы отрезок делился первым.
+ */
+void EvaluateSegment(const CompiledExpression &expression, Segment &segment) {
+  const double center = segment.a + (segment.b - segment.a) / 2;
+  const double half = (segment.b - segment.a) / 2;
+  double x[kKronrodPoints];
+  double f[kKronrodPoints];
+  for (size_t k = 0; k < 7; ++k) {
+    x[2 * k] = center - half * kNodes[k];
+    x[2 * k + 1] = center + half * kNodes[k];
+  }
+  x[14] = center;
+  expression.Evaluate(x, f, kKronrodPoints);
+
+  double kronrod = f[14] * kKronrodWeights[7];
+  double gauss = f[14] * kGaussWeights[3];
+  double absolute = std::fabs(kronrod);
+  for (size_t k = 0; k < 7; ++k) {
+    double sum = f[2 * k] + f[2 * k + 1];
+    kronrod += kKronrodWeights[k] * sum;
+    absolute += kKronrodWeights[k] * (std::fabs(f[2 * k]) +
+                                      std::fabs(f[2 * k + 1]));
+    if (k % 2 == 1) {
+      gauss += kGaussWeights[k / 2] * sum;
+    }
+  }
+  double mean = kronrod / 2;
+  double deviation = kKronrodWeights[7] * std::fabs(f[14] - mean);
+  for (size_t k = 0; k < 7; ++k) {
+    deviation += kKronrodWeights[k] *
+                 (std::fabs(f[2 * k] - mean) + std::fabs(f[2 * k + 1] - mean));
+  }
+
+  double error = std::fabs((kronrod - gauss) * half);
+  deviation *= std::fabs(half);
+  absolute *= std::fabs(half);
+  if (deviation != 0 && error != 0) {
+    error = deviation * std::min(1.0, std::pow(200 * error / deviation, 1.5));
+  }
+  if (absolute > DBL_MIN / (50 * DBL_EPSILON)) {
+    error = std::max(50 * DBL_EPSILON * absolute, error);
+  }
+  segment.value = kronrod * half;
+  segment.error = std::isfinite(segment.value) && std::isfinite(error)
+                      ? error
+                      : std::numeric_limits<double>::infinity();
+  segment.splittable =
+      std::fabs(half) > 100 * DBL_EPSILON * std::fabs(center) &&
+      std::fabs(half) > 100 * DBL_MIN;
+}
+
+/**
+ * @brief Точная пересборка сумм значений и ошибок по всем отрезкам.
+ * @details Текущие суммы обновляются разностями и накапливают погрешность
+ * округления, а бесконечная ошибка отрезка делает разность неопределенной.
+ */
+void SumSegments(const std::vector<Segment> &heap,
+                 const std::vector<Segment> &finished, double &value,
+                 double &error) {
+  value = 0;
+  error = 0;
+  for (const std::vector<Segment> *segments : {&heap, &finished}) {
+    for (const Segment &segment : *segments) {
+      value += segment.value;
+      error += segment.error;
+    }
+  }
+}
+
+}  // namespace
+
+/**
+ * @brief Адаптивное вычисление определенного интеграла.
+ * @param expression Подынтегральная функция от одной переменной.
+ * @param a Нижний предел.
+ * @param b Верхний предел (может быть меньше нижнего).
+ * @param settings Допустимая ошибка и бюджет отрезков.
+ * @param pool Пул потоков.
+ * @return Значение, оценка ошибки и количество вычислений функции.
+ * @details Глобальная адаптивная схема: отрезки хранятся в куче по оценке
+ * ошибки, и за раунд до kRoundSegments отрезков с наибольшей ошибкой
+ * делятся пополам. Отрезки, которые уже нельзя делить из-за точности
+ * double, откладываются, но их вклад остается в сумме. Половинки
+ * вычисляются правилом G7K15 задачами пула, так что ошибка уменьшается там,
+ * где она больше всего, а все ядра заняты.
+ * Счет останавливается, когда суммарная ошибка не больше допустимой, когда
+ * кончается бюджет отрезков или когда делить больше нечего.
+ *
+ * Особенности на концах (sqrt(x) у нуля) сходятся геометрически: узлы
+ * правила не попадают на концы, и каждое деление уменьшает вклад крайнего
+ * отрезка. На бесконечно осциллирующих функциях (sin(1 / x) у нуля) работа
+ * ограничена бюджетом отрезков, а результат помечается несошедшимся.
+ */
+IntegrationResult Integrate(const CompiledExpression &expression, double a,
+                            double b, const Integration &settings,
+                            ThreadPool &pool) {
+  IntegrationResult result;
+  if (a == b) {
+    return result;
+  }
+  double sign = 1;
+  if (a > b) {
+    std::swap(a, b);
+    sign = -1;
+  }
+
+  const size_t initial_count =
+      std::max<size_t>(1, std::min(settings.max_intervals,
+                                   pool.GetThreadsCount() * kSegmentsGrain));
+  std::vector<Segment> heap(initial_count);
+  double step = (b - a) / initial_count;
+  for (size_t i = 0; i < initial_count; ++i) {
+    heap[i].a = a + step * i;
+    heap[i].b = i + 1 == initial_count ? b : a + step * (i + 1);
+  }
+  pool.ParallelFor(initial_count, kSegmentsGrain,
+                   [&](size_t begin, size_t end) {
+                     for (size_t i = begin; i < end; ++i) {
+                       EvaluateSegment(expression, heap[i]);
+                     }
+                   });
+  result.evaluations = initial_count * kKronrodPoints;
+
+  double value = 0;
+  double error = 0;
+  SumSegments(heap, {}, value, error);
+  std::make_heap(heap.begin(), heap.end());
+
+  std::vector<Segment> finished;
+  std::vector<Segment> parents;
+  std::vector<Segment> children;
+  while (true) {
+    double tolerance = std::max(settings.absolute_tolerance,
+                                settings.relative_tolerance * std::fabs(value));
+    if (error <= tolerance) {
+      break;
+    }
+    size_t segments_count = heap.size() + finished.size();
+    size_t round = segments_count < settings.max_intervals
+                       ? std::min(kRoundSegments,
+                                  settings.max_intervals - segments_count)
+                       : 0;
+    parents.clear();
+    double selected_error = 0;
+    while (parents.size() < round && !heap.empty() &&
+           selected_error < error - tolerance / 2) {
+      std::pop_heap(heap.begin(), heap.end());
+      if (heap.back().splittable) {
+        selected_error += heap.back().error;
+        parents.push_back(heap.back());
+      } else {
+        finished.push_back(heap.back());
+      }
+      heap.pop_back();
+    }
+    if (parents.empty()) {
+      result.converged = false;
+      break;
+    }
+
+    children.resize(parents.size() * 2);
+    for (size_t i = 0; i < parents.size(); ++i) {
+      double middle = parents[i].a + (parents[i].b - parents[i].a) / 2;
+      children[2 * i].a = parents[i].a;
+      children[2 * i].b = middle;
+      children[2 * i + 1].a = middle;
+      children[2 * i + 1].b = parents[i].b;
+    }
+    pool.ParallelFor(children.size(), kSegmentsGrain,
+                     [&](size_t begin, size_t end) {
+                       for (size_t i = begin; i < end; ++i) {
+                         EvaluateSegment(expression, children[i]);
+                       }
+                     });
+    result.evaluations += children.size() * kKronrodPoints;
+
+    for (const Segment &parent : parents) {
+      value -= parent.value;
+      error -= parent.error;
+    }
+    for (const Segment &child : children) {
+      value += child.value;
+      error += child.error;
+      heap.push_back(child);
+      std::push_heap(heap.begin(), heap.end());
+    }
+    if (!std::isfinite(value) || !std::isfinite(error)) {
+      SumSegments(heap, finished, value, error);
+    }
+  }
+
+  SumSegments(heap, finished, value, error);
+  result.value = sign * value;
+  result.error = error;
+  result.intervals = heap.size() + finished.size();
+  return result;
+}
+
+}  // namespace s21
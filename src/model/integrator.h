@@ -0,0 +1,41 @@
+#ifndef SMARTCALC_MODEL_INTEGRATOR_H_
+#define SMARTCALC_MODEL_INTEGRATOR_H_
+
+#include <cstddef>
+
+#include "compiled_expression.h"
+#include "thread_pool.h"
+
+namespace s21 {
+
+/**
+ * @brief Параметры адаптивного численного интегрирования.
+ */
+struct Integration {
+  double absolute_tolerance = 1e-10;  ///< Допустимая абсолютная ошибка.
+
+  double relative_tolerance = 1e-10;  ///< Допустимая относительная ошибка.
+
+  size_t max_intervals = 100000;  ///< Максимальное количество отрезков
+                                  ///< разбиения.
+};
+
+/**
+ * @brief Результат численного интегрирования.
+ */
+struct IntegrationResult {
+  double value = 0;         ///< Значение интеграла.
+  double error = 0;         ///< Оценка абсолютной ошибки.
+  size_t evaluations = 0;   ///< Количество вычислений подынтегральной
+                            ///< функции.
+  size_t intervals = 0;     ///< Количество отрезков итогового разбиения.
+  bool converged = true;    ///< Достигнута ли допустимая ошибка.
+};
+
+IntegrationResult Integrate(const CompiledExpression &expression, double a,
+                            double b, const Integration &settings,
+                            ThreadPool &pool);
+
+}  // namespace s21
+
+#endif  // SMARTCALC_MODEL_INTEGRATOR_H_
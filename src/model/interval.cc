@@ -0,0 +1,384 @@
+#include "interval.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include "operations.h"
+
+namespace s21 {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;  ///< Число пи.
+
+constexpr double kRoundingError = 4 * DBL_EPSILON;  ///< Относительная
+                                                    ///< погрешность, на
+                                                    ///< которую расширяются
+                                                    ///< границы результата.
+
+constexpr double kInfinity = std::numeric_limits<double>::infinity();
+
+/**
+ * @brief Отрезок с границами, расширенными наружу на погрешность округления.
+ * @param low Вычисленная нижняя граница.
+ * @param high Вычисленная верхняя граница.
+ * @param continuous Флаг непрерывности результата.
+ * @details Погрешность арифметики IEEE 754 - половина ULP, функций libm и
+ * PowerByParts - несколько ULP, поэтому относительного запаса в четыре
+ * эпсилона и еще одного шага до соседнего числа хватает с избытком.
+ * Неопределенная граница (NaN) заменяется бесконечностью.
+ */
+Interval Outward(double low, double high, bool continuous) {
+  if (std::isnan(low)) {
+    low = -kInfinity;
+  } else if (std::isfinite(low)) {
+    low = std::nextafter(low - std::fabs(low) * kRoundingError, -kInfinity);
+  }
+  if (std::isnan(high)) {
+    high = kInfinity;
+  } else if (std::isfinite(high)) {
+    high = std::nextafter(high + std::fabs(high) * kRoundingError, kInfinity);
+  }
+  return {low, high, continuous};
+}
+
+/**
+ * @brief Отрезок, натянутый на значения в углах области аргументов.
+ * @param values Значения (неопределенные значения пропускаются).
+ * @param continuous Флаг непрерывности результата.
+ */
+Interval FromCorners(const double (&values)[4], bool continuous) {
+  double low = kInfinity;
+  double high = -kInfinity;
+  for (double value : values) {
+    if (!std::isnan(value)) {
+      low = std::min(low, value);
+      high = std::max(high, value);
+    }
+  }
+  if (low > high) {
+    return Interval::Entire();
+  }
+  return Outward(low, high, continuous);
+}
+
+/**
+ * @brief Произведение, в котором ноль на бесконечность дает ноль.
+ */
+double Product(double a, double b) { return a == 0 || b == 0 ? 0 : a * b; }
+
+/**
+ * @brief Проверка, что на отрезке есть точка phase + 2 * pi * k.
+ */
+bool ContainsPhase(const Interval &a, double phase) {
+  double k = std::ceil((a.low - phase) / (2 * kPi));
+  return phase + 2 * kPi * k <= a.high;
+}
+
+/**
+ * @brief Синус или косинус отрезка.
+ * @param a Аргумент.
+ * @param function Функция (sin или cos).
+ * @param peak Аргумент, в котором функция достигает единицы (минус единица
+ * достигается через пи от него).
+ */
+template <typename Function>
+Interval Periodic(const Interval &a, Function function, double peak) {
+  if (a.IsEmpty()) {
+    return Interval::Empty();
+  }
+  if (!std::isfinite(a.low) || !std::isfinite(a.high) ||
+      a.high - a.low >= 2 * kPi) {
+    return {-1, 1, a.continuous};
+  }
+  double first = function(a.low);
+  double second = function(a.high);
+  double low = ContainsPhase(a, peak + kPi) ? -1 : std::min(first, second);
+  double high = ContainsPhase(a, peak) ? 1 : std::max(first, second);
+  Interval result = Outward(low, high, a.continuous);
+  result.low = std::max(result.low, -1.0);
+  result.high = std::min(result.high, 1.0);
+  return result;
+}
+
+/**
+ * @brief Логарифм отрезка.
+ * @param a Аргумент.
+ * @param function Функция (log или log10).
+ */
+template <typename Function>
+Interval Logarithm(const Interval &a, Function function) {
+  if (a.IsEmpty() || a.high <= 0) {
+    return Interval::Empty();
+  }
+  double low = a.low > 0 ? function(a.low) : -kInfinity;
+  return Outward(low, function(a.high), a.continuous && a.low > 0);
+}
+
+/**
+ * @brief Возведение отрезка в целую степень.
+ * @param a Основание.
+ * @param exponent Целый показатель.
+ * @param power Функция возведения числа в эту степень.
+ * @details Вне нуля степень монотонна на отрезке, поэтому экстремумы - на
+ * концах. Для четной степени отрезка с нулем минимум - ноль, для
+ * отрицательной - на нуле полюс.
+ */
+template <typename Function>
+Interval IntegerPower(const Interval &a, double exponent, Function power) {
+  if (exponent < 0 && a.Contains(0)) {
+    return Interval::Entire();
+  }
+  double first = power(a.low);
+  double second = power(a.high);
+  double low = std::min(first, second);
+  double high = std::max(first, second);
+  if (exponent > 0 && std::fmod(exponent, 2) == 0 && a.Contains(0)) {
+    low = 0;
+  }
+  return Outward(low, high, a.continuous);
+}
+
+}  // namespace
+
+/**
+ * @brief Наименьший отрезок, содержащий оба отрезка.
+ */
+Interval Hull(const Interval &a, const Interval &b) {
+  if (a.IsEmpty()) {
+    return b;
+  }
+  if (b.IsEmpty()) {
+    return a;
+  }
+  return {std::min(a.low, b.low), std::max(a.high, b.high),
+          a.continuous && b.continuous};
+}
+
+Interval operator+(const Interval &a, const Interval &b) {
+  if (a.IsEmpty() || b.IsEmpty()) {
+    return Interval::Empty();
+  }
+  return Outward(a.low + b.low, a.high + b.high, a.continuous && b.continuous);
+}
+
+Interval operator-(const Interval &a, const Interval &b) {
+  if (a.IsEmpty() || b.IsEmpty()) {
+    return Interval::Empty();
+  }
+  return Outward(a.low - b.high, a.high - b.low, a.continuous && b.continuous);
+}
+
+Interval operator-(const Interval &a) {
+  if (a.IsEmpty()) {
+    return Interval::Empty();
+  }
+  return {-a.high, -a.low, a.continuous};
+}
+
+Interval operator*(const Interval &a, const Interval &b) {
+  if (a.IsEmpty() || b.IsEmpty()) {
+    return Interval::Empty();
+  }
+  return FromCorners(
+      {Product(a.low, b.low), Product(a.low, b.high), Product(a.high, b.low),
+       Product(a.high, b.high)},
+      a.continuous && b.continuous);
+}
+
+/**
+ * @details Деление на отрезок с нулем дает всю прямую с разрывом.
+ */
+Interval operator/(const Interval &a, const Interval &b) {
+  if (a.IsEmpty() || b.IsEmpty()) {
+    return Interval::Empty();
+  }
+  if (b.Contains(0)) {
+    return Interval::Entire();
+  }
+  return FromCorners({a.low / b.low, a.low / b.high, a.high / b.low,
+                      a.high / b.high},
+                     a.continuous && b.continuous);
+}
+
+Interval Sin(const Interval &a) {
+  return Periodic(a, [](double value) { return std::sin(value); }, kPi / 2);
+}
+
+Interval Cos(const Interval &a) {
+  return Periodic(a, [](double value) { return std::cos(value); }, 0);
+}
+
+/**
+ * @details Отрезок, на котором есть полюс, дает всю прямую с разрывом.
+ */
+Interval Tan(const Interval &a) {
+  if (a.IsEmpty()) {
+    return Interval::Empty();
+  }
+  if (!std::isfinite(a.low) || !std::isfinite(a.high) ||
+      a.high - a.low >= kPi) {
+    return Interval::Entire();
+  }
+  double branch_low = std::floor((a.low - kPi / 2) / kPi);
+  double branch_high = std::floor((a.high - kPi / 2) / kPi);
+  double low = std::tan(a.low);
+  double high = std::tan(a.high);
+  if (branch_low != branch_high || low > high) {
+    return Interval::Entire();
+  }
+  return Outward(low, high, a.continuous);
+}
+
+Interval Acos(const Interval &a) {
+  if (a.IsEmpty() || a.high < -1 || a.low > 1) {
+    return Interval::Empty();
+  }
+  return Outward(std::acos(std::min(a.high, 1.0)),
+                 std::acos(std::max(a.low, -1.0)),
+                 a.continuous && a.low >= -1 && a.high <= 1);
+}
+
+Interval Asin(const Interval &a) {
+  if (a.IsEmpty() || a.high < -1 || a.low > 1) {
+    return Interval::Empty();
+  }
+  return Outward(std::asin(std::max(a.low, -1.0)),
+                 std::asin(std::min(a.high, 1.0)),
+                 a.continuous && a.low >= -1 && a.high <= 1);
+}
+
+Interval Atan(const Interval &a) {
+  if (a.IsEmpty()) {
+    return Interval::Empty();
+  }
+  return Outward(std::atan(a.low), std::atan(a.high), a.continuous);
+}
+
+Interval Ln(const Interval &a) {
+  return Logarithm(a, [](double value) { return std::log(value); });
+}
+
+Interval Log(const Interval &a) {
+  return Logarithm(a, [](double value) { return std::log10(value); });
+}
+
+Interval Sqrt(const Interval &a) {
+  if (a.IsEmpty() || a.high < 0) {
+    return Interval::Empty();
+  }
+  return Outward(std::sqrt(std::max(a.low, 0.0)), std::sqrt(a.high),
+                 a.continuous && a.low >= 0);
+}
+
+/**
+ * @details Для целого показателя-точки степень определена при любом
+ * основании. Иначе отрицательные основания отбрасываются (а если показатель
+ * не точка, то их значения, определенные только в целых показателях,
+ * покрываются по модулю), а на неотрицательных основаниях степень монотонна
+ * по каждому аргументу, и экстремумы - в углах.
+ */
+Interval Pow(const Interval &base, const Interval &exponent) {
+  if (base.IsEmpty() || exponent.IsEmpty()) {
+    return Interval::Empty();
+  }
+  bool continuous = base.continuous && exponent.continuous;
+  if (exponent.low == exponent.high &&
+      exponent.low == std::trunc(exponent.low)) {
+    double power = exponent.low;
+    Interval result = IntegerPower(
+        base, power, [power](double value) { return std::pow(value, power); });
+    result.continuous = result.continuous && exponent.continuous;
+    return result;
+  }
+  if (base.high < 0 && exponent.low == exponent.high) {
+    return Interval::Empty();
+  }
+  if (base.low < 0 && exponent.low != exponent.high) {
+    Interval magnitude = {base.Contains(0) ? 0 : std::fabs(base.high),
+                          std::max(std::fabs(base.low), std::fabs(base.high)),
+                          continuous};
+    Interval result = Pow(magnitude, exponent);
+    result = Hull(result, -result);
+    result.continuous = false;
+    return result;
+  }
+  double low = std::max(base.low, 0.0);
+  continuous = continuous && base.low >= 0 && !(low == 0 && exponent.low <= 0);
+  return FromCorners({std::pow(low, exponent.low),
+                      std::pow(low, exponent.high),
+                      std::pow(base.high, exponent.low),
+                      std::pow(base.high, exponent.high)},
+                     continuous);
+}
+
+/**
+ * @details Полуцелая степень определена на неотрицательных основаниях и
+ * монотонна на них.
+ */
+Interval PowerByParts(const Interval &base, double exponent) {
+  if (base.IsEmpty()) {
+    return Interval::Empty();
+  }
+  auto power = [exponent](double value) {
+    return PowerByParts(value, exponent);
+  };
+  if (exponent == std::trunc(exponent)) {
+    return IntegerPower(base, exponent, power);
+  }
+  if (base.high < 0) {
+    return Interval::Empty();
+  }
+  double low = std::max(base.low, 0.0);
+  double first = power(low);
+  double second = power(base.high);
+  return Outward(std::min(first, second), std::max(first, second),
+                 base.continuous && base.low >= 0 &&
+                     !(exponent < 0 && low == 0));
+}
+
+/**
+ * @details Схема Горнера в интервальной арифметике дает гарантированную, но
+ * не всегда точную оценку: на узких отрезках она сходится к точной.
+ */
+Interval HornerScheme(const Interval &x, const double *coefficients) {
+  size_t coefficients_count = static_cast<size_t>(coefficients[0]);
+  Interval accumulator = Interval::Point(coefficients[1]);
+  for (size_t k = 2; k <= coefficients_count; ++k) {
+    accumulator = accumulator * x + Interval::Point(coefficients[k]);
+  }
+  return accumulator;
+}
+
+/**
+ * @details Остаток от деления на точку линеен, пока частное не меняет целой
+ * части, и тогда вычисляется точно по концам. Иначе остаток ограничен
+ * модулем делителя и делимого и имеет знак делимого, а на отрезке есть
+ * скачки.
+ */
+Interval Modulo(const Interval &n, const Interval &m) {
+  if (n.IsEmpty() || m.IsEmpty() || (m.low == 0 && m.high == 0)) {
+    return Interval::Empty();
+  }
+  bool continuous = n.continuous && m.continuous;
+  if (!m.Contains(0)) {
+    double smallest = std::min(std::fabs(m.low), std::fabs(m.high));
+    if (std::max(std::fabs(n.low), std::fabs(n.high)) < smallest) {
+      return {n.low, n.high, continuous};
+    }
+    if (m.low == m.high && std::isfinite(n.low) && std::isfinite(n.high) &&
+        std::trunc(n.low / smallest) == std::trunc(n.high / smallest)) {
+      double low = Modulo(n.low, m.low);
+      double high = Modulo(n.high, m.low);
+      if (low <= high) {
+        return {low, high, continuous};
+      }
+    }
+  }
+  double bound = std::max(std::fabs(m.low), std::fabs(m.high));
+  return {n.low < 0 ? std::max(n.low, -bound) : 0,
+          n.high > 0 ? std::min(n.high, bound) : 0, false};
+}
+
+}  // namespace s21
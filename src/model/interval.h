@@ -0,0 +1,95 @@
+#ifndef SMARTCALC_MODEL_INTERVAL_H_
+#define SMARTCALC_MODEL_INTERVAL_H_
+
+#include <limits>
+
+namespace s21 {
+
+/**
+ * @brief Отрезок значений для интервальной арифметики.
+ * @details Результат операции над отрезками гарантированно содержит все
+ * значения операции над их точками (границы расширяются наружу на
+ * погрешность округления). Пустой отрезок (low > high) означает, что
+ * функция не определена ни в одной точке. Флаг continuous означает, что
+ * функция определена и непрерывна на всем отрезке аргументов: он
+ * сбрасывается на полюсах (tan, деление на отрезок с нулем), скачках
+ * остатка и границах области определения.
+ */
+struct Interval {
+  double low = 0;           ///< Нижняя граница.
+  double high = 0;          ///< Верхняя граница.
+  bool continuous = true;  ///< Функция определена и непрерывна на отрезке.
+
+  /**
+   * @brief Отрезок из одной точки.
+   */
+  static Interval Point(double value) { return {value, value, true}; }
+
+  /**
+   * @brief Пустой отрезок (функция нигде не определена).
+   */
+  static Interval Empty() {
+    return {std::numeric_limits<double>::infinity(),
+            -std::numeric_limits<double>::infinity(), false};
+  }
+
+  /**
+   * @brief Вся числовая прямая с разрывом.
+   */
+  static Interval Entire() {
+    return {-std::numeric_limits<double>::infinity(),
+            std::numeric_limits<double>::infinity(), false};
+  }
+
+  /**
+   * @brief Проверка, что отрезок пуст.
+   */
+  bool IsEmpty() const { return !(low <= high); }
+
+  /**
+   * @brief Проверка, что отрезок содержит точку.
+   */
+  bool Contains(double value) const { return low <= value && value <= high; }
+};
+
+Interval Hull(const Interval &a, const Interval &b);
+
+Interval operator+(const Interval &a, const Interval &b);
+
+Interval operator-(const Interval &a, const Interval &b);
+
+Interval operator-(const Interval &a);
+
+Interval operator*(const Interval &a, const Interval &b);
+
+Interval operator/(const Interval &a, const Interval &b);
+
+Interval Sin(const Interval &a);
+
+Interval Cos(const Interval &a);
+
+Interval Tan(const Interval &a);
+
+Interval Acos(const Interval &a);
+
+Interval Asin(const Interval &a);
+
+Interval Atan(const Interval &a);
+
+Interval Ln(const Interval &a);
+
+Interval Log(const Interval &a);
+
+Interval Sqrt(const Interval &a);
+
+Interval Pow(const Interval &base, const Interval &exponent);
+
+Interval PowerByParts(const Interval &base, double exponent);
+
+Interval HornerScheme(const Interval &x, const double *coefficients);
+
+Interval Modulo(const Interval &n, const Interval &m);
+
+}  // namespace s21
+
+#endif  // SMARTCALC_MODEL_INTERVAL_H_
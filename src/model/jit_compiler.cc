@@ -0,0 +1,676 @@
+#include "jit_compiler.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "compiled_expression.h"
+#include "operations.h"
+
+#if defined(__x86_64__) && (defined(__linux__) || defined(__APPLE__))
+#define SMARTCALC_JIT_SUPPORTED 1
+#include <sys/mman.h>
+#endif
+
+namespace s21 {
+
+#ifdef SMARTCALC_JIT_SUPPORTED
+
+namespace {
+
+/**
+ * @brief Кодировщик инструкций x86-64, используемых JIT.
+ * @details Адресация кадра всегда [rsp + disp32], временные регистры - rax,
+ * xmm0 и xmm1. Упакованные инструкции кодируются префиксом VEX (ymm, AVX) или
+ * как SSE2 (xmm), в зависимости от SetAvx.
+ */
+class Assembler {
+ public:
+  /**
+   * @brief Номера регистров общего назначения для адресации памяти.
+   */
+  enum Register : uint8_t {
+    reg_rax = 0,
+    reg_rbx = 3,
+    reg_rsp = 4,
+    reg_r12 = 12
+  };
+
+  /**
+   * @brief Коды операций SSE2 над скалярным double (после префикса F2 0F).
+   */
+  enum SseOperation : uint8_t {
+    sse_load = 0x10,
+    sse_store = 0x11,
+    sse_sqrt = 0x51,
+    sse_add = 0x58,
+    sse_mult = 0x59,
+    sse_sub = 0x5C,
+    sse_div = 0x5E
+  };
+
+  std::vector<uint8_t> &GetCode() { return code_; }
+
+  void SetAvx(bool avx) { avx_ = avx; }
+
+  size_t GetSize() const { return code_.size(); }
+
+  void Bytes(std::initializer_list<uint8_t> bytes) {
+    code_.insert(code_.end(), bytes);
+  }
+
+  void Imm32(uint32_t value) {
+    for (int i = 0; i < 4; ++i) code_.push_back((value >> (8 * i)) & 0xFF);
+  }
+
+  void Imm64(uint64_t value) {
+    for (int i = 0; i < 8; ++i) code_.push_back((value >> (8 * i)) & 0xFF);
+  }
+
+  /**
+   * @brief Операция SSE2 "xmm, [rsp + offset]" или "[rsp + offset], xmm".
+   * @param operation Код операции.
+   * @param xmm Номер регистра (0 или 1).
+   * @param offset Смещение в кадре.
+   */
+  void Sse(SseOperation operation, int xmm, uint32_t offset) {
+    Bytes({0xF2, 0x0F, operation, static_cast<uint8_t>(0x84 | (xmm << 3)),
+           0x24});
+    Imm32(offset);
+  }
+
+  /**
+   * @brief mov rax, imm64.
+   */
+  void MovRaxImm(uint64_t value) {
+    Bytes({0x48, 0xB8});
+    Imm64(value);
+  }
+
+  /**
+   * @brief mov rdi, imm64.
+   */
+  void MovRdiImm(uint64_t value) {
+    Bytes({0x48, 0xBF});
+    Imm64(value);
+  }
+
+  /**
+   * @brief mov [rsp + offset], rax.
+   */
+  void StoreRax(uint32_t offset) {
+    Bytes({0x48, 0x89, 0x84, 0x24});
+    Imm32(offset);
+  }
+
+  /**
+   * @brief mov rax, [rsp + offset].
+   */
+  void LoadRax(uint32_t offset) {
+    Bytes({0x48, 0x8B, 0x84, 0x24});
+    Imm32(offset);
+  }
+
+  /**
+   * @brief mov [rsp + offset], rdi.
+   */
+  void StoreRdi(uint32_t offset) {
+    Bytes({0x48, 0x89, 0xBC, 0x24});
+    Imm32(offset);
+  }
+
+  /**
+   * @brief mov rax, [rax + offset].
+   */
+  void LoadRaxIndirect(uint32_t offset) {
+    Bytes({0x48, 0x8B, 0x80});
+    Imm32(offset);
+  }
+
+  /**
+   * @brief Копирование 8 байт внутри кадра через rax.
+   */
+  void Copy(uint32_t from, uint32_t to) {
+    LoadRax(from);
+    StoreRax(to);
+  }
+
+  /**
+   * @brief Вызов функции по абсолютному адресу (mov rax, imm64; call rax).
+   */
+  void Call(const void *function) {
+    MovRaxImm(reinterpret_cast<uint64_t>(function));
+    Bytes({0xFF, 0xD0});
+  }
+
+  /**
+   * @brief Упакованная операция над регистрами: "destination = first
+   * operation second" для AVX, "destination operation= second" для SSE2
+   * (first не используется).
+   * @param operation Код операции (тот же, что у скалярной, с префиксом 66).
+   */
+  void Packed(uint8_t operation, int destination, int first, int second) {
+    Prefix(destination, first, second);
+    Bytes({operation, ModRm(3, destination, second)});
+  }
+
+  /**
+   * @brief Упакованная операция "xmm, [base + offset]" или "[base + offset],
+   * xmm" (movupd и т.д.).
+   */
+  void PackedMemory(uint8_t operation, int xmm, Register base,
+                    uint32_t offset) {
+    Prefix(xmm, 0, base);
+    Bytes({operation, ModRm(2, xmm, base)});
+    if ((base & 7) == reg_rsp) {
+      Bytes({0x24});
+    }
+    Imm32(offset);
+  }
+
+  /**
+   * @brief vzeroupper перед вызовом кода SSE (только для AVX).
+   */
+  void ZeroUpper() {
+    if (avx_) {
+      Bytes({0xC5, 0xF8, 0x77});
+    }
+  }
+
+ private:
+  /**
+   * @brief Байт ModRM.
+   */
+  static uint8_t ModRm(int mode, int reg, int rm) {
+    return static_cast<uint8_t>(mode << 6 | (reg & 7) << 3 | (rm & 7));
+  }
+
+  /**
+   * @brief Префикс упакованной операции над double: трехбайтовый VEX с
+   * L = 1 или 66 [REX] 0F.
+   */
+  void Prefix(int reg, int source, int rm) {
+    if (avx_) {
+      Bytes({0xC4,
+             static_cast<uint8_t>((~reg >> 3 & 1) << 7 | 1 << 6 |
+                                  (~rm >> 3 & 1) << 5 | 0x01),
+             static_cast<uint8_t>((~source & 0xF) << 3 | 0x04 | 0x01)});
+      return;
+    }
+    Bytes({0x66});
+    if (reg >= 8 || rm >= 8) {
+      Bytes({static_cast<uint8_t>(0x40 | (reg >> 3) << 2 | rm >> 3)});
+    }
+    Bytes({0x0F});
+  }
+
+  std::vector<uint8_t> code_;  ///< Машинный код.
+
+  bool avx_ = false;  ///< Кодировать упакованные операции для ymm (AVX).
+};
+
+/**
+ * @brief Адрес функции одного аргумента из libm.
+ */
+const void *UnaryAddress(double (*function)(double)) {
+  return reinterpret_cast<const void *>(function);
+}
+
+/**
+ * @brief Адрес функции двух аргументов.
+ */
+const void *BinaryAddress(double (*function)(double, double)) {
+  return reinterpret_cast<const void *>(function);
+}
+
+/**
+ * @brief Адрес функции вычисления многочлена.
+ */
+const void *HornerAddress() {
+  return reinterpret_cast<const void *>(
+      static_cast<double (*)(double, const double *)>(HornerScheme));
+}
+
+/**
+ * @brief Адрес функции libm для унарной операции байт-кода (op_cos..op_log).
+ */
+const void *FunctionAddress(CompiledExpression::OpCode code) {
+  using Unary = double (*)(double);
+  static const Unary functions[] = {cos,  sin,  tan, acos,
+                                    asin, atan, log, log10};
+  return UnaryAddress(functions[code - CompiledExpression::op_cos]);
+}
+
+constexpr int kFirstStackRegister = 2;  ///< Регистр нижнего элемента стэка
+                                        ///< пакетной функции (xmm0 и xmm1 -
+                                        ///< временные).
+
+constexpr int kRegistersCount = 16;  ///< Количество регистров xmm/ymm.
+
+constexpr uint32_t kVectorBytes = 32;  ///< Размер ячейки кадра пакетной
+                                       ///< функции (один ymm).
+
+}  // namespace
+
+#endif  // SMARTCALC_JIT_SUPPORTED
+
+/**
+ * @brief Деструктор: освобождает исполняемую память.
+ */
+JitFunction::~JitFunction() {
+#ifdef SMARTCALC_JIT_SUPPORTED
+  if (memory_ != nullptr) {
+    munmap(memory_, memory_size_);
+  }
+#endif
+}
+
+/**
+ * @brief Проверка, поддерживается ли генерация кода на этой платформе.
+ */
+bool JitFunction::IsSupported() {
+#ifdef SMARTCALC_JIT_SUPPORTED
+  return true;
+#else
+  return false;
+#endif
+}
+
+/**
+ * @brief Генерация машинного кода для выражения.
+ * @param expression Скомпилированное выражение.
+ * @return true - если код сгенерирован, false - если платформа или какая-то
+ * операция не поддерживается (тогда используется интерпретатор).
+ * @details Генерируются две функции: скалярная double(const double *), которая
+ * читает переменные из массива значений, и пакетная векторная (CompileBatch)
+ * для выражений от одной переменной.
+ */
+bool JitFunction::Compile(const CompiledExpression &expression) {
+#ifdef SMARTCALC_JIT_SUPPORTED
+  using Op = CompiledExpression;
+  const uint32_t max_depth = static_cast<uint32_t>(expression.max_depth_);
+  const uint32_t slots_base = max_depth * 8;
+  const uint32_t bindings_offset =
+      slots_base + static_cast<uint32_t>(expression.slots_count_) * 8;
+  uint32_t frame_size = bindings_offset + 8;
+  if (frame_size % 16 != 8) {
+    frame_size += 8;
+  }
+
+  // Коэффициенты многочленов нужны обеим функциям, числа пакетной функции -
+  // по одному на каждый икс вектора. Указатели на data_ зашиваются в код,
+  // поэтому память выделяется сразу.
+  size_t data_size = 0;
+  for (size_t i = 0; i < expression.code_.size(); ++i) {
+    if (expression.code_[i] == Op::op_horner) {
+      data_size += 2 * (static_cast<size_t>(
+                            expression.constants_[expression.operands_[i]]) +
+                        1);
+    } else if (expression.code_[i] == Op::op_number) {
+      data_size += kVectorBytes / sizeof(double);
+    }
+  }
+  data_.reserve(data_size);
+
+  Assembler as;
+  as.Bytes({0x48, 0x81, 0xEC});  // sub rsp, frame_size
+  as.Imm32(frame_size);
+  as.StoreRdi(bindings_offset);
+
+  uint32_t top = 0;  // Смещение ячейки за верхушкой стэка.
+  for (size_t i = 0; i < expression.code_.size(); ++i) {
+    uint32_t operand = expression.operands_[i];
+    double constant = 0;
+    if (operand < expression.constants_.size()) {
+      constant = expression.constants_[operand];
+    }
+    uint64_t constant_bits;
+    std::memcpy(&constant_bits, &constant, sizeof(constant_bits));
+
+    switch (expression.code_[i]) {
+      case Op::op_number:
+        as.MovRaxImm(constant_bits);
+        as.StoreRax(top);
+        top += 8;
+        break;
+      case Op::op_variable:
+        as.LoadRax(bindings_offset);
+        as.LoadRaxIndirect(operand * 8);
+        as.StoreRax(top);
+        top += 8;
+        break;
+      case Op::op_load:
+        as.Copy(slots_base + operand * 8, top);
+        top += 8;
+        break;
+      case Op::op_store:
+        as.Copy(top - 8, slots_base + operand * 8);
+        break;
+      case Op::op_sqrt:
+        as.Sse(Assembler::sse_sqrt, 0, top - 8);
+        as.Sse(Assembler::sse_store, 0, top - 8);
+        break;
+      case Op::op_neg:
+        as.Bytes({0x66, 0x0F, 0x57, 0xC0});  // xorpd xmm0, xmm0
+        as.Sse(Assembler::sse_sub, 0, top - 8);
+        as.Sse(Assembler::sse_store, 0, top - 8);
+        break;
+      case Op::op_plus:
+      case Op::op_minus:
+      case Op::op_mult:
+      case Op::op_div: {
+        Assembler::SseOperation operation =
+            expression.code_[i] == Op::op_plus    ? Assembler::sse_add
+            : expression.code_[i] == Op::op_minus ? Assembler::sse_sub
+            : expression.code_[i] == Op::op_mult  ? Assembler::sse_mult
+                                                  : Assembler::sse_div;
+        top -= 8;
+        as.Sse(Assembler::sse_load, 0, top - 8);
+        as.Sse(operation, 0, top);
+        as.Sse(Assembler::sse_store, 0, top - 8);
+        break;
+      }
+      case Op::op_pow:
+      case Op::op_mod:
+        top -= 8;
+        as.Sse(Assembler::sse_load, 0, top - 8);
+        as.Sse(Assembler::sse_load, 1, top);
+        as.Call(expression.code_[i] == Op::op_pow ? BinaryAddress(pow)
+                                                  : BinaryAddress(Modulo));
+        as.Sse(Assembler::sse_store, 0, top - 8);
+        break;
+      case Op::op_powi:
+        as.Sse(Assembler::sse_load, 0, top - 8);
+        as.MovRaxImm(constant_bits);
+        as.Bytes({0x66, 0x48, 0x0F, 0x6E, 0xC8});  // movq xmm1, rax
+        as.Call(BinaryAddress(PowerByParts));
+        as.Sse(Assembler::sse_store, 0, top - 8);
+        break;
+      case Op::op_horner: {
+        const double *coefficients = &expression.constants_[operand];
+        size_t count = static_cast<size_t>(coefficients[0]) + 1;
+        size_t data_offset = data_.size();
+        data_.insert(data_.end(), coefficients, coefficients + count);
+        as.Sse(Assembler::sse_load, 0, top - 8);
+        as.MovRdiImm(reinterpret_cast<uint64_t>(data_.data() + data_offset));
+        as.Call(HornerAddress());
+        as.Sse(Assembler::sse_store, 0, top - 8);
+        break;
+      }
+      case Op::op_cos:
+      case Op::op_sin:
+      case Op::op_tan:
+      case Op::op_acos:
+      case Op::op_asin:
+      case Op::op_atan:
+      case Op::op_ln:
+      case Op::op_log:
+        as.Sse(Assembler::sse_load, 0, top - 8);
+        as.Call(FunctionAddress(expression.code_[i]));
+        as.Sse(Assembler::sse_store, 0, top - 8);
+        break;
+      default:
+        return false;
+    }
+  }
+  as.Sse(Assembler::sse_load, 0, 0);
+  as.Bytes({0x48, 0x81, 0xC4});  // add rsp, frame_size
+  as.Imm32(frame_size);
+  as.Bytes({0xC3});  // ret
+
+  size_t batch_offset = as.GetSize();
+  std::vector<uint8_t> batch = CompileBatch(expression, batch_offset);
+  as.GetCode().insert(as.GetCode().end(), batch.begin(), batch.end());
+
+  size_t page_size = 4096;
+  memory_size_ = (as.GetSize() + page_size - 1) / page_size * page_size;
+  memory_ = mmap(nullptr, memory_size_, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (memory_ == MAP_FAILED) {
+    memory_ = nullptr;
+    return false;
+  }
+  std::memcpy(memory_, as.GetCode().data(), as.GetSize());
+  if (mprotect(memory_, memory_size_, PROT_READ | PROT_EXEC) != 0) {
+    munmap(memory_, memory_size_);
+    memory_ = nullptr;
+    return false;
+  }
+  scalar_ = reinterpret_cast<ScalarFunction>(memory_);
+  if (!batch.empty()) {
+    batch_ = reinterpret_cast<BatchFunction>(static_cast<uint8_t *>(memory_) +
+                                             batch_offset);
+  }
+  return true;
+#else
+  (void)expression;
+  return false;
+#endif
+}
+
+/**
+ * @brief Генерация векторной пакетной функции
+ * void(const double *x, double *results, size_t count).
+ * @param expression Скомпилированное выражение.
+ * @param offset Смещение пакетной функции от скалярной в исполняемой памяти.
+ * @return Машинный код или пустой массив, если в выражении больше одной
+ * переменной или стэк не помещается в регистры.
+ * @details Элемент стэка k лежит в регистре xmm(k + 2) / ymm(k + 2), ячейки
+ * общих подвыражений - в кадре. Перед вызовом функции libm элементы стэка
+ * сохраняются в кадр, функция вызывается для каждого икса вектора по очереди
+ * (поэтому результаты совпадают с интерпретатором побитово), затем элементы
+ * загружаются обратно. Иксы, не набравшие целого вектора, считаются
+ * скалярной функцией.
+ */
+std::vector<uint8_t> JitFunction::CompileBatch(
+    const CompiledExpression &expression, size_t offset) {
+#ifdef SMARTCALC_JIT_SUPPORTED
+  using Op = CompiledExpression;
+  const int max_depth = expression.max_depth_;
+  if (expression.variables_.size() > 1 ||
+      kFirstStackRegister + max_depth > kRegistersCount) {
+    return {};
+  }
+#if defined(__GNUC__)
+  const bool avx = __builtin_cpu_supports("avx") != 0;
+#else
+  const bool avx = false;
+#endif
+  const uint32_t width = avx ? 4 : 2;
+  const uint32_t slots_base = max_depth * kVectorBytes;
+  const uint32_t frame_size =
+      slots_base +
+      static_cast<uint32_t>(expression.slots_count_) * kVectorBytes;
+  auto stack = [](int index) { return kFirstStackRegister + index; };
+
+  Assembler as;
+  as.SetAvx(avx);
+  // rdi - иксы, rsi - результаты, rdx - количество.
+  as.Bytes({0x53, 0x41, 0x54, 0x41, 0x55});  // push rbx; push r12; push r13
+  as.Bytes({0x48, 0x89, 0xFB});              // mov rbx, rdi
+  as.Bytes({0x49, 0x89, 0xF4});              // mov r12, rsi
+  as.Bytes({0x49, 0x89, 0xD5});              // mov r13, rdx
+  as.Bytes({0x48, 0x81, 0xEC});              // sub rsp, frame_size
+  as.Imm32(frame_size);
+
+  size_t vector_loop = as.GetSize();
+  as.Bytes({0x49, 0x83, 0xFD, static_cast<uint8_t>(width)});  // cmp r13, width
+  as.Bytes({0x0F, 0x82});                                      // jb tail
+  size_t jump_to_tail = as.GetSize();
+  as.Imm32(0);
+
+  int top = 0;  // Количество элементов стэка.
+  for (size_t i = 0; i < expression.code_.size(); ++i) {
+    uint32_t operand = expression.operands_[i];
+    double constant = 0;
+    if (operand < expression.constants_.size()) {
+      constant = expression.constants_[operand];
+    }
+    Op::OpCode code = expression.code_[i];
+    switch (code) {
+      case Op::op_number:
+        data_.insert(data_.end(), kVectorBytes / sizeof(double), constant);
+        as.MovRaxImm(reinterpret_cast<uint64_t>(data_.data() + data_.size() -
+                                                kVectorBytes / sizeof(double)));
+        as.PackedMemory(Assembler::sse_load, stack(top++), Assembler::reg_rax,
+                        0);
+        break;
+      case Op::op_variable:
+        as.PackedMemory(Assembler::sse_load, stack(top++), Assembler::reg_rbx,
+                        0);
+        break;
+      case Op::op_load:
+        as.PackedMemory(Assembler::sse_load, stack(top++), Assembler::reg_rsp,
+                        slots_base + operand * kVectorBytes);
+        break;
+      case Op::op_store:
+        as.PackedMemory(Assembler::sse_store, stack(top - 1),
+                        Assembler::reg_rsp,
+                        slots_base + operand * kVectorBytes);
+        break;
+      case Op::op_sqrt:
+        as.Packed(Assembler::sse_sqrt, stack(top - 1), 0, stack(top - 1));
+        break;
+      case Op::op_neg:
+        // 0.0 - x, как в интерпретаторе: xorpd xmm0, xmm0; subpd xmm0, x;
+        // movapd x, xmm0.
+        as.Packed(0x57, 0, 0, 0);
+        as.Packed(Assembler::sse_sub, 0, 0, stack(top - 1));
+        as.Packed(0x28, stack(top - 1), 0, 0);
+        break;
+      case Op::op_plus:
+      case Op::op_minus:
+      case Op::op_mult:
+      case Op::op_div: {
+        Assembler::SseOperation operation =
+            code == Op::op_plus    ? Assembler::sse_add
+            : code == Op::op_minus ? Assembler::sse_sub
+            : code == Op::op_mult  ? Assembler::sse_mult
+                                   : Assembler::sse_div;
+        --top;
+        as.Packed(operation, stack(top - 1), stack(top - 1), stack(top));
+        break;
+      }
+      case Op::op_pow:
+      case Op::op_mod:
+      case Op::op_powi:
+      case Op::op_horner:
+      case Op::op_cos:
+      case Op::op_sin:
+      case Op::op_tan:
+      case Op::op_acos:
+      case Op::op_asin:
+      case Op::op_atan:
+      case Op::op_ln:
+      case Op::op_log: {
+        bool binary = code == Op::op_pow || code == Op::op_mod;
+        const double *coefficients = nullptr;
+        if (code == Op::op_horner) {
+          size_t count = static_cast<size_t>(constant) + 1;
+          const double *source = &expression.constants_[operand];
+          coefficients = data_.data() + data_.size();
+          data_.insert(data_.end(), source, source + count);
+        }
+        for (int k = 0; k < top; ++k) {
+          as.PackedMemory(Assembler::sse_store, stack(k), Assembler::reg_rsp,
+                          k * kVectorBytes);
+        }
+        as.ZeroUpper();
+        uint32_t result = (top - (binary ? 2 : 1)) * kVectorBytes;
+        for (uint32_t lane = 0; lane < width * 8; lane += 8) {
+          as.Sse(Assembler::sse_load, 0, result + lane);
+          if (binary) {
+            as.Sse(Assembler::sse_load, 1, result + kVectorBytes + lane);
+            as.Call(code == Op::op_pow ? BinaryAddress(pow)
+                                       : BinaryAddress(Modulo));
+          } else if (code == Op::op_powi) {
+            uint64_t constant_bits;
+            std::memcpy(&constant_bits, &constant, sizeof(constant_bits));
+            as.MovRaxImm(constant_bits);
+            as.Bytes({0x66, 0x48, 0x0F, 0x6E, 0xC8});  // movq xmm1, rax
+            as.Call(BinaryAddress(PowerByParts));
+          } else if (code == Op::op_horner) {
+            as.MovRdiImm(reinterpret_cast<uint64_t>(coefficients));
+            as.Call(HornerAddress());
+          } else {
+            as.Call(FunctionAddress(code));
+          }
+          as.Sse(Assembler::sse_store, 0, result + lane);
+        }
+        if (binary) {
+          --top;
+        }
+        for (int k = 0; k < top; ++k) {
+          as.PackedMemory(Assembler::sse_load, stack(k), Assembler::reg_rsp,
+                          k * kVectorBytes);
+        }
+        break;
+      }
+      default:
+        return {};
+    }
+  }
+  as.PackedMemory(Assembler::sse_store, stack(0), Assembler::reg_r12, 0);
+  uint8_t step = static_cast<uint8_t>(width * 8);
+  as.Bytes({0x48, 0x83, 0xC3, step});  // add rbx, width * 8
+  as.Bytes({0x49, 0x83, 0xC4, step});  // add r12, width * 8
+  as.Bytes({0x49, 0x83, 0xED, static_cast<uint8_t>(width)});  // sub r13, width
+  as.Bytes({0xE9});  // jmp vector_loop
+  as.Imm32(static_cast<uint32_t>(static_cast<int32_t>(vector_loop) -
+                                 static_cast<int32_t>(as.GetSize() + 4)));
+  uint32_t tail_jump = static_cast<uint32_t>(as.GetSize() - (jump_to_tail + 4));
+  std::memcpy(&as.GetCode()[jump_to_tail], &tail_jump, sizeof(tail_jump));
+
+  // Остаток: скалярная функция для каждого икса.
+  as.ZeroUpper();
+  as.Bytes({0x48, 0x81, 0xC4});  // add rsp, frame_size
+  as.Imm32(frame_size);
+  as.Bytes({0x4D, 0x85, 0xED});  // test r13, r13
+  as.Bytes({0x0F, 0x84});        // jz done
+  size_t jump_to_done = as.GetSize();
+  as.Imm32(0);
+  size_t scalar_loop = as.GetSize();
+  as.Bytes({0x48, 0x89, 0xDF});  // mov rdi, rbx
+  as.Bytes({0xE8});              // call scalar
+  as.Imm32(static_cast<uint32_t>(
+      -static_cast<int32_t>(offset + as.GetSize() + 4)));
+  as.Bytes({0xF2, 0x41, 0x0F, 0x11, 0x04, 0x24});  // movsd [r12], xmm0
+  as.Bytes({0x48, 0x83, 0xC3, 0x08});              // add rbx, 8
+  as.Bytes({0x49, 0x83, 0xC4, 0x08});              // add r12, 8
+  as.Bytes({0x49, 0xFF, 0xCD});                    // dec r13
+  as.Bytes({0x0F, 0x85});                          // jnz scalar_loop
+  as.Imm32(static_cast<uint32_t>(static_cast<int32_t>(scalar_loop) -
+                                 static_cast<int32_t>(as.GetSize() + 4)));
+  uint32_t done_jump = static_cast<uint32_t>(as.GetSize() - (jump_to_done + 4));
+  std::memcpy(&as.GetCode()[jump_to_done], &done_jump, sizeof(done_jump));
+  as.Bytes({0x41, 0x5D, 0x41, 0x5C, 0x5B, 0xC3});  // pop r13; pop r12;
+                                                   // pop rbx; ret
+  return std::move(as.GetCode());
+#else
+  (void)expression;
+  (void)offset;
+  return {};
+#endif
+}
+
+/**
+ * @brief Функция-геттер, возвращающая скалярную функцию (nullptr, если код не
+ * сгенерирован).
+ */
+JitFunction::ScalarFunction JitFunction::GetScalar() const { return scalar_; }
+
+/**
+ * @brief Функция-геттер, возвращающая пакетную функцию (nullptr, если код не
+ * сгенерирован).
+ */
+JitFunction::BatchFunction JitFunction::GetBatch() const { return batch_; }
+
+/**
+ * @brief Оценка памяти, занятой машинным кодом, в байтах: страницы
+ * исполняемой памяти и данные, на которые ссылается код.
+ */
+size_t JitFunction::GetMemoryUsage() const {
+  return memory_size_ + data_.capacity() * sizeof(double);
+}
+
+}  // namespace s21
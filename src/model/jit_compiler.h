@@ -0,0 +1,73 @@
+#ifndef SMARTCALC_MODEL_JIT_COMPILER_H_
+#define SMARTCALC_MODEL_JIT_COMPILER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace s21 {
+
+class CompiledExpression;
+
+/**
+ * @brief Класс для машинного кода x86-64, сгенерированного по байт-коду
+ * выражения во время работы программы (JIT).
+ * @details Значения стэка, ячейки общих подвыражений и указатель на значения
+ * переменных лежат в кадре на стэке вызова, арифметика выполняется
+ * инструкциями SSE2 (addsd, mulsd, sqrtsd и т.д.), функции и pow вызываются
+ * из libm - те же, что использует интерпретатор, поэтому результаты
+ * совпадают побитово. На платформах, где генерация не поддерживается,
+ * Compile возвращает false и выражение вычисляется интерпретатором.
+ *
+ * Пакетная функция векторная: элементы стэка лежат в регистрах ymm (AVX,
+ * четыре икса) или xmm (SSE2, два икса), арифметика и корень выполняются
+ * упакованными инструкциями (vaddpd, mulpd, sqrtpd и т.д.), а функции libm
+ * вызываются по очереди для каждого икса. Остаток массива, меньший ширины
+ * вектора, считается скалярной функцией.
+ */
+class JitFunction {
+ public:
+  using ScalarFunction = double (*)(const double *);
+  using BatchFunction = void (*)(const double *, double *, size_t);
+
+  JitFunction() = default;
+
+  JitFunction(const JitFunction &) = delete;
+
+  JitFunction &operator=(const JitFunction &) = delete;
+
+  ~JitFunction();
+
+  static bool IsSupported();
+
+  bool Compile(const CompiledExpression &expression);
+
+  ScalarFunction GetScalar() const;
+
+  BatchFunction GetBatch() const;
+
+  size_t GetMemoryUsage() const;
+
+ private:
+  std::vector<uint8_t> CompileBatch(const CompiledExpression &expression,
+                                    size_t offset);
+
+  void *memory_ = nullptr;  ///< Исполняемая память с машинным кодом.
+
+  size_t memory_size_ = 0;  ///< Размер исполняемой памяти.
+
+  std::vector<double> data_;  ///< Данные, на которые ссылается код
+                              ///< (коэффициенты многочленов).
+
+  ScalarFunction scalar_ = nullptr;  ///< Вычисление для значений
+                                     ///< переменных.
+
+  BatchFunction batch_ = nullptr;  ///< Вычисление для массива значений
+                                   ///< единственной переменной (nullptr,
+                                   ///< если выражение не помещается в
+                                   ///< векторные регистры).
+};
+
+}  // namespace s21
+
+#endif  // SMARTCALC_MODEL_JIT_COMPILER_H_
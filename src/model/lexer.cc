@@ -0,0 +1,266 @@
+#include "lexer.h"
+
+#include <charconv>
+#include <cstdint>
+#include <system_error>
+
+namespace s21 {
+
+namespace {
+
+/**
+ * @brief Названия ключевых слов в порядке перечисления Lexer::Keyword.
+ */
+constexpr std::string_view kKeywordNames[] = {
+    "cos", "sin", "tan", "acos", "asin", "atan", "ln", "log", "sqrt", "mod"};
+
+constexpr size_t kAlphabetSize = 26;  ///< Количество латинских букв.
+
+constexpr size_t kTrieSize = 32;  ///< Максимальное количество вершин бора.
+
+/**
+ * @brief Бор ключевых слов с плотной таблицей переходов.
+ * @details Вершина 0 - корень, переход в вершину 0 означает отсутствие
+ * перехода.
+ */
+struct KeywordTrie {
+  uint8_t next[kTrieSize][kAlphabetSize];  ///< Переходы по буквам.
+  Lexer::Keyword keyword[kTrieSize];       ///< Ключевое слово, которое
+                                           ///< заканчивается в вершине.
+};
+
+/**
+ * @brief Построение бора ключевых слов на этапе компиляции.
+ */
+constexpr KeywordTrie BuildKeywordTrie() {
+  KeywordTrie trie{};
+  for (size_t node = 0; node < kTrieSize; ++node) {
+    trie.keyword[node] = Lexer::kw_none;
+  }
+  size_t nodes_count = 1;
+  for (size_t keyword = 0; keyword < Lexer::kw_none; ++keyword) {
+    size_t node = 0;
+    for (char letter : kKeywordNames[keyword]) {
+      uint8_t &child = trie.next[node][letter - 'a'];
+      if (!child) {
+        child = static_cast<uint8_t>(nodes_count++);
+      }
+      node = child;
+    }
+    trie.keyword[node] = static_cast<Lexer::Keyword>(keyword);
+  }
+  return trie;
+}
+
+constexpr KeywordTrie kKeywordTrie = BuildKeywordTrie();
+
+/**
+ * @brief Номер латинской буквы в алфавите без учета регистра.
+ * @return Номер буквы или kAlphabetSize, если символ не буква.
+ */
+inline size_t LetterIndex(char symbol) {
+  size_t index = static_cast<unsigned char>(ToLower(symbol)) - size_t{'a'};
+  return index < kAlphabetSize ? index : kAlphabetSize;
+}
+
+/**
+ * @brief Проверка, является ли символ цифрой.
+ */
+inline bool IsDigit(char symbol) {
+  return static_cast<unsigned char>(symbol - '0') < 10;
+}
+
+/**
+ * @brief Проверка, может ли символ начинать слово.
+ */
+inline bool IsWordStart(char symbol) {
+  return LetterIndex(symbol) != kAlphabetSize || symbol == '_';
+}
+
+/**
+ * @brief Проверка, начинается ли с позиции оператор mod (без учета
+ * регистра).
+ * @details После mod не должно идти буквы или подчеркивания, иначе это
+ * начало или часть имени (model, xmodk).
+ */
+inline bool IsModAt(std::string_view input, size_t position) {
+  return input.size() - position >= 3 &&
+         IsSameName(input.substr(position, 3), "mod") &&
+         (input.size() - position == 3 || !IsWordStart(input[position + 3]));
+}
+
+}  // namespace
+
+/**
+ * @brief Конструктор.
+ * @param input Строка с выражением. Должна существовать, пока используется
+ * лексер.
+ */
+Lexer::Lexer(std::string_view input) : input_(input) {}
+
+/**
+ * @brief Чтение следующего токена без исключений.
+ * @param token Прочитанный токен. После конца строки - токен tk_end.
+ * @return err_none или err_incorrect_number.
+ * Смещение ошибочного токена возвращает GetTokenPosition.
+ */
+ErrorCode Lexer::Read(Token &token) noexcept {
+  while (position_ < input_.size() && input_[position_] == ' ') {
+    ++position_;
+  }
+  token_position_ = position_;
+  token = Token{tk_end, kw_none, '\0', 0, position_, 0};
+  if (position_ == input_.size()) {
+    return err_none;
+  }
+  char symbol = input_[position_];
+  size_t position = position_;
+  if (IsDigit(symbol)) {
+    token.kind = tk_number;
+    ErrorCode code = ReadNumber(input_, position, token.value);
+    if (code != err_none) {
+      return code;
+    }
+  } else if (IsWordStart(symbol)) {
+    token.keyword = ParseWord(position);
+    token.kind = token.keyword == kw_none ? tk_name : tk_keyword;
+  } else {
+    token.kind = tk_symbol;
+    token.symbol = symbol;
+    ++position;
+  }
+  position_ = position;
+  token.length = position_ - token.position;
+  return err_none;
+}
+
+/**
+ * @brief Чтение следующего токена.
+ * @throw std::invalid_argument В случае некорректного числа.
+ * @return Токен. После конца строки возвращается токен tk_end.
+ */
+Lexer::Token Lexer::Next() {
+  Token token;
+  ErrorCode code = Read(token);
+  if (code != err_none) {
+    CalculationError{code}.Throw();
+  }
+  return token;
+}
+
+/**
+ * @brief Функция-геттер, возвращающая смещение начала последнего токена.
+ * @details После ошибки Read или Next это смещение ошибочного токена.
+ */
+size_t Lexer::GetTokenPosition() const { return token_position_; }
+
+/**
+ * @brief Парсинг числа в десятичной или экспоненциальной записи без
+ * исключений.
+ * @param input Строка.
+ * @param position Смещение начала числа (допускается знак). После парсинга -
+ * смещение первого символа после числа.
+ * @param number Значение числа.
+ * @return err_none или err_incorrect_number.
+ */
+ErrorCode Lexer::ReadNumber(std::string_view input, size_t &position,
+                            double &number) noexcept {
+  size_t begin = position;
+  if (position < input.size() &&
+      (input[position] == '-' || input[position] == '+')) {
+    ++position;
+  }
+  size_t digits_begin = position;
+  bool dot_check = false;
+  bool e_check = false;
+  bool sign_check = false;
+  for (; position < input.size(); ++position) {
+    char symbol = input[position];
+    if (IsDigit(symbol)) {
+      continue;
+    } else if (symbol == '.' && !dot_check && !e_check) {
+      dot_check = true;
+    } else if (ToLower(symbol) == 'e' && !e_check) {
+      e_check = true;
+    } else if ((symbol == '+' || symbol == '-') &&
+               ToLower(input[position - 1]) == 'e' && !sign_check) {
+      sign_check = true;
+    } else if (symbol == '.' || ToLower(symbol) == 'e') {
+      return err_incorrect_number;
+    } else {
+      break;
+    }
+  }
+  char last = position > digits_begin ? input[position - 1] : '.';
+  if (ToLower(last) == 'e' || last == '-' || last == '+' || last == '.') {
+    return err_incorrect_number;
+  }
+  if (input[begin] == '+') {
+    ++begin;
+  }
+  number = 0;
+  auto [end, error] = std::from_chars(input.data() + begin,
+                                      input.data() + position, number);
+  if (error != std::errc() || end != input.data() + position) {
+    return err_incorrect_number;
+  }
+  return err_none;
+}
+
+/**
+ * @brief Парсинг числа в десятичной или экспоненциальной записи.
+ * @param input Строка.
+ * @param position Смещение начала числа (допускается знак). После парсинга -
+ * смещение первого символа после числа.
+ * @throw std::invalid_argument В случае некорректного числа.
+ * @return Значение числа.
+ */
+double Lexer::ParseNumber(std::string_view input, size_t &position) {
+  double number = 0;
+  ErrorCode code = ReadNumber(input, position, number);
+  if (code != err_none) {
+    CalculationError{code}.Throw();
+  }
+  return number;
+}
+
+/**
+ * @brief Функция-геттер, возвращающая название ключевого слова.
+ */
+std::string_view Lexer::GetKeywordName(Keyword keyword) {
+  return keyword < kw_none ? kKeywordNames[keyword] : std::string_view();
+}
+
+/**
+ * @brief Парсинг слова: ключевого слова или имени переменной.
+ * @param position Смещение начала слова. После парсинга - смещение первого
+ * символа после слова.
+ * @return Ключевое слово или kw_none, если слово - имя переменной.
+ * @details Слово читается до первого символа, который не может в нем стоять,
+ * или до оператора mod. Ключевое слово ищется спуском по бору, и слово должно
+ * совпасть с ним целиком.
+ */
+Lexer::Keyword Lexer::ParseWord(size_t &position) const noexcept {
+  if (IsModAt(input_, position)) {
+    position += 3;
+    return kw_mod;
+  }
+  size_t node = 0;
+  bool in_trie = true;
+  for (; position < input_.size(); ++position) {
+    char symbol = input_[position];
+    size_t letter = LetterIndex(symbol);
+    if ((letter == kAlphabetSize && !IsDigit(symbol) && symbol != '_') ||
+        IsModAt(input_, position)) {
+      break;
+    }
+    if (in_trie && letter != kAlphabetSize && kKeywordTrie.next[node][letter]) {
+      node = kKeywordTrie.next[node][letter];
+    } else {
+      in_trie = false;
+    }
+  }
+  return in_trie ? kKeywordTrie.keyword[node] : kw_none;
+}
+
+}  // namespace s21
@@ -0,0 +1,117 @@
+#ifndef SMARTCALC_MODEL_LEXER_H_
+#define SMARTCALC_MODEL_LEXER_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <string_view>
+
+#include "result.h"
+
+namespace s21 {
+
+/**
+ * @brief Класс для разбивки выражения на токены за один проход.
+ * @details Лексер только читает строку: регистр букв учитывается при
+ * сравнении, а не переводом строки в нижний регистр, и память в куче не
+ * выделяется. Read и ReadNumber сообщают об ошибке кодом, Next и ParseNumber -
+ * исключением.
+ *
+ * Слово из латинских букв, цифр и подчеркиваний, начинающееся не с цифры,
+ * является ключевым словом, если совпадает с ним целиком, иначе - именем
+ * переменной: sinx - переменная, а не sin x. Оператор mod, за которым не
+ * идет буква или подчеркивание, отделяется и внутри слова (xmod2 читается
+ * как x mod 2, как и до появления имен переменных), а model и xmodk - имена.
+ */
+class Lexer {
+ public:
+  /**
+   * @brief Перечисление ключевых слов (функций и оператора mod).
+   */
+  enum Keyword {
+    kw_cos,
+    kw_sin,
+    kw_tan,
+    kw_acos,
+    kw_asin,
+    kw_atan,
+    kw_ln,
+    kw_log,
+    kw_sqrt,
+    kw_mod,
+    kw_none
+  };
+
+  /**
+   * @brief Перечисление видов токенов.
+   */
+  enum TokenKind {
+    tk_number,   ///< Число
+    tk_keyword,  ///< Ключевое слово
+    tk_name,     ///< Имя переменной
+    tk_symbol,   ///< Одиночный символ (оператор, скобка или ошибочный символ)
+    tk_end       ///< Конец строки
+  };
+
+  /**
+   * @brief Токен выражения.
+   */
+  struct Token {
+    TokenKind kind;   ///< Вид токена.
+    Keyword keyword;  ///< Ключевое слово (для tk_keyword).
+    char symbol;      ///< Символ (для tk_symbol).
+    double value;     ///< Значение числа (для tk_number).
+    size_t position;  ///< Смещение начала токена в строке.
+    size_t length;    ///< Длина токена.
+  };
+
+  explicit Lexer(std::string_view input);
+
+  ~Lexer() = default;
+
+  ErrorCode Read(Token &token) noexcept;
+
+  Token Next();
+
+  size_t GetTokenPosition() const;
+
+  static ErrorCode ReadNumber(std::string_view input, size_t &position,
+                              double &number) noexcept;
+
+  static double ParseNumber(std::string_view input, size_t &position);
+
+  static std::string_view GetKeywordName(Keyword keyword);
+
+ private:
+  Keyword ParseWord(size_t &position) const noexcept;
+
+  std::string_view input_;  ///< Разбираемая строка.
+
+  size_t position_ = 0;  ///< Смещение первого непрочитанного символа.
+
+  size_t token_position_ = 0;  ///< Смещение начала последнего токена.
+};
+
+/**
+ * @brief Перевод латинской буквы в нижний регистр, остальные символы не
+ * меняются.
+ * @details Единое правило регистра для лексера, парсера и имен переменных:
+ * в отличие от tolower не зависит от локали, а в отличие от symbol | 0x20 не
+ * превращает в буквы другие символы ('@' в '`', '_' в DEL).
+ */
+inline char ToLower(char symbol) {
+  return symbol >= 'A' && symbol <= 'Z' ? static_cast<char>(symbol - 'A' + 'a')
+                                        : symbol;
+}
+
+/**
+ * @brief Сравнение имен без учета регистра латинских букв.
+ */
+inline bool IsSameName(std::string_view first, std::string_view second) {
+  return first.size() == second.size() &&
+         std::equal(first.begin(), first.end(), second.begin(),
+                    [](char a, char b) { return ToLower(a) == ToLower(b); });
+}
+
+}  // namespace s21
+
+#endif  // SMARTCALC_MODEL_LEXER_H_
@@ -0,0 +1,224 @@
+#include "mapped_column.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <exception>
+#include <new>
+
+namespace s21 {
+
+namespace {
+
+constexpr size_t kColumnWindow = 1 << 20;  ///< Количество чисел в окне
+                                           ///< обработки (8 МБ). Кратно
+                                           ///< размеру страницы, поэтому
+                                           ///< окна выровнены по страницам.
+
+constexpr size_t kColumnGrain = 16384;  ///< Количество чисел, вычисляемых
+                                        ///< одной задачей пула потоков.
+
+}  // namespace
+
+MappedColumn::~MappedColumn() { Close(); }
+
+/**
+ * @brief Отображение файла с числами для чтения.
+ * @param path Путь к файлу.
+ * @return err_column_file, если файл нельзя открыть или его размер не кратен
+ * sizeof(double).
+ */
+ErrorCode MappedColumn::OpenForReading(const std::string &path) {
+  Close();
+  file_ = open(path.c_str(), O_RDONLY);
+  struct stat status;
+  if (file_ < 0 || fstat(file_, &status) != 0 || status.st_size < 0 ||
+      status.st_size % sizeof(double) != 0) {
+    Close();
+    return err_column_file;
+  }
+  writable_ = false;
+  return Map(status.st_size / sizeof(double));
+}
+
+/**
+ * @brief Создание (или перезапись) файла под столбец и его отображение для
+ * записи.
+ * @param path Путь к файлу.
+ * @param count Количество чисел.
+ * @return err_column_file, если файл нельзя создать или увеличить.
+ */
+ErrorCode MappedColumn::CreateForWriting(const std::string &path,
+                                         size_t count) {
+  Close();
+  file_ = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (file_ < 0 || ftruncate(file_, count * sizeof(double)) != 0) {
+    Close();
+    return err_column_file;
+  }
+  writable_ = true;
+  return Map(count);
+}
+
+/**
+ * @brief Проверка, что путь указывает на файл этого столбца.
+ * @param path Путь к файлу.
+ * @details Нужна, чтобы не обрезать входной файл при записи результата в
+ * него же.
+ */
+bool MappedColumn::IsSameFile(const std::string &path) const {
+  struct stat own_status, path_status;
+  return file_ >= 0 && fstat(file_, &own_status) == 0 &&
+         stat(path.c_str(), &path_status) == 0 &&
+         own_status.st_dev == path_status.st_dev &&
+         own_status.st_ino == path_status.st_ino;
+}
+
+/**
+ * @brief Подсказка системе начать чтение чисел [begin, end) заранее.
+ */
+void MappedColumn::Prefetch(size_t begin, size_t end) const {
+  end = std::min(end, count_);
+  if (data_ != nullptr && begin < end) {
+    madvise(data_ + begin, (end - begin) * sizeof(double), MADV_WILLNEED);
+  }
+}
+
+/**
+ * @brief Асинхронный запуск записи на диск чисел [begin, end).
+ * @return err_column_file, если система отказала.
+ */
+ErrorCode MappedColumn::StartWriteback(size_t begin, size_t end) const {
+  end = std::min(end, count_);
+  if (!writable_ || data_ == nullptr || begin >= end) {
+    return err_none;
+  }
+  return msync(data_ + begin, (end - begin) * sizeof(double), MS_ASYNC) == 0
+             ? err_none
+             : err_column_file;
+}
+
+/**
+ * @brief Освобождение страниц с числами [begin, end).
+ * @return err_column_file, если запись на диск не удалась.
+ * @details Записываемый столбец сначала дописывается на диск синхронно, затем
+ * страницы отдаются системе: повторное обращение снова прочитает их из
+ * файла. begin должен быть выровнен по странице.
+ */
+ErrorCode MappedColumn::Release(size_t begin, size_t end) const {
+  end = std::min(end, count_);
+  if (data_ == nullptr || begin >= end) {
+    return err_none;
+  }
+  size_t bytes = (end - begin) * sizeof(double);
+  if (writable_ && msync(data_ + begin, bytes, MS_SYNC) != 0) {
+    return err_column_file;
+  }
+  madvise(data_ + begin, bytes, MADV_DONTNEED);
+  return err_none;
+}
+
+/**
+ * @brief Отображение открытого файла в память.
+ * @param count Количество чисел в файле.
+ */
+ErrorCode MappedColumn::Map(size_t count) {
+  count_ = count;
+  if (count == 0) {
+    return err_none;
+  }
+  void *data = mmap(nullptr, count * sizeof(double),
+                    writable_ ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED,
+                    file_, 0);
+  if (data == MAP_FAILED) {
+    Close();
+    return err_column_file;
+  }
+  data_ = static_cast<double *>(data);
+  madvise(data_, count * sizeof(double), MADV_SEQUENTIAL);
+  return err_none;
+}
+
+/**
+ * @brief Снятие отображения и закрытие файла.
+ */
+void MappedColumn::Close() {
+  if (data_ != nullptr) {
+    munmap(data_, count_ * sizeof(double));
+    data_ = nullptr;
+  }
+  if (file_ >= 0) {
+    close(file_);
+    file_ = -1;
+  }
+  count_ = 0;
+}
+
+/**
+ * @brief Вычисление выражения для каждого числа входного столбца с записью в
+ * выходной столбец.
+ * @param expression Скомпилированное выражение от икса.
+ * @param input_path Файл с иксами (массив double).
+ * @param output_path Файл для результатов, создается или перезаписывается.
+ * @param pool Пул потоков.
+ * @return Количество вычисленных значений или err_column_file.
+ * @details Столбцы обрабатываются окнами по kColumnWindow чисел: окно
+ * вычисляется задачами пула через пакетный Evaluate прямо из отображения
+ * входа в отображение выхода, без промежуточных буферов. Пока считается
+ * окно, система заранее читает следующее (MADV_WILLNEED); после окна
+ * запускается его запись на диск (MS_ASYNC), а предыдущее окно, запись
+ * которого к этому времени обычно закончена, освобождается в обоих файлах.
+ * Так в памяти одновременно живут около трех окон при любом размере файлов,
+ * а вычисление идет параллельно с вводом-выводом.
+ */
+Result<size_t> EvaluateColumn(const CompiledExpression &expression,
+                              const std::string &input_path,
+                              const std::string &output_path,
+                              ThreadPool &pool) noexcept {
+  MappedColumn input, output;
+  if (input.OpenForReading(input_path) != err_none ||
+      input.IsSameFile(output_path)) {
+    return err_column_file;
+  }
+  size_t count = input.GetCount();
+  if (output.CreateForWriting(output_path, count) != err_none) {
+    return err_column_file;
+  }
+  const double *x_values = input.GetData();
+  double *results = output.GetData();
+  size_t released = 0;
+  try {
+    for (size_t begin = 0; begin < count; begin += kColumnWindow) {
+      size_t end = std::min(count, begin + kColumnWindow);
+      input.Prefetch(end, end + kColumnWindow);
+      pool.ParallelFor(end - begin, kColumnGrain,
+                       [&](size_t block_begin, size_t block_end) {
+                         expression.Evaluate(x_values + begin + block_begin,
+                                             results + begin + block_begin,
+                                             block_end - block_begin);
+                       });
+      if (output.StartWriteback(begin, end) != err_none) {
+        return err_column_file;
+      }
+      input.Release(released, begin);
+      if (output.Release(released, begin) != err_none) {
+        return err_column_file;
+      }
+      released = begin;
+    }
+  } catch (const std::bad_alloc &ex) {
+    return err_out_of_memory;
+  } catch (const std::exception &ex) {
+    return err_system_resource;
+  }
+  input.Release(released, count);
+  if (output.Release(released, count) != err_none) {
+    return err_column_file;
+  }
+  return count;
+}
+
+}  // namespace s21
@@ -0,0 +1,73 @@
+#ifndef SMARTCALC_MODEL_MAPPED_COLUMN_H_
+#define SMARTCALC_MODEL_MAPPED_COLUMN_H_
+
+#include <cstddef>
+#include <string>
+
+#include "compiled_expression.h"
+#include "result.h"
+#include "thread_pool.h"
+
+namespace s21 {
+
+/**
+ * @brief Класс для столбца чисел double в файле, отображенного в память.
+ * @details Файл - плотный массив double в порядке байт машины, без
+ * заголовка. Отображение не читает файл целиком: страницы подгружаются при
+ * обращении, а Release возвращает их системе, поэтому резидентная память
+ * зависит от обрабатываемого окна, а не от размера файла.
+ */
+class MappedColumn {
+ public:
+  MappedColumn() = default;
+
+  MappedColumn(const MappedColumn &) = delete;
+
+  MappedColumn &operator=(const MappedColumn &) = delete;
+
+  ~MappedColumn();
+
+  ErrorCode OpenForReading(const std::string &path);
+
+  ErrorCode CreateForWriting(const std::string &path, size_t count);
+
+  /**
+   * @brief Функция-геттер, возвращающая начало столбца.
+   */
+  double *GetData() const { return data_; }
+
+  /**
+   * @brief Функция-геттер, возвращающая количество чисел в столбце.
+   */
+  size_t GetCount() const { return count_; }
+
+  bool IsSameFile(const std::string &path) const;
+
+  void Prefetch(size_t begin, size_t end) const;
+
+  ErrorCode StartWriteback(size_t begin, size_t end) const;
+
+  ErrorCode Release(size_t begin, size_t end) const;
+
+ private:
+  ErrorCode Map(size_t count);
+
+  void Close();
+
+  int file_ = -1;  ///< Дескриптор файла.
+
+  double *data_ = nullptr;  ///< Отображение файла (nullptr для пустого).
+
+  size_t count_ = 0;  ///< Количество чисел в столбце.
+
+  bool writable_ = false;  ///< Столбец открыт для записи.
+};
+
+Result<size_t> EvaluateColumn(const CompiledExpression &expression,
+                              const std::string &input_path,
+                              const std::string &output_path,
+                              ThreadPool &pool) noexcept;
+
+}  // namespace s21
+
+#endif  // SMARTCALC_MODEL_MAPPED_COLUMN_H_
@@ -1,597 +1,713 @@
 #include "model.h"
 
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <functional>
+#include <new>
+#include <thread>
+
+#include "expression_parser.h"
+#include "lexer.h"
+
 namespace s21 {
 
-PolishNotation::~PolishNotation() { ClearAll(); }
+namespace {
+
+/**
+ * @brief Проверка, что в выражении нет переменных, кроме икса.
+ * @param expression Скомпилированное выражение.
+ */
+bool DependsOnlyOnX(const CompiledExpression &expression) {
+  const std::vector<std::string> &variables = expression.GetVariables();
+  return variables.empty() || (variables.size() == 1 && variables[0] == "x");
+}
+
+/**
+ * @brief Рабочее пространство разбора своего потока.
+ */
+ExpressionParser &GetParser() {
+  thread_local ExpressionParser parser;
+  return parser;
+}
+
+}  // namespace
 
 /**
  * @brief Основная функция для вычисления.
  * @param input_expression Строка с выражением.
  * @param x_value Строка, содержащая значение икса.
  * @throw std::invalid_argument В случае некорректности строки.
- * @details Подготовка, парсинг, обработка и вычисление выражения.
+ * @return Число - результат вычисления.
+ * @details Выражение компилируется и вычисляется для значения икса.
  */
-void PolishNotation::Calculate(std::string &input_expression,
-                               std::string &x_value) {
-  try {
-    ToLowerCase(input_expression);
-    ParseExpression(input_expression);
-    if (x_is_found) {
-      x = ParseX(x_value);
-    }
-    LexemasProcessing();
-    FinalCalculations();
-  } catch (const std::exception &ex) {
-    ClearAll();
-    throw;
-  }
+double PolishNotation::Calculate(const std::string &input_expression,
+                                 const std::string &x_value) const {
+  return TryCalculate(input_expression, x_value).GetValueOrThrow();
 }
 
 /**
- * @brief Функция-геттер, возвращающая результат вычисления.
+ * @brief Вычисление уже скомпилированного выражения.
+ * @param expression Скомпилированное выражение.
+ * @param x_value Строка, содержащая значение икса.
+ * @throw std::invalid_argument В случае некорректности значения икса.
  * @return Число - результат вычисления.
  */
-double PolishNotation::GetAnswer() const { return final_answer; }
+double PolishNotation::Calculate(const CompiledExpression &expression,
+                                 const std::string &x_value) const {
+  return TryCalculate(expression, x_value).GetValueOrThrow();
+}
 
 /**
- * @brief Конструктор.
- * @param name Строка, содержащая данную лексему.
- * @param type Тип лексемы.
- * @param group Группа лексемы.
- * @param prior Приоритет лексемы.
- * @param functiion Функция или число, соответствующая лексеме.
+ * @brief Компиляция выражения для последующего многократного вычисления.
+ * @param input_expression Строка с выражением.
+ * @throw std::invalid_argument В случае некорректности строки.
+ * @return Скомпилированное выражение.
  */
-PolishNotation::Lexema::Lexema(const std::string &name, Type type, Group group,
-                               int prior, function_variant function)
-    : name_(name),
-      type_(type),
-      group_(group),
-      priority_(prior),
-      function_(function) {}
+CompiledExpression PolishNotation::Compile(
+    const std::string &input_expression) const {
+  return TryCompile(input_expression).GetValueOrThrow();
+}
 
 /**
- * @brief Функиця-геттер, возвращающая тип лексемы.
+ * @brief Вычисление выражения без исключений.
+ * @param input_expression Строка с выражением.
+ * @param x_value Строка, содержащая значение икса.
+ * @return Результат вычисления или ошибка с кодом и позицией в строке.
  */
-PolishNotation::Type PolishNotation::Lexema::GetType() const { return type_; }
+Result<double> PolishNotation::TryCalculate(
+    const std::string &input_expression,
+    const std::string &x_value) const noexcept {
+  Result<CompiledExpression> expression = TryCompile(input_expression);
+  if (!expression) {
+    return expression.GetError();
+  }
+  return TryCalculate(expression.GetValue(), x_value);
+}
 
 /**
- * @brief Функиця-геттер, возвращающая группу лексемы.
+ * @brief Вычисление уже скомпилированного выражения без исключений.
+ * @param expression Скомпилированное выражение.
+ * @param x_value Строка, содержащая значение икса.
+ * @return Результат вычисления или ошибка значения икса. Если в выражении
+ * есть переменные, кроме икса, возвращается err_unbound_variable: их значения
+ * передаются в CompiledExpression::Evaluate.
  */
-PolishNotation::Group PolishNotation::Lexema::GetGroup() const {
-  return group_;
+Result<double> PolishNotation::TryCalculate(
+    const CompiledExpression &expression,
+    const std::string &x_value) const noexcept {
+  Result<double> answer = EvaluateAt(expression, x_value);
+  if (answer) {
+    final_answer.store(answer.GetValue(), std::memory_order_relaxed);
+  }
+  return answer;
 }
 
 /**
- * @brief Функиця-геттер, возвращающая приоритет лексемы.
- * @return Тип лексемы (число от 1 до 4).
+ * @brief Вычисление многих независимых выражений без исключений.
+ * @param input_expressions Массив из count строк с выражениями.
+ * @param x_values Массив из count строк со значениями икса (nullptr, если
+ * иксы не заданы).
+ * @param count Количество выражений.
+ * @param results Массив из count результатов, заполняется значением или
+ * ошибкой для каждого выражения.
+ * @details Выражения делятся на блоки по kLinesGrain, блоки вычисляются в
+ * пуле потоков. Внутри блока одинаковые выражения компилируются один раз:
+ * у задачи есть маленькая таблица с прямым отображением по хэшу текста
+ * (kLinesMemoSize записей), так что повторяющиеся формулы и таблицы
+ * значений одной формулы не разбираются заново на каждой строке. Кэш
+ * контроллера и JIT здесь не используются: общий мьютекс кэша стал бы
+ * узким местом, а машинный код не окупается на нескольких строках.
+ * Нехватка памяти помечается err_out_of_memory только в строках, которые
+ * не успели вычислиться, результаты остальных строк и блоков сохраняются.
+ * Если не удалось запустить потоки пула, все строки получают
+ * err_system_resource.
+ * GetAnswer не обновляется.
  */
-int PolishNotation::Lexema::GetPrioroty() const { return priority_; }
+void PolishNotation::TryCalculateMany(const std::string_view *input_expressions,
+                                      const std::string_view *x_values,
+                                      size_t count,
+                                      Result<double> *results) const noexcept {
+  struct MemoEntry {
+    bool filled = false;
+    std::string_view input;
+    Result<CompiledExpression> expression = err_empty_input;
+  };
+  std::fill(results, results + count, Result<double>(err_out_of_memory));
+  auto calculate = [&](size_t begin, size_t end) {
+    try {
+      std::vector<MemoEntry> memo(kLinesMemoSize);
+      for (size_t i = begin; i < end; ++i) {
+        std::string_view input = input_expressions[i];
+        MemoEntry &entry =
+            memo[std::hash<std::string_view>()(input) % kLinesMemoSize];
+        if (!entry.filled || entry.input != input) {
+          entry.filled = true;
+          entry.input = input;
+          entry.expression = GetParser().Compile(input);
+        }
+        if (!entry.expression) {
+          results[i] = entry.expression.GetError();
+        } else {
+          results[i] = EvaluateAt(entry.expression.GetValue(),
+                                  x_values ? x_values[i] : std::string_view());
+        }
+      }
+    } catch (const std::bad_alloc &ex) {
+      // Невычисленные строки блока остаются с err_out_of_memory.
+    }
+  };
+  try {
+    GetThreadPool()->ParallelFor(count, kLinesGrain, calculate);
+  } catch (const std::bad_alloc &ex) {
+    // Не удалось создать пул или поставить блок в очередь. ParallelFor
+    // дожидается уже поставленных блоков, строки остальных остаются с
+    // err_out_of_memory.
+  } catch (const std::exception &ex) {
+    // Система не дала запустить потоки пула (ParallelFor бросает только
+    // std::bad_alloc), поэтому ни одна строка не вычислена.
+    std::fill(results, results + count, Result<double>(err_system_resource));
+  }
+}
 
 /**
- * @brief Функиця-геттер, возвращающая соответствующую лексеме функцию.
- * @return Ссылка на функцию либо лямбда-выражение.
+ * @brief Компиляция выражения без исключений.
+ * @param input_expression Строка с выражением.
+ * @return Скомпилированное выражение или ошибка с кодом и позицией в строке.
+ * @details Разбор идет в рабочем пространстве (ExpressionParser) своего
+ * потока, поэтому компилировать можно из нескольких потоков одновременно.
  */
-auto PolishNotation::Lexema::GetFunction() const { return function_; }
+Result<CompiledExpression> PolishNotation::TryCompile(
+    const std::string &input_expression) const noexcept {
+  Result<CompiledExpression> expression = GetParser().Compile(input_expression);
+  if (expression) {
+    try {
+      expression.GetValue().SetJitMode(
+          jit_mode_.load(std::memory_order_relaxed));
+    } catch (const std::bad_alloc &ex) {
+      return err_out_of_memory;
+    }
+  }
+  return expression;
+}
 
 /**
- * @brief Функция-геттер, возвращающая строку с лексемой.
+ * @brief Символьное дифференцирование выражения.
+ * @param input_expression Строка с выражением.
+ * @param variable Имя переменной дифференцирования.
+ * @param order Порядок производной.
+ * @throw std::invalid_argument В случае некорректности строки.
+ * @return Строка с производной.
  */
-std::string PolishNotation::Lexema::GetName() const { return name_; }
+std::string PolishNotation::Differentiate(const std::string &input_expression,
+                                          const std::string &variable,
+                                          size_t order) const {
+  return TryDifferentiate(input_expression, variable, order)
+      .GetValueOrThrow();
+}
 
 /**
- * @brief Перевод строки в нижний регистр.
+ * @brief Символьное дифференцирование выражения без исключений.
+ * @param input_expression Строка с выражением.
+ * @param variable Имя переменной дифференцирования.
+ * @param order Порядок производной (ноль возвращает выражение без
+ * изменений).
+ * @return Строка с упрощенной производной, которую можно компилировать как
+ * обычное выражение, или ошибка с позицией в исходной строке.
+ * @details Производные высших порядков получаются повторным
+ * дифференцированием строки предыдущей производной.
  */
-void PolishNotation::ToLowerCase(std::string &input_expression) {
-  std::transform(input_expression.begin(), input_expression.end(),
-                 input_expression.begin(), ::tolower);
+Result<std::string> PolishNotation::TryDifferentiate(
+    const std::string &input_expression, const std::string &variable,
+    size_t order) const noexcept {
+  try {
+    std::string derivative = input_expression;
+    for (size_t i = 0; i < order; ++i) {
+      Result<std::string> result =
+          GetParser().Differentiate(derivative, variable);
+      if (!result) {
+        return result;
+      }
+      derivative = std::move(result).GetValue();
+    }
+    return derivative;
+  } catch (const std::bad_alloc &ex) {
+    return err_out_of_memory;
+  }
 }
 
 /**
- * @brief Функция для разбивки выражения на лексемы и их валидации.
+ * @brief Приведение выражения к каноническому виду для кэширования.
  * @param input_expression Строка с выражением.
+ * @return Строка, которая компилируется в то же выражение: без лишних
+ * пробелов, в нижнем регистре, с числами в кратчайшей точной записи (например,
+ * "2.50" и "25e-1" дают "2.5").
+ * @details Пробел сохраняется только между словами и числами, которые в
+ * исходной строке были разделены пробелом. Если строку не удается разбить на
+ * токены, она возвращается без изменений, чтобы компиляция сообщила об ошибке
+ * как обычно.
  */
-void PolishNotation::ParseExpression(std::string &input_expression) {
-  std::string::iterator iter_expression = input_expression.begin();
-  int brackets_count = 0;
-
-  if (input_expression.empty()) {
-    throw std::invalid_argument("Empty input");
-  }
-
-  while (iter_expression < input_expression.end()) {
-    if (*iter_expression == ' ') {
-      ++iter_expression;
-    } else if (isdigit(*iter_expression)) {
-      double num = ParseNumber(iter_expression);
-      PushNumberToDeque(num);
-    } else if (*iter_expression == 'x') {
-      PushXToDeque();
-      x_is_found = true;
-      ++iter_expression;
-    } else if (isalpha(*iter_expression)) {
-      ParseLetter(iter_expression);
+std::string PolishNotation::Normalize(
+    const std::string &input_expression) const {
+  std::string result;
+  result.reserve(input_expression.size());
+  Lexer lexer(input_expression);
+  size_t previous_end = 0;
+  Lexer::Token token;
+  ErrorCode code = err_none;
+  while ((code = lexer.Read(token)) == err_none &&
+         token.kind != Lexer::tk_end) {
+    if (token.kind != Lexer::tk_symbol && token.position != previous_end &&
+        !result.empty() && isalnum(result.back())) {
+      result += ' ';
+    }
+    if (token.kind == Lexer::tk_number) {
+      char buffer[32];
+      result.append(
+          buffer,
+          std::to_chars(buffer, buffer + sizeof(buffer), token.value).ptr);
+    } else if (token.kind == Lexer::tk_keyword) {
+      result += Lexer::GetKeywordName(token.keyword);
+    } else if (token.kind == Lexer::tk_name) {
+      std::string_view name(input_expression);
+      for (char symbol : name.substr(token.position, token.length)) {
+        result += ToLower(symbol);
+      }
     } else {
-      ParseSymbol(iter_expression, brackets_count);
+      result += token.symbol;
     }
+    previous_end = token.position + token.length;
+  }
+  if (code != err_none) {
+    return input_expression;
   }
-  ValidateParsedLexemas(brackets_count);
+  return result;
 }
 
 /**
- * @brief Лексема (число) кладется в очередь с распаршенными лексемами.
- * @param number Число.
+ * @brief Вычисление выражения для столбца иксов из файла.
+ * @param input_expression Строка с выражением от икса.
+ * @param input_path Файл с иксами (плотный массив double).
+ * @param output_path Файл для результатов (создается или перезаписывается).
+ * @return Количество вычисленных значений.
+ * @throw std::invalid_argument В случае некорректности строки, переменных,
+ * кроме икса, или ошибки файлов.
  */
-void PolishNotation::PushNumberToDeque(double number) {
-  parsed_lexemas_.push_back(
-      Lexema(std::to_string(number), t_number, g_number, 0, number));
+size_t PolishNotation::EvaluateColumn(const std::string &input_expression,
+                                      const std::string &input_path,
+                                      const std::string &output_path) const {
+  return TryEvaluateColumn(Compile(input_expression), input_path, output_path)
+      .GetValueOrThrow();
 }
 
 /**
- * @brief Икс кладется в очередь с распаршенными лексемами.
+ * @brief Вычисление скомпилированного выражения для столбца иксов из файла
+ * без исключений.
+ * @param expression Скомпилированное выражение от икса.
+ * @param input_path Файл с иксами (плотный массив double).
+ * @param output_path Файл для результатов (создается или перезаписывается).
+ * @return Количество вычисленных значений или ошибка.
+ * @details Оба файла отображаются в память и обрабатываются окнами в пуле
+ * потоков, поэтому размер файлов ограничен только диском. Нехватка памяти
+ * возвращается как err_out_of_memory, другие отказы системы (например, при
+ * запуске потоков) - как err_system_resource.
  */
-void PolishNotation::PushXToDeque() {
-  parsed_lexemas_.push_back(Lexema("x", t_x, g_number, 0, nullptr));
+Result<size_t> PolishNotation::TryEvaluateColumn(
+    const CompiledExpression &expression, const std::string &input_path,
+    const std::string &output_path) const noexcept {
+  if (!DependsOnlyOnX(expression)) {
+    return err_unbound_variable;
+  }
+  std::shared_ptr<ThreadPool> pool;
+  try {
+    pool = GetThreadPool();
+  } catch (const std::bad_alloc &ex) {
+    return err_out_of_memory;
+  } catch (const std::exception &ex) {
+    return err_system_resource;
+  }
+  return s21::EvaluateColumn(expression, input_path, output_path, *pool);
 }
 
 /**
- * @brief Парсинг числа: число вычленяется из строки с выражением и кладется в
- * очередь с лексемами.
- * @param iter Итератор в строке с выражением, указывающий на начало числа.
- * @return Значение найденного числа.
+ * @brief Вычисление скомпилированного выражения в заданном иксе.
+ * @param expression Скомпилированное выражение.
+ * @param x_value Строка со значением икса (разбирается, только если икс есть
+ * в выражении).
+ * @return Результат вычисления или ошибка значения икса.
  */
-double PolishNotation::ParseNumber(std::string::iterator &iter) {
-  std::string number_str;
-  if (*iter == '-' || *iter == '+') {
-    number_str += *iter;
-    iter++;
+Result<double> PolishNotation::EvaluateAt(
+    const CompiledExpression &expression,
+    std::string_view x_value) const noexcept {
+  if (!DependsOnlyOnX(expression)) {
+    return err_unbound_variable;
   }
-  int dot_check = 0;
-  int e_check = 0;
-  int sign_check = 0;
-  for (; isdigit(*iter) || *iter == '.' || *iter == 'e' || *iter == '-' ||
-         *iter == '+';
-       ++iter) {
-    if (isdigit(*iter)) {
-      number_str += *iter;
-    } else if (*iter == '.' && !dot_check && *(iter - 1) != 'e') {
-      number_str += *iter;
-      dot_check = 1;
-    } else if (*iter == 'e' && !e_check) {
-      number_str += *iter;
-      e_check = 1;
-    } else if ((*iter == '+' || *iter == '-') && *(iter - 1) == 'e' &&
-               !sign_check) {
-      number_str += *iter;
-      sign_check = 1;
-    } else if (*iter == '+' || *iter == '-') {
-      break;
-    } else {
-      throw std::invalid_argument("Incorrect number");
+  double x = 0;
+  if (expression.UsesX()) {
+    Result<double> parsed_x = ParseX(x_value);
+    if (!parsed_x) {
+      return parsed_x;
     }
+    x = parsed_x.GetValue();
   }
-  if (*(iter - 1) == 'e' || *(iter - 1) == '-' || *(iter - 1) == '+' ||
-      *(iter - 1) == '.') {
-    throw std::invalid_argument("Incorrect number");
-  }
-  return std::stod(number_str);
+  return expression.Evaluate(x);
 }
 
 /**
- * @brief Кастомное сравнение двух строк для проверки, содержится ли функция в
- * строке-выражении по указанному итератором адресу.
- * @param iter Итератор в строке с выражением.
- * @param str Строка для сравнения (название искомой функции).
- * @return Результат сравнения: true или false
+ * @brief Функция-геттер, возвращающая результат последнего вычисления.
+ * @return Число - результат вычисления.
+ * @details Оставлена для совместимости: при вычислениях из нескольких потоков
+ * нужно использовать значение, которое возвращает Calculate.
  */
-bool PolishNotation::CompareIterToStr(std::string::iterator &iter,
-                                      const std::string &str) {
-  std::string::iterator iter_copy = iter;
-  bool result = true;
-  for (size_t i = 0; i < str.size(); ++i, ++iter) {
-    if (*iter != str[i]) {
-      result = false;
-      iter = iter_copy;
-      break;
-    }
-  }
-  return result;
+double PolishNotation::GetAnswer() const {
+  return final_answer.load(std::memory_order_relaxed);
 }
 
 /**
- * @brief Поиск лексемы (функции или опертора) по типу в словаре lexema_map_
- * @param type Тип искомой лексемы.
- * @return Лексема.
+ * @brief Парсинг и валидация значения икса.
+ * @param x_value Строка со значением икса.
+ * @return Значение икс или ошибка.
  */
-PolishNotation::Lexema PolishNotation::FindLexemaInMap(Type type) {
-  auto lexema_iter = lexema_map_.find(type);
-  if (lexema_iter == lexema_map_.end()) {
-    throw std::invalid_argument("Operator is not maintained");
+Result<double> PolishNotation::ParseX(std::string_view x_value) const noexcept {
+  if (x_value.empty()) {
+    return err_empty_x;
   }
-  return lexema_iter->second;
+  size_t position = 0;
+  double result = 0;
+  if (Lexer::ReadNumber(x_value, position, result) != err_none ||
+      position != x_value.size()) {
+    return err_invalid_x;
+  }
+  return result;
 }
 
 /**
- * @brief Лексема (функция или оператор) кладется в очередь с распаршенными
- * лексемами.
- * @param type Тип лексемы.
+ * @brief Вычисление значений для построения графика по строке.
+ * @throw std::invalid_argument В случае некорректности строки или границ.
  */
-void PolishNotation::PushOperatorToDeque(Type type) {
-  parsed_lexemas_.push_back(FindLexemaInMap(type));
+void PolishNotation::GetGraph(const std::string &input_expression,
+                              double x_min, double x_max,
+                              std::vector<double> &x_data,
+                              std::vector<double> &y_data,
+                              size_t points_count) const {
+  GetGraph(Compile(input_expression), x_min, x_max, x_data, y_data,
+           points_count);
 }
 
 /**
- * @brief Парсинг функции: функция вычленяется из строки с выражением и
- * кладется в очередь с лексемами.
- * @param iter Итератор в строке с выражением, указывающий на начало функции.
+ * @brief Вычисление значений для построения графика.
+ * @param expression Скомпилированное выражение.
+ * @param x_min Нижняя граница области определения графика.
+ * @param x_max Верхняя граница области определения графика.
+ * @param x_data Вектор для значений X.
+ * @param y_data Вектор для значений Y.
+ * @param points_count Количество точек графика (не меньше двух).
+ * @throw std::invalid_argument В случае некорректности границ или если в
+ * выражении есть переменные, кроме x.
+ * @details Диапазон иксов делится на куски, которые пакетно вычисляются в
+ * пуле потоков и записываются прямо в x_data и y_data.
  */
-void PolishNotation::ParseLetter(std::string::iterator &iter) {
-  Type result = t_none;
-  switch (*iter) {
-    case 'c': {
-      if (CompareIterToStr(iter, "cos")) {
-        result = t_cos;
-      }
-      break;
-    }
-
-    case 's': {
-      if (CompareIterToStr(iter, "sin")) {
-        result = t_sin;
-      } else if (CompareIterToStr(iter, "sqrt")) {
-        result = t_sqrt;
-      }
-      break;
-    }
-
-    case 't': {
-      if (CompareIterToStr(iter, "tan")) {
-        result = t_tan;
-      }
-      break;
-    }
-
-    case 'a': {
-      if (CompareIterToStr(iter, "acos")) {
-        result = t_acos;
-      } else if (CompareIterToStr(iter, "asin")) {
-        result = t_asin;
-      } else if (CompareIterToStr(iter, "atan")) {
-        result = t_atan;
-      }
-      break;
-    }
-
-    case 'l': {
-      if (CompareIterToStr(iter, "ln")) {
-        result = t_ln;
-      } else if (CompareIterToStr(iter, "log")) {
-        result = t_log;
-      }
-      break;
-    }
-
-    case 'm': {
-      if (CompareIterToStr(iter, "mod")) {
-        result = t_mod;
-      }
-      break;
-    }
-
-    default: {
-      throw std::invalid_argument("Incorrect input");
-    }
+void PolishNotation::GetGraph(const CompiledExpression &expression,
+                              double x_min, double x_max,
+                              std::vector<double> &x_data,
+                              std::vector<double> &y_data,
+                              size_t points_count) const {
+  if (x_max <= x_min || points_count < 2) {
+    CalculationError{err_incorrect_borders}.Throw();
   }
-  if (result == t_none) {
-    throw std::invalid_argument("Incorrect input");
+  if (!DependsOnlyOnX(expression)) {
+    CalculationError{err_unbound_variable}.Throw();
   }
-  PushOperatorToDeque(result);
+  double step = (x_max - x_min) / (points_count - 1);
+  x_data.resize(points_count);
+  y_data.resize(points_count);
+  GetThreadPool()->ParallelFor(
+      points_count, kGraphGrain, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          x_data[i] = x_min + step * i;
+        }
+        expression.Evaluate(x_data.data() + begin, y_data.data() + begin,
+                            end - begin);
+      });
 }
 
 /**
- * @brief Определение, является ли оператор унарным.
- * @return Результат определения: true - если оператор унарный, false - если
- * не унарный.
+ * @brief Вычисление значений и производных для графиков по строке.
+ * @throw std::invalid_argument В случае некорректности строки или границ.
  */
-bool PolishNotation::IsUnary() {
-  if (parsed_lexemas_.empty() ||
-      parsed_lexemas_.back().GetType() == t_opening_br) {
-    return true;
-  }
-  return false;
+void PolishNotation::GetDerivativeGraph(const std::string &input_expression,
+                                        double x_min, double x_max,
+                                        std::vector<double> &x_data,
+                                        std::vector<double> &y_data,
+                                        std::vector<double> &dy_data,
+                                        size_t points_count) const {
+  GetDerivativeGraph(Compile(input_expression), x_min, x_max, x_data, y_data,
+                     dy_data, points_count);
 }
 
 /**
- * @brief Парсинг оператора: оператор вычленяется из строки с выражением и
- * кладется в очередь с лексемами.
- * @param iter Итератор в строке с выражением, указывающий на символ
- * оператора.
+ * @brief Вычисление значений и производных для построения графиков функции и
+ * ее производной.
+ * @param expression Скомпилированное выражение.
+ * @param x_min Нижняя граница области определения графика.
+ * @param x_max Верхняя граница области определения графика.
+ * @param x_data Вектор для значений X.
+ * @param y_data Вектор для значений Y.
+ * @param dy_data Вектор для значений производной dY/dX.
+ * @param points_count Количество точек графика (не меньше двух).
+ * @throw std::invalid_argument В случае некорректности границ или если в
+ * выражении есть переменные, кроме x.
+ * @details Производная вычисляется автоматическим дифференцированием вместе
+ * со значением, поэтому не зависит от шага сетки, как конечные разности.
  */
-void PolishNotation::ParseSymbol(std::string::iterator &iter,
-                                 int &brackets_count) {
-  Type result = t_none;
-  switch (*iter) {
-    case '+': {
-      if (IsUnary()) {
-        PushNumberToDeque(0);
-      }
-      result = t_plus;
-      break;
-    }
-    case '-': {
-      if (IsUnary()) {
-        PushNumberToDeque(0);
-      }
-      result = t_minus;
-      break;
-    }
-    case '*': {
-      result = t_mult;
-      break;
-    }
-    case '/': {
-      result = t_div;
-      break;
-    }
-    case '^': {
-      result = t_pow;
-      break;
-    }
-    case '(': {
-      result = t_opening_br;
-      ++brackets_count;
-      break;
-    }
-    case ')': {
-      result = t_closing_br;
-      --brackets_count;
-      break;
-    }
-    default: {
-      throw std::invalid_argument("Incorrect symbol in input expression");
-    }
+void PolishNotation::GetDerivativeGraph(const CompiledExpression &expression,
+                                        double x_min, double x_max,
+                                        std::vector<double> &x_data,
+                                        std::vector<double> &y_data,
+                                        std::vector<double> &dy_data,
+                                        size_t points_count) const {
+  if (x_max <= x_min || points_count < 2) {
+    CalculationError{err_incorrect_borders}.Throw();
   }
-  if (result == t_none) {
-    throw std::invalid_argument("Incorrect symbol in input expression");
+  if (!DependsOnlyOnX(expression)) {
+    CalculationError{err_unbound_variable}.Throw();
   }
-  iter++;
-  PushOperatorToDeque(result);
+  double step = (x_max - x_min) / (points_count - 1);
+  x_data.resize(points_count);
+  y_data.resize(points_count);
+  dy_data.resize(points_count);
+  GetThreadPool()->ParallelFor(
+      points_count, kGraphGrain, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          x_data[i] = x_min + step * i;
+        }
+        expression.EvaluateDerivative(x_data.data() + begin,
+                                      y_data.data() + begin,
+                                      dy_data.data() + begin, nullptr,
+                                      end - begin);
+      });
 }
 
 /**
- * @brief Парсинг и валидация значения икса.
- * @param iter Строка со значением икса.
- * @return Значение икс.
+ * @brief Адаптивное вычисление значений для построения графика по строке.
+ * @throw std::invalid_argument В случае некорректности строки или границ.
  */
-double PolishNotation::ParseX(std::string &x_value) {
-  if (x_value.empty()) {
-    throw std::invalid_argument("X value is empty");
-  }
-  ToLowerCase(x_value);
-  std::string::iterator x_iter = x_value.begin();
-  double result;
-  try {
-    result = ParseNumber(x_iter);
-  } catch (const std::invalid_argument &ex) {
-    throw std::invalid_argument("Invalid X value");
-  }
-  if (x_iter != x_value.end()) {
-    throw std::invalid_argument("Invalid X value");
-  }
-  return result;
+void PolishNotation::GetAdaptiveGraph(const std::string &input_expression,
+                                      double x_min, double x_max,
+                                      const AdaptiveSampling &settings,
+                                      std::vector<double> &x_data,
+                                      std::vector<double> &y_data) const {
+  GetAdaptiveGraph(Compile(input_expression), x_min, x_max, settings, x_data,
+                   y_data);
 }
 
 /**
- * @brief Проверка корректности первой лексемы в очереди.
+ * @brief Адаптивное вычисление значений для построения графика.
+ * @param expression Скомпилированное выражение.
+ * @param x_min Нижняя граница области определения графика.
+ * @param x_max Верхняя граница области определения графика.
+ * @param settings Бюджет точек и допустимая погрешность в пикселях.
+ * @param x_data Вектор для значений X.
+ * @param y_data Вектор для значений Y.
+ * @throw std::invalid_argument В случае некорректности границ или если в
+ * выражении есть переменные, кроме x.
+ * @details Точки сгущаются там, где кривая отклоняется от ломаной больше чем
+ * на допустимую погрешность, и у разрывов.
  */
-void PolishNotation::ValidateFirstLexema() {
-  auto first_lexema = parsed_lexemas_.front();
-  auto first_group = first_lexema.GetGroup();
-  auto first_type = first_lexema.GetType();
-  if (first_group == g_closing_br ||
-      (first_group == g_binary_op && first_type != t_minus &&
-       first_type != t_plus)) {
-    throw std::invalid_argument("Incorrect input");
+void PolishNotation::GetAdaptiveGraph(const CompiledExpression &expression,
+                                      double x_min, double x_max,
+                                      const AdaptiveSampling &settings,
+                                      std::vector<double> &x_data,
+                                      std::vector<double> &y_data) const {
+  if (x_max <= x_min) {
+    CalculationError{err_incorrect_borders}.Throw();
   }
+  if (!DependsOnlyOnX(expression)) {
+    CalculationError{err_unbound_variable}.Throw();
+  }
+  SampleAdaptively(expression, x_min, x_max, settings, x_data, y_data);
 }
 
 /**
- * @brief Проверка корректности последней лексемы в очереди.
+ * @brief Автоматические границы по Y для графика по строке.
+ * @throw std::invalid_argument В случае некорректности строки или границ.
  */
-void PolishNotation::ValidateLastLexema() {
-  auto last_lexema = parsed_lexemas_.back();
-  auto last_group = last_lexema.GetGroup();
-  if (last_group == g_binary_op || last_group == g_opening_br ||
-      last_group == g_function) {
-    throw std::invalid_argument("Incorrect input");
-  }
+Interval PolishNotation::GetGraphRange(const std::string &input_expression,
+                                       double x_min, double x_max) const {
+  return GetGraphRange(Compile(input_expression), x_min, x_max);
 }
 
 /**
- * @brief Проверка корректности последовательности всех лексем.
- * @param brackets_count Количество встреченных в выражении скобок (и
- * открывающих, и закрывающих).
+ * @brief Автоматические границы по Y для графика.
+ * @param expression Скомпилированное выражение.
+ * @param x_min Нижняя граница области определения графика.
+ * @param x_max Верхняя граница области определения графика.
+ * @return Отрезок, гарантированно содержащий значения функции на области
+ * определения (кроме окрестностей полюсов), или пустой отрезок, если функция
+ * нигде не определена.
+ * @throw std::invalid_argument В случае некорректности границ или если в
+ * выражении есть переменные, кроме x.
  */
-void PolishNotation::ValidateParsedLexemas(int brackets_count) {
-  ValidateFirstLexema();
-  ValidateLastLexema();
-  if (brackets_count != 0) {
-    throw std::invalid_argument("Incorrect use of brackets");
+Interval PolishNotation::GetGraphRange(const CompiledExpression &expression,
+                                       double x_min, double x_max) const {
+  if (!(x_max > x_min)) {
+    CalculationError{err_incorrect_borders}.Throw();
   }
-
-  std::deque<Lexema>::iterator lex_iter = parsed_lexemas_.begin();
-  for (; lex_iter + 1 != parsed_lexemas_.end(); ++lex_iter) {
-    if (!ValidityMatrix[lex_iter->GetGroup()][(lex_iter + 1)->GetGroup()]) {
-      throw std::invalid_argument("Incorrect input");
-    }
+  if (!DependsOnlyOnX(expression)) {
+    CalculationError{err_unbound_variable}.Throw();
   }
+  return EncloseGraph(expression, x_min, x_max);
 }
 
 /**
- * @brief Цикл для обработки лексем из очереди после парсинга.
- * @details Лексемы по одной извлекаются из начала очереди parsed_lexemas_ и
- * складываются по стекам (stack_of_numbers_ для чисел и stack_of_operators_ для
- * стального). Если приоритет лексемы на верхушке стэка stack_of_operators_ выше
- * приоритета текущей (вытолкнутой из очереди) лексемы, лежащие в стэке лексемы
- * будут выталкиваться и будут производиться соответствующие вычисления.
- */
-void PolishNotation::LexemasProcessing() {
-  while (!parsed_lexemas_.empty()) {
-    Lexema current_lexema = parsed_lexemas_.front();
-    parsed_lexemas_.pop_front();
-
-    if (current_lexema.GetGroup() == g_number) {
-      stack_of_numbers_.push(current_lexema);
-    } else if (current_lexema.GetGroup() == g_closing_br) {
-      ClosingBracketProcessing();
-    } else if (current_lexema.GetGroup() == g_opening_br) {
-      stack_of_operators_.push(current_lexema);
-    } else if (stack_of_operators_.empty() ||
-               current_lexema.GetPrioroty() >
-                   stack_of_operators_.top().GetPrioroty()) {
-      stack_of_operators_.push(current_lexema);
-    } else {
-      while (!stack_of_operators_.empty() &&
-             current_lexema.GetPrioroty() <=
-                 stack_of_operators_.top().GetPrioroty()) {
-        Lexema prev_lex = GetOperationFromStack();
-        MakeOperation(prev_lex);
-      }
-      stack_of_operators_.push(current_lexema);
-    }
-  }
+ * @brief Поиск корней и локальных экстремумов функции, заданной строкой.
+ * @throw std::invalid_argument В случае некорректности строки или границ.
+ */
+std::vector<CriticalPoint> PolishNotation::FindCriticalPoints(
+    const std::string &input_expression, double x_min, double x_max,
+    const RootSearch &settings) const {
+  return FindCriticalPoints(Compile(input_expression), x_min, x_max,
+                            settings);
 }
 
 /**
- * @brief Извлечение числа с верхушки стэка с числами stack_of_numbers_.
- * @return Число.
+ * @brief Поиск корней и локальных экстремумов функции на отрезке.
+ * @param expression Скомпилированное выражение.
+ * @param x_min Нижняя граница отрезка.
+ * @param x_max Верхняя граница отрезка.
+ * @param settings Размер сетки сканирования и допустимая ошибка.
+ * @return Корни и экстремумы по возрастанию X.
+ * @throw std::invalid_argument В случае некорректности границ или если в
+ * выражении есть переменные, кроме x.
+ * @details Сканирование и уточнение идут в пуле потоков.
  */
-double PolishNotation::GetNumberFromStack() {
-  if (stack_of_numbers_.empty()) {
-    throw std::invalid_argument("Incorrect input");
+std::vector<CriticalPoint> PolishNotation::FindCriticalPoints(
+    const CompiledExpression &expression, double x_min, double x_max,
+    const RootSearch &settings) const {
+  if (!(x_max > x_min)) {
+    CalculationError{err_incorrect_borders}.Throw();
   }
-  auto top_lexema = stack_of_numbers_.top();
-  stack_of_numbers_.pop();
-
-  double number;
-  if (top_lexema.GetType() == t_number) {
-    number = std::get<double>(top_lexema.GetFunction());
-  } else if (top_lexema.GetType() == t_x) {
-    number = x;
+  if (!DependsOnlyOnX(expression)) {
+    CalculationError{err_unbound_variable}.Throw();
   }
-  return number;
+  return s21::FindCriticalPoints(expression, x_min, x_max, settings,
+                                 *GetThreadPool());
 }
 
 /**
- * @brief Извлечение лексемы с верхушки стэка с не числами stack_of_operators_
- * (функциями, операторами, скобками).
- * @return Лексема.
+ * @brief Вычисление определенного интеграла функции, заданной строкой.
+ * @throw std::invalid_argument В случае некорректности строки или пределов.
  */
-PolishNotation::Lexema PolishNotation::GetOperationFromStack() {
-  if (stack_of_operators_.empty()) {
-    throw std::invalid_argument("Incorrect input");
-  }
-  Lexema lex = stack_of_operators_.top();
-  stack_of_operators_.pop();
-  return lex;
-}
-
-/**
- * @brief Осуществление математической операции, соответствующей текущей
- * лексеме.
- * @param lex Текущая лексема.
- */
-void PolishNotation::MakeOperation(Lexema &lex) {
-  double result;
-  if (lex.GetGroup() == g_function) {
-    double arg = GetNumberFromStack();
-    auto func = std::get<unary_function>(lex.GetFunction());
-    result = func(arg);
-  } else if (lex.GetGroup() == g_binary_op) {
-    double right_arg = GetNumberFromStack();
-    double left_arg = GetNumberFromStack();
-    auto func = std::get<binary_function>(lex.GetFunction());
-    result = func(left_arg, right_arg);
-  }
-  stack_of_numbers_.push(
-      Lexema(std::to_string(result), t_number, g_number, 0, result));
+IntegrationResult PolishNotation::Integrate(const std::string &input_expression,
+                                            double a, double b,
+                                            const Integration &settings) const {
+  return Integrate(Compile(input_expression), a, b, settings);
 }
 
 /**
- * @brief Действия при встрече закрывающй скобки в стэке.
- * @details Выталкиваются операторы и производятся соответствующие вычисления,
- * пока не будет встречена открывающая скобка.
+ * @brief Вычисление определенного интеграла функции от x.
+ * @param expression Скомпилированное выражение.
+ * @param a Нижний предел.
+ * @param b Верхний предел.
+ * @param settings Допустимая ошибка и бюджет отрезков.
+ * @return Значение интеграла, оценка ошибки и количество вычислений.
+ * @throw std::invalid_argument В случае некорректности пределов или если в
+ * выражении есть переменные, кроме x.
+ * @details Адаптивное правило Гаусса-Кронрода, отрезки вычисляются в пуле
+ * потоков.
  */
-void PolishNotation::ClosingBracketProcessing() {
-  int open_bracket_check = 0;
-  while (!stack_of_operators_.empty()) {
-    Lexema lex = GetOperationFromStack();
-    if (lex.GetGroup() == g_opening_br) {
-      open_bracket_check = 1;
-      break;
-    }
-    MakeOperation(lex);
+IntegrationResult PolishNotation::Integrate(
+    const CompiledExpression &expression, double a, double b,
+    const Integration &settings) const {
+  if (!std::isfinite(a) || !std::isfinite(b)) {
+    CalculationError{err_incorrect_borders}.Throw();
   }
-  if (!open_bracket_check) {
-    throw std::invalid_argument("Incorrect use of brackets");
+  if (!DependsOnlyOnX(expression)) {
+    CalculationError{err_unbound_variable}.Throw();
   }
+  return s21::Integrate(expression, a, b, settings, *GetThreadPool());
 }
 
 /**
- * @brief Цикл для финального подсчета (производятся операции оставшихся в
- * стэке лексем).
+ * @brief Вычисление поверхности z = f(x, y), заданной строкой.
+ * @throw std::invalid_argument В случае некорректности строки или сетки.
  */
-void PolishNotation::FinalCalculations() {
-  while (!stack_of_operators_.empty()) {
-    Lexema current_lexema = GetOperationFromStack();
-    MakeOperation(current_lexema);
-  }
-  if (stack_of_operators_.size() == 0 && stack_of_numbers_.size() == 1) {
-    final_answer = GetNumberFromStack();
-  } else {
-    throw std::invalid_argument("Incorrect string");
-  }
+void PolishNotation::GetSurface(const std::string &input_expression,
+                                const SurfaceGrid &grid,
+                                double *z_data) const {
+  GetSurface(Compile(input_expression), grid, z_data);
 }
 
 /**
- * @brief Вычисление значений для построения графика.
- * @param input_expression Строка с выражением.
- * @param x_min Нижняя граница области определения графика.
- * @param x_max Верхняя граница области определения графика.
- * @param x_data Вектор для значений X.
- * @param y_data Вектор для значений Y.
- * @throw std::invalid_argument В случае некорректности строки.
+ * @brief Вычисление поверхности z = f(x, y) на сетке.
+ * @param expression Скомпилированное выражение от x и y.
+ * @param grid Сетка.
+ * @param z_data Массив из grid.width * grid.height значений, заполняется по
+ * строкам (строка - значение y, столбец - значение x).
+ * @throw std::invalid_argument В случае некорректности сетки или если в
+ * выражении есть переменные, кроме x и y.
+ * @details Плитки сетки вычисляются в пуле потоков.
  */
-void PolishNotation::GetGraph(std::string &input_expression, double x_min,
-                              double x_max, std::vector<double> &x_data,
-                              std::vector<double> &y_data) {
-  if (x_max <= x_min) {
-    throw std::invalid_argument("Incorrect borders");
+void PolishNotation::GetSurface(const CompiledExpression &expression,
+                                const SurfaceGrid &grid,
+                                double *z_data) const {
+  if (!(grid.x_max > grid.x_min) || !(grid.y_max > grid.y_min) ||
+      grid.width < 2 || grid.height < 2) {
+    CalculationError{err_incorrect_borders}.Throw();
   }
-  double step = (x_max - x_min) / 499;
-  try {
-    ToLowerCase(input_expression);
-    for (x = x_min; x <= x_max; x += step) {
-      ParseExpression(input_expression);
-      LexemasProcessing();
-      FinalCalculations();
-      x_data.push_back(x);
-      y_data.push_back(GetAnswer());
+  for (const std::string &name : expression.GetVariables()) {
+    if (name != "x" && name != "y") {
+      CalculationError{err_unbound_variable}.Throw();
     }
-  } catch (const std::invalid_argument &ex) {
-    ClearAll();
-    throw;
   }
+  SampleSurface(expression, grid, *GetThreadPool(), z_data);
 }
 
 /**
- * @brief Очищает стэки и очереди (на случай некорректного завершения
- * вычисления).
+ * @brief Задает количество потоков для вычисления графиков.
+ * @param threads_count Количество потоков. Ноль означает количество
+ * аппаратных потоков.
  */
-void PolishNotation::ClearAll() {
-  x_is_found = false;
-  parsed_lexemas_.clear();
-  std::stack<Lexema>().swap(stack_of_numbers_);
-  std::stack<Lexema>().swap(stack_of_operators_);
+void PolishNotation::SetThreadsCount(size_t threads_count) {
+  std::lock_guard<std::mutex> lock(thread_pool_mutex_);
+  threads_count_ = threads_count;
+  thread_pool_.reset();
+}
+
+/**
+ * @brief Функция-геттер, возвращающая количество потоков для вычисления
+ * графиков.
+ */
+size_t PolishNotation::GetThreadsCount() const {
+  std::lock_guard<std::mutex> lock(thread_pool_mutex_);
+  if (thread_pool_) {
+    return thread_pool_->GetThreadsCount();
+  }
+  return threads_count_ ? threads_count_
+                        : std::max(1u, std::thread::hardware_concurrency());
+}
+
+/**
+ * @brief Задает режим JIT для компилируемых выражений.
+ * @param mode Режим.
+ */
+void PolishNotation::SetJitMode(CompiledExpression::JitMode mode) {
+  jit_mode_.store(mode, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Функция-геттер, возвращающая пул потоков. Пул создается при первом
+ * вычислении графика, поэтому создание объекта не запускает потоки.
+ * @details Вызывающий получает свою ссылку на пул: если во время вычисления
+ * графика другой поток вызовет SetThreadsCount, старый пул доработает и
+ * удалится вместе с последней ссылкой.
+ */
+std::shared_ptr<ThreadPool> PolishNotation::GetThreadPool() const {
+  std::lock_guard<std::mutex> lock(thread_pool_mutex_);
+  if (!thread_pool_) {
+    thread_pool_ = std::make_shared<ThreadPool>(threads_count_);
+  }
+  return thread_pool_;
 }
 
-}  // namespace s21
\ No newline at end of file
+}  // namespace s21
@@ -1,221 +1,188 @@
 #ifndef SMARTCALC_MODEL_H_
 #define SMARTCALC_MODEL_H_
 
+#include <atomic>
 #include <cctype>
+#include <cstdint>
 #include <cmath>
 #include <cstring>
-#include <deque>
-#include <functional>
 #include <iostream>
-#include <map>
-#include <stack>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
 #include <utility>
-#include <variant>
 #include <vector>
 
+#include "adaptive_sampler.h"
+#include "compiled_expression.h"
+#include "integrator.h"
+#include "mapped_column.h"
+#include "result.h"
+#include "root_finder.h"
+#include "surface_sampler.h"
+#include "thread_pool.h"
+
 namespace s21 {
 
 /**
  * @brief Класс для обработки и вычисления выражения через польскую нотацию.
+ * @details Вычисления не меняют состояние объекта: компиляция идет в рабочем
+ * пространстве своего потока, а пул потоков создается под мьютексом. Поэтому
+ * один объект можно использовать из нескольких потоков одновременно.
+ *
+ * Функции с префиксом Try не бросают исключений и возвращают Result с кодом
+ * ошибки и позицией в строке; обычные функции - обертки над ними, бросающие
+ * std::invalid_argument.
  */
 class PolishNotation {
-  using unary_function = std::function<double(double)>;
-  using binary_function = std::function<double(double, double)>;
-  using function_variant =
-      std::variant<double, unary_function, binary_function, nullptr_t>;
-
  public:
   PolishNotation() = default;
 
-  ~PolishNotation();
-
-  void Calculate(std::string &input_expression, std::string &x_value);
-
-  void GetGraph(std::string &input_expression, double x_min, double x_max,
-                std::vector<double> &x_data, std::vector<double> &y_data);
-
-  double GetAnswer() const;
-
- private:
-  /**
-   * @brief Перечисление групп лексем.
-   */
-  enum Group {
-    g_number,      ///< Число
-    g_unary_op,    ///< Унарный оператор
-    g_binary_op,   ///< Бинарный оператор
-    g_function,    ///< Функиця
-    g_opening_br,  ///< Открывающая скобка
-    g_closing_br,  ///< Закрывающая скобка
-    g_none         ///< Не определена
-  };
-
-  /**
-   * @brief Перечисление типов лексем.
-   */
-  enum Type {
-    t_cos,
-    t_sin,
-    t_tan,
-    t_acos,
-    t_asin,
-    t_atan,
-    t_ln,
-    t_log,
-    t_sqrt,
-    t_pow,
-    t_mult,
-    t_div,
-    t_mod,
-    t_plus,
-    t_minus,
-    t_unary_plus,
-    t_unary_minus,
-    t_opening_br,
-    t_closing_br,
-    t_number,
-    t_x,
-    t_none
-  };
-
-  /**
-   * @brief Подкласс для отдельной лексемы.
-   */
-  class Lexema {
-   public:
-    Lexema(const std::string &name, Type type, Group group, int prior,
-           function_variant function);
-
-    ~Lexema() = default;
+  ~PolishNotation() = default;
 
-    Type GetType() const;
+  double Calculate(const std::string &input_expression,
+                   const std::string &x_value) const;
 
-    Group GetGroup() const;
+  double Calculate(const CompiledExpression &expression,
+                   const std::string &x_value) const;
 
-    int GetPrioroty() const;
+  CompiledExpression Compile(const std::string &input_expression) const;
 
-    auto GetFunction() const;
+  Result<double> TryCalculate(const std::string &input_expression,
+                              const std::string &x_value) const noexcept;
 
-    std::string GetName() const;
+  Result<double> TryCalculate(const CompiledExpression &expression,
+                              const std::string &x_value) const noexcept;
 
-   private:
-    std::string name_;  ///< Название лексемы.
+  Result<CompiledExpression> TryCompile(
+      const std::string &input_expression) const noexcept;
 
-    Type type_;  ///< Тип лексемы.
+  void TryCalculateMany(const std::string_view *input_expressions,
+                        const std::string_view *x_values, size_t count,
+                        Result<double> *results) const noexcept;
 
-    Group group_;  ///< Группа лексемы.
+  size_t EvaluateColumn(const std::string &input_expression,
+                        const std::string &input_path,
+                        const std::string &output_path) const;
 
-    int priority_;  ///< Приориет лексемы.
+  Result<size_t> TryEvaluateColumn(const CompiledExpression &expression,
+                                   const std::string &input_path,
+                                   const std::string &output_path) const
+      noexcept;
 
-    function_variant function_;  ///< Функция или число лексемы.
-  };
+  std::string Differentiate(const std::string &input_expression,
+                            const std::string &variable = "x",
+                            size_t order = 1) const;
 
-  double x;  ///< Значение икса для подстановки в выражение.
+  Result<std::string> TryDifferentiate(const std::string &input_expression,
+                                       const std::string &variable = "x",
+                                       size_t order = 1) const noexcept;
 
-  bool x_is_found = false;  ///< Флаг, обозначающий, что икс присутствует в
-                            ///< строке с выражением.
+  std::string Normalize(const std::string &input_expression) const;
 
-  double final_answer;  ///< Вычисленный ответ.
+  void GetGraph(const std::string &input_expression, double x_min, double x_max,
+                std::vector<double> &x_data, std::vector<double> &y_data,
+                size_t points_count = 500) const;
 
-  std::deque<Lexema> parsed_lexemas_;  ///< Очередь с прочитанными лексемами.
+  void GetGraph(const CompiledExpression &expression, double x_min,
+                double x_max, std::vector<double> &x_data,
+                std::vector<double> &y_data, size_t points_count = 500) const;
 
-  std::stack<Lexema> stack_of_numbers_;  ///< Стэк с числами из выражения.
+  void GetDerivativeGraph(const std::string &input_expression, double x_min,
+                          double x_max, std::vector<double> &x_data,
+                          std::vector<double> &y_data,
+                          std::vector<double> &dy_data,
+                          size_t points_count = 500) const;
 
-  std::stack<Lexema> stack_of_operators_;  ///< Стэк с нечислами из выражения
-                                           ///< (операторы, функции, скобки).
+  void GetDerivativeGraph(const CompiledExpression &expression, double x_min,
+                          double x_max, std::vector<double> &x_data,
+                          std::vector<double> &y_data,
+                          std::vector<double> &dy_data,
+                          size_t points_count = 500) const;
 
-  void ToLowerCase(std::string &input_expression);
+  void GetAdaptiveGraph(const std::string &input_expression, double x_min,
+                        double x_max, const AdaptiveSampling &settings,
+                        std::vector<double> &x_data,
+                        std::vector<double> &y_data) const;
 
-  void ParseExpression(std::string &input_expression);
+  void GetAdaptiveGraph(const CompiledExpression &expression, double x_min,
+                        double x_max, const AdaptiveSampling &settings,
+                        std::vector<double> &x_data,
+                        std::vector<double> &y_data) const;
 
-  double ParseNumber(std::string::iterator &iter);
+  Interval GetGraphRange(const std::string &input_expression, double x_min,
+                         double x_max) const;
 
-  void ParseLetter(std::string::iterator &iter);
+  Interval GetGraphRange(const CompiledExpression &expression, double x_min,
+                         double x_max) const;
 
-  void ParseSymbol(std::string::iterator &iter, int &brackets_count);
+  std::vector<CriticalPoint> FindCriticalPoints(
+      const std::string &input_expression, double x_min, double x_max,
+      const RootSearch &settings = RootSearch()) const;
 
-  double ParseX(std::string &x_value);
+  std::vector<CriticalPoint> FindCriticalPoints(
+      const CompiledExpression &expression, double x_min, double x_max,
+      const RootSearch &settings = RootSearch()) const;
 
-  bool CompareIterToStr(std::string::iterator &iter, const std::string &str);
+  IntegrationResult Integrate(
+      const std::string &input_expression, double a, double b,
+      const Integration &settings = Integration()) const;
 
-  bool IsUnary();
+  IntegrationResult Integrate(
+      const CompiledExpression &expression, double a, double b,
+      const Integration &settings = Integration()) const;
 
-  Lexema FindLexemaInMap(Type type);
+  void GetSurface(const std::string &input_expression,
+                  const SurfaceGrid &grid, double *z_data) const;
 
-  void PushOperatorToDeque(Type type);
+  void GetSurface(const CompiledExpression &expression,
+                  const SurfaceGrid &grid, double *z_data) const;
 
-  void PushNumberToDeque(double number);
-
-  void PushXToDeque();
+  double GetAnswer() const;
 
-  void ValidateFirstLexema();
+  void SetThreadsCount(size_t threads_count);
 
-  void ValidateLastLexema();
+  size_t GetThreadsCount() const;
 
-  void ValidateParsedLexemas(int brackets_count);
+  void SetJitMode(CompiledExpression::JitMode mode);
 
-  void LexemasProcessing();
+ private:
+  static constexpr size_t kGraphGrain = 16384;  ///< Количество точек графика,
+                                               ///< вычисляемых одной задачей
+                                               ///< пула потоков.
 
-  double GetNumberFromStack();
+  static constexpr size_t kLinesGrain = 1024;  ///< Количество выражений,
+                                              ///< вычисляемых одной задачей
+                                              ///< пула потоков.
 
-  Lexema GetOperationFromStack();
+  static constexpr size_t kLinesMemoSize = 64;  ///< Размер таблицы уже
+                                                ///< скомпилированных
+                                                ///< выражений задачи.
 
-  void MakeOperation(Lexema &lex);
+  mutable std::atomic<double> final_answer{0};  ///< Последний вычисленный
+                                                ///< ответ.
 
-  void ClosingBracketProcessing();
+  std::atomic<CompiledExpression::JitMode> jit_mode_{
+      CompiledExpression::jit_off};  ///< Режим JIT для новых выражений.
 
-  void FinalCalculations();
+  size_t threads_count_ = 0;  ///< Количество потоков для графиков (ноль -
+                             ///< количество аппаратных потоков).
 
-  void ClearAll();
+  mutable std::mutex thread_pool_mutex_;  ///< Защищает создание и замену
+                                          ///< пула потоков.
 
-  /**
-  Словарь для нахождения лексемы по типу.
-  Ключ - тип лексемы, значение - готовая лексема.
-  */
-  std::map<Type, Lexema> lexema_map_ = {
-      {t_cos,
-       Lexema("cos", t_cos, g_function, 4, [](double n) { return cos(n); })},
-      {t_sin,
-       Lexema("sin", t_sin, g_function, 4, [](double n) { return sin(n); })},
-      {t_tan,
-       Lexema("tan", t_tan, g_function, 4, [](double n) { return tan(n); })},
-      {t_acos,
-       Lexema("acos", t_acos, g_function, 4, [](double n) { return acos(n); })},
-      {t_asin,
-       Lexema("asin", t_asin, g_function, 4, [](double n) { return asin(n); })},
-      {t_atan,
-       Lexema("atan", t_atan, g_function, 4, [](double n) { return atan(n); })},
-      {t_ln,
-       Lexema("ln", t_ln, g_function, 4, [](double n) { return log(n); })},
-      {t_log,
-       Lexema("log", t_log, g_function, 4, [](double n) { return log10(n); })},
-      {t_pow, Lexema("^", t_pow, g_binary_op, 3,
-                     [](double n, double m) { return pow(n, m); })},
-      {t_sqrt,
-       Lexema("sqrt", t_sqrt, g_function, 3, [](double n) { return sqrt(n); })},
-      {t_mod, Lexema("mod", t_mod, g_binary_op, 2,
-                     [](double n, double m) { return fmod(n, m); })},
+  mutable std::shared_ptr<ThreadPool> thread_pool_;  ///< Пул потоков для
+                                                     ///< вычисления графиков,
+                                                     ///< создается при первом
+                                                     ///< использовании.
 
-      {t_mult, Lexema("*", t_mult, g_binary_op, 2, std::multiplies<double>())},
-      {t_div, Lexema("/", t_div, g_binary_op, 2, std::divides<double>())},
-      {t_plus, Lexema("+", t_plus, g_binary_op, 1, std::plus<double>())},
-      {t_minus, Lexema("-", t_minus, g_binary_op, 1, std::minus<double>())},
+  Result<double> ParseX(std::string_view x_value) const noexcept;
 
-      {t_opening_br, Lexema("(", t_opening_br, g_opening_br, 0, nullptr)},
-      {t_closing_br, Lexema(")", t_closing_br, g_closing_br, 0, nullptr)}};
+  Result<double> EvaluateAt(const CompiledExpression &expression,
+                            std::string_view x_value) const noexcept;
 
-  /**
-  Матрица смежности для лексем. Определяет, могут ли две лексемы идти подряд в
-  корректном математичсеком выражении.
-  */
-  const bool ValidityMatrix[6][6] = {
-      {0, 0, 1, 0, 0, 1},  // number
-      {1, 0, 0, 1, 1, 0},  // unary
-      {1, 0, 0, 1, 1, 0},  // binary
-      {0, 0, 0, 0, 1, 0},  // funcs
-      {1, 1, 0, 1, 1, 0},  // (
-      {0, 0, 1, 0, 0, 1}   // )
-  };
+  std::shared_ptr<ThreadPool> GetThreadPool() const;
 };
 
 }  // namespace s21
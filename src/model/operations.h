@@ -0,0 +1,67 @@
+#ifndef SMARTCALC_MODEL_OPERATIONS_H_
+#define SMARTCALC_MODEL_OPERATIONS_H_
+
+#include <cmath>
+#include <cstddef>
+
+namespace s21 {
+
+/**
+ * @brief Возведение в целую или полуцелую степень умножениями и корнем.
+ * @param base Основание.
+ * @param exponent Показатель, удвоенное значение которого целое.
+ * @return Результат. Для x^2, x^0.5 и x^-1 совпадает с pow побитово, для
+ * остальных показателей отличается от pow не больше чем на несколько ULP.
+ * @details Для полуцелых показателей pow(-0, n) и pow(-inf, n) равны
+ * pow(+0, n) и pow(+inf, n), тогда как sqrt(-0) = -0 и sqrt(-inf) = NaN,
+ * поэтому у этих двух оснований знак отбрасывается заранее.
+ */
+inline double PowerByParts(double base, double exponent) {
+  unsigned power = static_cast<unsigned>(std::fabs(exponent));
+  bool is_half = std::fabs(exponent) != power;
+  if (is_half && (base == 0 || std::isinf(base))) {
+    base = std::fabs(base);
+  }
+  double result = 1;
+  double square = base;
+  while (power != 0) {
+    if (power & 1) {
+      result *= square;
+    }
+    power >>= 1;
+    if (power != 0) {
+      square *= square;
+    }
+  }
+  if (is_half) {
+    result *= std::sqrt(base);
+  }
+  return exponent < 0 ? 1 / result : result;
+}
+
+/**
+ * @brief Остаток от деления с быстрым путем для делимого, меньшего делителя
+ * по модулю (в этом случае fmod возвращает делимое).
+ */
+inline double Modulo(double n, double m) {
+  return std::fabs(n) < std::fabs(m) ? n : std::fmod(n, m);
+}
+
+/**
+ * @brief Вычисление многочлена по схеме Горнера.
+ * @param x Аргумент.
+ * @param coefficients Количество коэффициентов, затем коэффициенты от
+ * старшего.
+ */
+inline double HornerScheme(double x, const double *coefficients) {
+  size_t coefficients_count = static_cast<size_t>(coefficients[0]);
+  double accumulator = coefficients[1];
+  for (size_t k = 2; k <= coefficients_count; ++k) {
+    accumulator = accumulator * x + coefficients[k];
+  }
+  return accumulator;
+}
+
+}  // namespace s21
+
+#endif  // SMARTCALC_MODEL_OPERATIONS_H_
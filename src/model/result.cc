@@ -0,0 +1,63 @@
+#include "result.h"
+
+#include <iterator>
+#include <stdexcept>
+
+namespace s21 {
+
+namespace {
+
+/**
+ * @brief Тексты ошибок в порядке перечисления ErrorCode.
+ */
+constexpr std::string_view kErrorMessages[] = {
+    "",
+    "Empty input",
+    "Incorrect input",
+    "Incorrect symbol in input expression",
+    "Incorrect number",
+    "Incorrect use of brackets",
+    "Incorrect string",
+    "Operator is not maintained",
+    "X value is empty",
+    "Invalid X value",
+    "Unbound variable",
+    "Incorrect borders",
+    "Out of memory",
+    "Cannot map column file",
+    "System resource unavailable"};
+
+static_assert(std::size(kErrorMessages) == err_system_resource + 1,
+              "kErrorMessages must be indexed by ErrorCode");
+
+}  // namespace
+
+/**
+ * @brief Функция-геттер, возвращающая текст ошибки по коду.
+ * @param code Код ошибки.
+ */
+std::string_view GetErrorMessage(ErrorCode code) {
+  return code <= err_system_resource ? kErrorMessages[code]
+                                     : std::string_view();
+}
+
+/**
+ * @brief Текст ошибки вместе с позицией (с единицы), если она известна.
+ */
+std::string CalculationError::GetMessage() const {
+  std::string message(GetErrorMessage(code));
+  if (position != kNoPosition) {
+    message += " at position " + std::to_string(position + 1);
+  }
+  return message;
+}
+
+/**
+ * @brief Бросает исключение с текстом ошибки.
+ * @throw std::invalid_argument Всегда.
+ */
+void CalculationError::Throw() const {
+  throw std::invalid_argument(GetMessage());
+}
+
+}  // namespace s21
@@ -0,0 +1,118 @@
+#ifndef SMARTCALC_MODEL_RESULT_H_
+#define SMARTCALC_MODEL_RESULT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+
+namespace s21 {
+
+/**
+ * @brief Перечисление кодов ошибок разбора и вычисления.
+ */
+enum ErrorCode : uint8_t {
+  err_none,                  ///< Ошибки нет
+  err_empty_input,           ///< Пустое выражение
+  err_incorrect_input,       ///< Недопустимая последовательность лексем
+  err_incorrect_symbol,      ///< Неизвестный символ
+  err_incorrect_number,      ///< Некорректная запись числа
+  err_incorrect_brackets,    ///< Несбалансированные скобки
+  err_incorrect_string,      ///< Выражение не сводится к одному значению
+  err_unsupported_operator,  ///< Оператор не поддерживается
+  err_empty_x,               ///< Пустое значение икса
+  err_invalid_x,             ///< Некорректное значение икса
+  err_unbound_variable,      ///< Значение переменной не задано
+  err_incorrect_borders,     ///< Некорректные границы графика
+  err_out_of_memory,         ///< Не удалось выделить память
+  err_column_file,           ///< Ошибка файла столбца значений
+  err_system_resource        ///< Система отказала в ресурсе (например, потоке)
+};
+
+std::string_view GetErrorMessage(ErrorCode code);
+
+/**
+ * @brief Ошибка с кодом и смещением в исходной строке.
+ */
+struct CalculationError {
+  static constexpr size_t kNoPosition =
+      static_cast<size_t>(-1);  ///< Позиция неизвестна.
+
+  ErrorCode code = err_none;      ///< Код ошибки.
+  size_t position = kNoPosition;  ///< Смещение ошибочного токена (с нуля).
+
+  std::string GetMessage() const;
+
+  [[noreturn]] void Throw() const;
+};
+
+/**
+ * @brief Результат операции: значение или ошибка (аналог std::expected).
+ * @details Нужен для API без исключений: на некорректных данных ошибка
+ * возвращается как обычное значение, без раскрутки стэка.
+ */
+template <typename T>
+class Result {
+ public:
+  /**
+   * @brief Конструктор успешного результата.
+   * @param value Значение.
+   */
+  Result(T value) : data_(std::move(value)) {}
+
+  /**
+   * @brief Конструктор ошибочного результата.
+   * @param error Ошибка.
+   */
+  Result(CalculationError error) : data_(error) {}
+
+  /**
+   * @brief Конструктор ошибочного результата без позиции.
+   * @param code Код ошибки.
+   */
+  Result(ErrorCode code) : data_(CalculationError{code}) {}
+
+  /**
+   * @brief Проверка, что результат содержит значение.
+   */
+  bool HasValue() const { return data_.index() == 0; }
+
+  explicit operator bool() const { return HasValue(); }
+
+  /**
+   * @brief Функция-геттер, возвращающая значение (только если HasValue).
+   */
+  const T &GetValue() const & { return *std::get_if<0>(&data_); }
+
+  T &GetValue() & { return *std::get_if<0>(&data_); }
+
+  T &&GetValue() && { return std::move(*std::get_if<0>(&data_)); }
+
+  /**
+   * @brief Функция-геттер, возвращающая ошибку (err_none, если ее нет).
+   */
+  CalculationError GetError() const {
+    const CalculationError *error = std::get_if<1>(&data_);
+    return error ? *error : CalculationError();
+  }
+
+  /**
+   * @brief Значение или исключение для API с исключениями.
+   * @throw std::invalid_argument Если результат содержит ошибку.
+   */
+  T GetValueOrThrow() && {
+    if (!HasValue()) {
+      std::get_if<1>(&data_)->Throw();
+    }
+    return std::move(*std::get_if<0>(&data_));
+  }
+
+ private:
+  std::variant<T, CalculationError> data_;  ///< Значение или ошибка.
+};
+
+}  // namespace s21
+
+#endif  // SMARTCALC_MODEL_RESULT_H_
@@ -0,0 +1,207 @@
+#include "root_finder.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <utility>
+
+namespace s21 {
+
+namespace {
+
+constexpr size_t kScanGrain = 4096;  ///< Количество точек сканирования,
+                                     ///< вычисляемых одной задачей пула.
+
+constexpr size_t kRefineGrain = 4;  ///< Количество отрезков, уточняемых
+                                    ///< одной задачей пула.
+
+/**
+ * @brief Отрезок сетки сканирования, на котором меняет знак функция (для
+ * корней) или ее производная (для экстремумов).
+ */
+struct Bracket {
+  CriticalPoint::Kind kind;  ///< Вид искомой точки.
+  size_t index;              ///< Левый узел отрезка.
+  bool exact;                ///< Ноль попал точно в узел index.
+};
+
+/**
+ * @brief Уточнение нуля функции на отрезке со сменой знака методом Ньютона с
+ * защитой бисекцией.
+ * @param function Функция, возвращающая пару: значение g(x) и производную
+ * g'(x).
+ * @param a Левый конец отрезка.
+ * @param g_a Значение g(a) (знак противоположен знаку на правом конце).
+ * @param b Правый конец отрезка.
+ * @param settings Допустимая ошибка и количество шагов.
+ * @return Точка, в которой g меняет знак.
+ * @details Шаг Ньютона принимается, если он остается внутри текущего
+ * отрезка, иначе делается шаг бисекции. Отрезок сужается на каждом шаге,
+ * поэтому уточнение сходится даже там, где метод Ньютона расходится, а у
+ * простого нуля - квадратично.
+ */
+template <typename Function>
+double Refine(Function function, double a, double g_a, double b,
+              const RootSearch &settings) {
+  double x = a + (b - a) / 2;
+  for (size_t i = 0; i < settings.max_iterations; ++i) {
+    auto [g, slope] = function(x);
+    if (g == 0) {
+      return x;
+    }
+    if ((g < 0) == (g_a < 0)) {
+      a = x;
+      g_a = g;
+    } else {
+      b = x;
+    }
+    double tolerance = settings.tolerance + 4 * DBL_EPSILON * std::fabs(x);
+    if (b - a <= tolerance) {
+      break;
+    }
+    double next = x - g / slope;
+    if (!(next > a && next < b)) {
+      next = a + (b - a) / 2;
+    }
+    if (std::fabs(next - x) <= tolerance) {
+      return next;
+    }
+    x = next;
+  }
+  return a + (b - a) / 2;
+}
+
+/**
+ * @brief Вид экстремума в узле, где производная ровно ноль.
+ * @return true - если производная меняет знак, и kind заполнен.
+ */
+bool ClassifyExactExtremum(double left_slope, double right_slope,
+                           CriticalPoint::Kind &kind) {
+  if (left_slope > 0 && right_slope < 0) {
+    kind = CriticalPoint::cp_maximum;
+    return true;
+  }
+  if (left_slope < 0 && right_slope > 0) {
+    kind = CriticalPoint::cp_minimum;
+    return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+/**
+ * @brief Поиск всех корней и локальных экстремумов функции на отрезке.
+ * @param expression Скомпилированное выражение от одной переменной.
+ * @param x_min Нижняя граница отрезка.
+ * @param x_max Верхняя граница отрезка.
+ * @param settings Размер сетки сканирования и допустимая ошибка.
+ * @param pool Пул потоков.
+ * @return Точки по возрастанию X.
+ * @details Сначала функция и ее производная (автоматическим
+ * дифференцированием) вычисляются на равномерной сетке задачами пула. Смена
+ * знака функции между соседними узлами дает отрезок с корнем, смена знака
+ * производной - отрезок с экстремумом. Затем все отрезки уточняются
+ * параллельно методом Ньютона с защитой бисекцией: для корня по f и f', для
+ * экстремума по f' и f''.
+ *
+ * Смена знака через полюс (tan, 1 / x) тоже сужается, но в найденной точке
+ * функция больше по модулю, чем на концах отрезка, и такая точка
+ * отбрасывается. Так же отбрасываются "экстремумы" на полюсах производной.
+ */
+std::vector<CriticalPoint> FindCriticalPoints(
+    const CompiledExpression &expression, double x_min, double x_max,
+    const RootSearch &settings, ThreadPool &pool) {
+  const size_t count = std::max<size_t>(settings.scan_points, 2);
+  const double step = (x_max - x_min) / (count - 1);
+  std::vector<double> x_values(count);
+  std::vector<double> y_values(count);
+  std::vector<double> slopes(count);
+  pool.ParallelFor(count, kScanGrain, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      x_values[i] = i + 1 == count ? x_max : x_min + step * i;
+    }
+    expression.EvaluateDerivative(x_values.data() + begin,
+                                  y_values.data() + begin,
+                                  slopes.data() + begin, nullptr,
+                                  end - begin);
+  });
+
+  std::vector<Bracket> brackets;
+  for (size_t i = 0; i < count; ++i) {
+    bool has_next = i + 1 < count;
+    if (y_values[i] == 0) {
+      brackets.push_back({CriticalPoint::cp_root, i, true});
+    } else if (has_next && y_values[i] * y_values[i + 1] < 0) {
+      brackets.push_back({CriticalPoint::cp_root, i, false});
+    }
+    CriticalPoint::Kind kind;
+    if (slopes[i] == 0 && i > 0 && has_next &&
+        ClassifyExactExtremum(slopes[i - 1], slopes[i + 1], kind)) {
+      brackets.push_back({kind, i, true});
+    } else if (has_next && slopes[i] * slopes[i + 1] < 0) {
+      kind = slopes[i] > 0 ? CriticalPoint::cp_maximum
+                           : CriticalPoint::cp_minimum;
+      brackets.push_back({kind, i, false});
+    }
+  }
+
+  std::vector<CriticalPoint> points(brackets.size());
+  std::vector<char> accepted(brackets.size(), 0);
+  pool.ParallelFor(
+      brackets.size(), kRefineGrain, [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k) {
+          const Bracket &bracket = brackets[k];
+          size_t i = bracket.index;
+          CriticalPoint &point = points[k];
+          point.kind = bracket.kind;
+          if (bracket.exact) {
+            point.x = x_values[i];
+            point.y = y_values[i];
+            accepted[k] = 1;
+            continue;
+          }
+          if (bracket.kind == CriticalPoint::cp_root) {
+            point.x = Refine(
+                [&](double x) {
+                  Dual result = expression.EvaluateDerivative(x);
+                  return std::make_pair(result.value, result.first);
+                },
+                x_values[i], y_values[i], x_values[i + 1], settings);
+          } else {
+            point.x = Refine(
+                [&](double x) {
+                  Dual result = expression.EvaluateDerivative(x);
+                  return std::make_pair(result.first, result.second);
+                },
+                x_values[i], slopes[i], x_values[i + 1], settings);
+          }
+          point.y = expression.Evaluate(point.x);
+          double left = y_values[i];
+          double right = y_values[i + 1];
+          if (bracket.kind == CriticalPoint::cp_root) {
+            accepted[k] = std::fabs(point.y) <=
+                          std::min(std::fabs(left), std::fabs(right));
+          } else if (bracket.kind == CriticalPoint::cp_minimum) {
+            accepted[k] = point.y <= std::min(left, right);
+          } else {
+            accepted[k] = point.y >= std::max(left, right);
+          }
+        }
+      });
+
+  std::vector<CriticalPoint> result;
+  result.reserve(points.size());
+  for (size_t k = 0; k < points.size(); ++k) {
+    if (accepted[k]) {
+      result.push_back(points[k]);
+    }
+  }
+  std::stable_sort(result.begin(), result.end(),
+                   [](const CriticalPoint &a, const CriticalPoint &b) {
+                     return a.x < b.x;
+                   });
+  return result;
+}
+
+}  // namespace s21
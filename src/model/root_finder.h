@@ -0,0 +1,50 @@
+#ifndef SMARTCALC_MODEL_ROOT_FINDER_H_
+#define SMARTCALC_MODEL_ROOT_FINDER_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "compiled_expression.h"
+#include "thread_pool.h"
+
+namespace s21 {
+
+/**
+ * @brief Параметры поиска корней и экстремумов.
+ */
+struct RootSearch {
+  size_t scan_points = 100000;  ///< Количество точек грубого сканирования.
+                                ///< Корни и экстремумы ближе друг к другу,
+                                ///< чем шаг сетки, могут не разделиться.
+
+  double tolerance = 1e-12;  ///< Допустимая ошибка по X.
+
+  size_t max_iterations = 100;  ///< Максимальное количество шагов уточнения
+                                ///< одного отрезка.
+};
+
+/**
+ * @brief Найденный корень или локальный экстремум.
+ */
+struct CriticalPoint {
+  /**
+   * @brief Перечисление видов точек.
+   */
+  enum Kind {
+    cp_root,     ///< Корень f(x) = 0
+    cp_minimum,  ///< Локальный минимум
+    cp_maximum   ///< Локальный максимум
+  };
+
+  Kind kind = cp_root;  ///< Вид точки.
+  double x = 0;         ///< Положение точки.
+  double y = 0;         ///< Значение функции в точке.
+};
+
+std::vector<CriticalPoint> FindCriticalPoints(
+    const CompiledExpression &expression, double x_min, double x_max,
+    const RootSearch &settings, ThreadPool &pool);
+
+}  // namespace s21
+
+#endif  // SMARTCALC_MODEL_ROOT_FINDER_H_
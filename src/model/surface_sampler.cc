@@ -0,0 +1,68 @@
+#include "surface_sampler.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace s21 {
+
+namespace {
+
+constexpr size_t kTileRows = 16;  ///< Количество строк в плитке.
+
+constexpr size_t kTileColumns = 1024;  ///< Количество столбцов в плитке.
+
+}  // namespace
+
+/**
+ * @brief Вычисление поверхности z = f(x, y) на сетке.
+ * @param expression Скомпилированное выражение от переменных x и y (любая
+ * из них может отсутствовать).
+ * @param grid Сетка.
+ * @param pool Пул потоков.
+ * @param z_data Массив из grid.width * grid.height значений, заполняется по
+ * строкам: z_data[row * width + column] = f(x[column], y[row]).
+ * @details Сетка делится на плитки kTileRows x kTileColumns (128 КБ
+ * результатов), которые вычисляются задачами пула. Внутри плитки каждая
+ * строка вычисляется пакетно с фиксированным y, поэтому рабочий стэк
+ * пакетного вычисления и записываемый кусок z_data остаются в кэше.
+ */
+void SampleSurface(const CompiledExpression &expression,
+                   const SurfaceGrid &grid, ThreadPool &pool, double *z_data) {
+  const size_t width = grid.width;
+  const size_t height = grid.height;
+  const double x_step = (grid.x_max - grid.x_min) / (width - 1);
+  const double y_step = (grid.y_max - grid.y_min) / (height - 1);
+  std::vector<double> x_values(width);
+  for (size_t column = 0; column < width; ++column) {
+    x_values[column] = grid.x_min + x_step * column;
+  }
+
+  const size_t variables_count = expression.GetVariables().size();
+  const int x_slot = expression.FindVariable("x");
+  const int y_slot = expression.FindVariable("y");
+  const size_t sweep_slot =
+      x_slot >= 0 ? static_cast<size_t>(x_slot) : variables_count;
+
+  const size_t tile_columns = (width + kTileColumns - 1) / kTileColumns;
+  const size_t tile_rows = (height + kTileRows - 1) / kTileRows;
+  pool.ParallelFor(
+      tile_rows * tile_columns, 1, [&](size_t begin, size_t end) {
+        std::vector<double> bindings(variables_count);
+        for (size_t tile = begin; tile < end; ++tile) {
+          size_t row_begin = tile / tile_columns * kTileRows;
+          size_t row_end = std::min(height, row_begin + kTileRows);
+          size_t column_begin = tile % tile_columns * kTileColumns;
+          size_t columns = std::min(width - column_begin, kTileColumns);
+          for (size_t row = row_begin; row < row_end; ++row) {
+            if (y_slot >= 0) {
+              bindings[y_slot] = grid.y_min + y_step * row;
+            }
+            expression.Evaluate(bindings.data(), sweep_slot,
+                                x_values.data() + column_begin,
+                                z_data + row * width + column_begin, columns);
+          }
+        }
+      });
+}
+
+}  // namespace s21
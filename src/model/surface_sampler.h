@@ -0,0 +1,31 @@
+#ifndef SMARTCALC_MODEL_SURFACE_SAMPLER_H_
+#define SMARTCALC_MODEL_SURFACE_SAMPLER_H_
+
+#include <cstddef>
+
+#include "compiled_expression.h"
+#include "thread_pool.h"
+
+namespace s21 {
+
+/**
+ * @brief Прямоугольная сетка для вычисления поверхности z = f(x, y).
+ * @details Узлы стоят на границах области: первый столбец - x_min,
+ * последний - x_max, первая строка - y_min, последняя - y_max.
+ */
+struct SurfaceGrid {
+  double x_min = -1;  ///< Нижняя граница X.
+  double x_max = 1;   ///< Верхняя граница X.
+  double y_min = -1;  ///< Нижняя граница Y.
+  double y_max = 1;   ///< Верхняя граница Y.
+
+  size_t width = 2;   ///< Количество узлов по X (не меньше двух).
+  size_t height = 2;  ///< Количество узлов по Y (не меньше двух).
+};
+
+void SampleSurface(const CompiledExpression &expression,
+                   const SurfaceGrid &grid, ThreadPool &pool, double *z_data);
+
+}  // namespace s21
+
+#endif  // SMARTCALC_MODEL_SURFACE_SAMPLER_H_
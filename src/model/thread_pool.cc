@@ -0,0 +1,192 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <exception>
+
+namespace s21 {
+
+/**
+ * @brief Конструктор.
+ * @param threads_count Количество потоков, участвующих в вычислениях (вместе
+ * с вызывающим). Ноль означает количество аппаратных потоков.
+ * @throw std::system_error Если система не дала запустить поток (уже
+ * запущенные потоки останавливаются).
+ */
+ThreadPool::ThreadPool(size_t threads_count) {
+  if (threads_count == 0) {
+    threads_count = std::max(1u, std::thread::hardware_concurrency());
+  }
+  for (size_t i = 0; i + 1 < threads_count; ++i) {
+    queues_.push_back(std::make_unique<WorkQueue>());
+  }
+  try {
+    for (size_t i = 0; i + 1 < threads_count; ++i) {
+      workers_.emplace_back(&ThreadPool::WorkerLoop, this, i);
+    }
+  } catch (...) {
+    // Деструктор для недостроенного объекта не вызывается, а уничтожение
+    // работающего std::thread завершает программу.
+    Stop();
+    throw;
+  }
+}
+
+/**
+ * @brief Деструктор: останавливает и дожидается рабочих потоков.
+ */
+ThreadPool::~ThreadPool() { Stop(); }
+
+/**
+ * @brief Остановка рабочих потоков и ожидание их завершения.
+ */
+void ThreadPool::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    stop_ = true;
+  }
+  wake_up_.notify_all();
+  for (std::thread &worker : workers_) {
+    worker.join();
+  }
+}
+
+/**
+ * @brief Функция-геттер, возвращающая количество потоков, участвующих в
+ * вычислениях.
+ */
+size_t ThreadPool::GetThreadsCount() const { return workers_.size() + 1; }
+
+/**
+ * @brief Параллельное выполнение тела цикла по диапазону [0, count).
+ * @param count Размер диапазона.
+ * @param grain Размер куска диапазона, выполняемого одной задачей.
+ * @param body Тело цикла, получает границы куска [begin, end).
+ * @details Возвращает управление, когда выполнены все куски. Исключение,
+ * брошенное в одном из кусков, пробрасывается вызывающему. Если не удалось
+ * поставить задачу в очередь (std::bad_alloc), уже поставленные куски
+ * выполняются до конца, остальные не выполняются, и исключение
+ * пробрасывается вызывающему.
+ */
+void ThreadPool::ParallelFor(size_t count, size_t grain,
+                             const std::function<void(size_t, size_t)> &body) {
+  grain = std::max<size_t>(grain, 1);
+  if (workers_.empty() || count <= grain) {
+    body(0, count);
+    return;
+  }
+
+  size_t chunks_count = (count + grain - 1) / grain;
+  std::atomic<size_t> remaining(chunks_count);
+  std::exception_ptr error;
+  std::mutex error_mutex;
+
+  // Задачи ссылаются на переменные этого кадра, поэтому выходить из функции
+  // можно, только когда выполнены все поставленные задачи, в том числе если
+  // Push бросил исключение на середине цикла.
+  std::exception_ptr push_error;
+  size_t chunk = 0;
+  try {
+    for (; chunk < chunks_count; ++chunk) {
+      Push([&, chunk] {
+        size_t begin = chunk * grain;
+        try {
+          body(begin, std::min(count, begin + grain));
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(error_mutex);
+          if (!error) {
+            error = std::current_exception();
+          }
+        }
+        remaining.fetch_sub(1, std::memory_order_release);
+      });
+    }
+  } catch (...) {
+    push_error = std::current_exception();
+    remaining.fetch_sub(chunks_count - chunk, std::memory_order_release);
+  }
+
+  while (remaining.load(std::memory_order_acquire) != 0) {
+    Task task;
+    if (PopTask(queues_.size(), task)) {
+      task();
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  if (push_error) {
+    std::rethrow_exception(push_error);
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+/**
+ * @brief Добавление задачи в очереди рабочих потоков по кругу.
+ * @param task Задача.
+ */
+void ThreadPool::Push(Task task) {
+  size_t index = next_queue_.fetch_add(1) % queues_.size();
+  {
+    std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+    queues_[index]->tasks.push_back(std::move(task));
+  }
+  pending_.fetch_add(1);
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+  }
+  wake_up_.notify_one();
+}
+
+/**
+ * @brief Получение задачи: сначала с конца своей очереди, затем с начала
+ * чужих.
+ * @param index Номер потока. Номер, равный количеству очередей, означает
+ * вызывающий поток, у которого своей очереди нет.
+ * @param task Сюда записывается полученная задача.
+ * @return true - если задача получена, false - если все очереди пусты.
+ */
+bool ThreadPool::PopTask(size_t index, Task &task) {
+  if (index < queues_.size()) {
+    WorkQueue &own = *queues_[index];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.tasks.empty()) {
+      task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+      pending_.fetch_sub(1);
+      return true;
+    }
+  }
+  for (size_t i = 1; i <= queues_.size(); ++i) {
+    WorkQueue &victim = *queues_[(index + i) % queues_.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      pending_.fetch_sub(1);
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Цикл рабочего потока: выполняет задачи или ждет их появления.
+ * @param index Номер потока.
+ */
+void ThreadPool::WorkerLoop(size_t index) {
+  while (true) {
+    Task task;
+    if (PopTask(index, task)) {
+      task();
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    wake_up_.wait(lock, [this] { return stop_ || pending_.load() != 0; });
+    if (stop_) {
+      return;
+    }
+  }
+}
+
+}  // namespace s21
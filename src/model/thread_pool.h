@@ -0,0 +1,74 @@
+#ifndef SMARTCALC_MODEL_THREAD_POOL_H_
+#define SMARTCALC_MODEL_THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace s21 {
+
+/**
+ * @brief Пул потоков с перехватом задач (work stealing).
+ * @details У каждого рабочего потока своя очередь задач: поток берет задачи
+ * с конца своей очереди, а когда она пуста - забирает задачи с начала чужих
+ * очередей. Поток, вызвавший ParallelFor, тоже выполняет задачи, пока они не
+ * закончатся, поэтому всего в вычислении участвует GetThreadsCount() потоков.
+ */
+class ThreadPool {
+ public:
+  explicit ThreadPool(size_t threads_count = 0);
+
+  ThreadPool(const ThreadPool &) = delete;
+
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  ~ThreadPool();
+
+  size_t GetThreadsCount() const;
+
+  void ParallelFor(size_t count, size_t grain,
+                   const std::function<void(size_t, size_t)> &body);
+
+ private:
+  using Task = std::function<void()>;
+
+  /**
+   * @brief Очередь задач отдельного рабочего потока.
+   */
+  struct WorkQueue {
+    std::mutex mutex;        ///< Мьютекс очереди.
+    std::deque<Task> tasks;  ///< Задачи.
+  };
+
+  void Stop();
+
+  void Push(Task task);
+
+  bool PopTask(size_t index, Task &task);
+
+  void WorkerLoop(size_t index);
+
+  std::vector<std::unique_ptr<WorkQueue>> queues_;  ///< Очереди потоков.
+
+  std::vector<std::thread> workers_;  ///< Рабочие потоки.
+
+  std::atomic<size_t> next_queue_{0};  ///< Очередь для следующей задачи.
+
+  std::atomic<size_t> pending_{0};  ///< Количество задач в очередях.
+
+  std::mutex sleep_mutex_;  ///< Мьютекс для ожидания задач.
+
+  std::condition_variable wake_up_;  ///< Сигнал о появлении задач.
+
+  bool stop_ = false;  ///< Флаг остановки рабочих потоков.
+};
+
+}  // namespace s21
+
+#endif  // SMARTCALC_MODEL_THREAD_POOL_H_
@@ -1,8 +1,49 @@
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <new>
+#include <thread>
+
 #include "../controller/controller.h"
+#include "../model/arena.h"
+#include "../model/jit_compiler.h"
+#include "../model/lexer.h"
 #include "../model/model.h"
 
+namespace {
+
+/**
+ * @brief Сколько выделений памяти в этом потоке пройдет успешно, прежде чем
+ * operator new бросит std::bad_alloc (отрицательное значение - без отказов).
+ */
+thread_local long allocations_before_failure = -1;
+
+/**
+ * @brief Количество выделений памяти в этом потоке.
+ */
+thread_local size_t allocations_count = 0;
+
+}  // namespace
+
+void *operator new(size_t size) {
+  if (allocations_before_failure >= 0 && allocations_before_failure-- == 0) {
+    throw std::bad_alloc();
+  }
+  ++allocations_count;
+  void *memory = std::malloc(size != 0 ? size : 1);
+  if (memory == nullptr) {
+    throw std::bad_alloc();
+  }
+  return memory;
+}
+
+void operator delete(void *memory) noexcept { std::free(memory); }
+
+void operator delete(void *memory, size_t) noexcept { std::free(memory); }
+
 struct PNTest : public testing::Test {
   s21::PolishNotation pn;
   std::string input;
@@ -281,33 +322,1126 @@ TEST_F(PNTest, UncorrectNumbers) {
 
 TEST_F(PNTest, GraphTest1) {
   input = "x";
-  std::vector<std::pair<double, double>> pairs;
+  std::vector<double> x_data;
+  std::vector<double> y_data;
 
-  pairs = pn.GetGraph(input, -10, 10);
-  EXPECT_EQ(pairs.size(), 500);
+  pn.GetGraph(input, -10, 10, x_data, y_data);
+  EXPECT_EQ(x_data.size(), 500);
+  EXPECT_EQ(y_data.size(), 500);
   for (size_t i = 0; i < 500; i += 10) {
-    EXPECT_EQ(pairs[i].first, pairs[i].second);
+    EXPECT_EQ(x_data[i], y_data[i]);
   }
 }
 
 TEST_F(PNTest, GraphTest2) {
   input = "x^2";
-  std::vector<std::pair<double, double>> pairs;
+  std::vector<double> x_data;
+  std::vector<double> y_data;
 
-  pairs = pn.GetGraph(input, -10, 10);
-  EXPECT_EQ(pairs.size(), 500);
+  pn.GetGraph(input, -10, 10, x_data, y_data);
+  EXPECT_EQ(y_data.size(), 500);
+  EXPECT_EQ(x_data.front(), -10);
+  EXPECT_EQ(x_data.back(), 10);
   for (size_t i = 0; i < 500; i += 10) {
-    EXPECT_EQ(pairs[i].second, pow(pairs[i].first, 2));
+    EXPECT_EQ(y_data[i], pow(x_data[i], 2));
   }
 }
 
 TEST_F(PNTest, GraphTestExceptions) {
-  // утечка!!
+  std::vector<double> x_data;
+  std::vector<double> y_data;
+
   input = "x^";
-  EXPECT_THROW(pn.GetGraph(input, -10, 10), std::invalid_argument);
+  EXPECT_THROW(pn.GetGraph(input, -10, 10, x_data, y_data),
+               std::invalid_argument);
 
   input = "x+1";
-  EXPECT_THROW(pn.GetGraph(input, -10, -12), std::invalid_argument);
+  EXPECT_THROW(pn.GetGraph(input, -10, -12, x_data, y_data),
+               std::invalid_argument);
+}
+
+TEST_F(PNTest, CompiledExpression) {
+  input = "3 ^ x - sin(x) * 2";
+  s21::CompiledExpression expression = pn.Compile(input);
+  EXPECT_TRUE(expression.UsesX());
+  for (double value = -5; value <= 5; value += 0.25) {
+    EXPECT_EQ(expression.Evaluate(value), pow(3, value) - sin(value) * 2);
+  }
+
+  input = "-(2 + 3) mod 4";
+  expression = pn.Compile(input);
+  EXPECT_FALSE(expression.UsesX());
+  EXPECT_EQ(expression.Evaluate(0), -fmod(2 + 3, 4));
+
+  input = "2 + (* 4)";
+  EXPECT_THROW(pn.Compile(input), std::invalid_argument);
+
+  input = "1 + (x + (2 * 3))";
+  expression = pn.Compile(input);
+  EXPECT_EQ(expression.GetSize(), 5);
+  EXPECT_EQ(expression.GetMaxDepth(), 3);
+
+  input = "x";
+  for (int i = 0; i < 100; ++i) {
+    input = "1 + (" + input + ")";
+  }
+  expression = pn.Compile(input);
+  EXPECT_EQ(expression.GetMaxDepth(), 101);
+  EXPECT_EQ(expression.Evaluate(0.5), 100.5);
+
+  s21::Controller controller;
+  input = "x * x + 1";
+  expression = controller.CompileExpression(input);
+  EXPECT_EQ(expression.Evaluate(3), 10);
+}
+
+TEST_F(PNTest, ConstantFolding) {
+  input = "sqrt(2) * sin(x) + ln(10) ^ 2";
+  s21::CompiledExpression expression = pn.Compile(input);
+  EXPECT_EQ(expression.GetSize(), 6);
+  EXPECT_EQ(expression.Evaluate(0.3), sqrt(2) * sin(0.3) + pow(log(10), 2));
+
+  input = "-(x) + (+x) - (-(2 mod 3))";
+  expression = pn.Compile(input);
+  EXPECT_EQ(expression.GetSize(), 9);
+  EXPECT_EQ(expression.Evaluate(1.5), -1.5 + 1.5 - (-fmod(2, 3)));
+
+  input = "-(4 - 5) * cos(0)";
+  expression = pn.Compile(input);
+  EXPECT_EQ(expression.GetSize(), 1);
+  EXPECT_FALSE(expression.UsesX());
+  EXPECT_EQ(expression.Evaluate(0), 1);
+
+  const std::tuple<const char *, double, double> signed_zeros[] = {
+      {"1 / (0 + x)", -0.0, HUGE_VAL}, {"1 / (+x)", -0.0, HUGE_VAL},
+      {"1 / (0 - x)", 0.0, HUGE_VAL},  {"1 / (-x)", 0.0, HUGE_VAL},
+      {"1 / (x - 0)", -0.0, -HUGE_VAL}};
+  for (const auto &[text, value, expected] : signed_zeros) {
+    expression = pn.Compile(text);
+    double result = 0;
+    expression.Evaluate(&value, &result, 1);
+    EXPECT_EQ(expression.Evaluate(value), expected) << text;
+    EXPECT_EQ(result, expected) << text;
+  }
+
+  std::string plain = "x * 3 + 4";
+  std::string folded = "x * (sin(2) * cos(1) + 2.5) + ln(4) ^ 2 - 3";
+  pn.Compile(folded);
+  size_t before = allocations_count;
+  expression = pn.Compile(plain);
+  size_t plain_allocations = allocations_count - before;
+  before = allocations_count;
+  expression = pn.Compile(folded);
+  EXPECT_EQ(allocations_count - before, plain_allocations);
+
+  std::string padded = "x *" + std::string(65536, ' ') + "3 + 4";
+  before = allocations_count;
+  expression = pn.Compile(padded);
+  EXPECT_EQ(allocations_count - before, plain_allocations);
+}
+
+TEST_F(PNTest, StrengthReduction) {
+  input = "x ^ 2 + x ^ 0.5 - x ^ (-1) + x / 4 + x / (-0.5)";
+  s21::CompiledExpression expression = pn.Compile(input);
+  for (double value = 0.125; value < 10; value *= 1.7) {
+    EXPECT_EQ(expression.Evaluate(value), pow(value, 2) + pow(value, 0.5) -
+                                              pow(value, -1) + value / 4 +
+                                              value / (-0.5));
+  }
+
+  EXPECT_EQ(pn.Compile("+x/2").Evaluate(3), 1.5);
+  EXPECT_EQ(pn.Compile("0 + x/4").Evaluate(3), 0.75);
+  EXPECT_EQ(pn.Compile("(+x/8)*3").Evaluate(3), 1.125);
+  EXPECT_EQ(pn.Compile("-x/2 + (+x/2)").Evaluate(3), 0);
+  EXPECT_EQ(pn.Compile("(x/2)^1").Evaluate(3), 1.5);
+
+  for (const char *power : {"0.5", "-0.5", "1.5", "-1.5", "2.5"}) {
+    expression = pn.Compile(std::string("x ^ (") + power + ")");
+    double exponent = std::stod(power);
+    for (double value : {-0.0, 0.0, -HUGE_VAL, HUGE_VAL}) {
+      double expected = pow(value, exponent);
+      double actual = expression.Evaluate(value);
+      EXPECT_EQ(actual, expected) << power << " " << value;
+      EXPECT_EQ(std::signbit(actual), std::signbit(expected))
+          << power << " " << value;
+    }
+    std::vector<double> edges = {-0.0, -HUGE_VAL, 4, -1};
+    std::vector<double> edge_results(edges.size());
+    expression.Evaluate(edges.data(), edge_results.data(), edges.size());
+    EXPECT_EQ(edge_results[0], pow(-0.0, exponent));
+    EXPECT_FALSE(std::signbit(edge_results[0]));
+    EXPECT_EQ(edge_results[1], pow(-HUGE_VAL, exponent));
+    EXPECT_EQ(edge_results[2], pow(4, exponent));
+    EXPECT_TRUE(std::isnan(edge_results[3]));
+  }
+
+  input = "x ^ 7 - x ^ 2.5 + 3 mod x";
+  expression = pn.Compile(input);
+  for (double value = 0.5; value < 10; value += 0.75) {
+    double expected = pow(value, 7) - pow(value, 2.5) + fmod(3, value);
+    EXPECT_NEAR(expression.Evaluate(value), expected, 1e-14 * fabs(expected));
+  }
+
+  input = "3 * x ^ 3 - 2 * x ^ 2 + x * 0.5 - 7";
+  expression = pn.Compile(input);
+  EXPECT_EQ(expression.GetSize(), 2);
+  for (double value = -3; value < 3; value += 0.3) {
+    double expected =
+        3 * pow(value, 3) - 2 * pow(value, 2) + value * 0.5 - 7;
+    EXPECT_NEAR(expression.Evaluate(value), expected, 1e-13);
+  }
+
+  input = "(x + 1) ^ 3";
+  expression = pn.Compile(input);
+  EXPECT_EQ(expression.GetSize(), 4);
+  EXPECT_NEAR(expression.Evaluate(-1.001), pow(-0.001, 3), 1e-20);
+
+  std::vector<double> x_values = {-2, -0.5, 0, 0.25, 1, 7};
+  std::vector<double> results(x_values.size());
+  input = "x ^ 3 - x * 2 + x ^ 1.5 + 1";
+  expression = pn.Compile(input);
+  expression.Evaluate(x_values.data(), results.data(), x_values.size());
+  for (size_t i = 0; i < x_values.size(); ++i) {
+    double expected = expression.Evaluate(x_values[i]);
+    EXPECT_TRUE(results[i] == expected ||
+                (std::isnan(results[i]) && std::isnan(expected)));
+  }
+}
+
+TEST_F(PNTest, CommonSubexpressions) {
+  input = "sin(x)^2 + sin(x)*cos(x) + sin(x)";
+  s21::CompiledExpression expression = pn.Compile(input);
+  EXPECT_EQ(expression.GetSlotsCount(), 1);
+  for (double value = -2; value < 2; value += 0.1) {
+    EXPECT_EQ(expression.Evaluate(value),
+              pow(sin(value), 2) + sin(value) * cos(value) + sin(value));
+  }
+
+  input = "ln(x + 1) * (1 + x) - ln(x + 1) / ln(1 + x)";
+  expression = pn.Compile(input);
+  EXPECT_EQ(expression.GetSlotsCount(), 2);
+  std::vector<double> x_values = {0.5, 1, 2, 3.5};
+  std::vector<double> results(x_values.size());
+  expression.Evaluate(x_values.data(), results.data(), x_values.size());
+  for (size_t i = 0; i < x_values.size(); ++i) {
+    double value = x_values[i];
+    double expected =
+        log(value + 1) * (1 + value) - log(value + 1) / log(1 + value);
+    EXPECT_EQ(expression.Evaluate(value), expected);
+    EXPECT_EQ(results[i], expected);
+  }
+
+  input = "x * x + 2";
+  expression = pn.Compile(input);
+  EXPECT_EQ(expression.GetSlotsCount(), 0);
+}
+
+TEST_F(PNTest, JitCompilation) {
+  std::vector<std::string> expressions = {
+      "x",
+      "-x + 2.5",
+      "sin(x)^2 + sin(x)*cos(x) + sin(x)",
+      "3 * x ^ 3 - 2 * x ^ 2 + x * 0.5 - 7",
+      "sqrt(x) / (x + 1) - x ^ 2.5 + x mod 0.3",
+      "ln(x) - log(x) + atan(x) * acos(x / 10) - asin(x / 11) + tan(x)",
+      "2 ^ x / 4 - x ^ (-3)"};
+  std::vector<double> x_values;
+  for (double value = -1; value < 9; value += 0.37) {
+    x_values.push_back(value);
+  }
+  std::vector<double> results(x_values.size());
+  std::string deep = "x";
+  for (int i = 0; i < 16; ++i) {
+    deep = "x + 1 / (" + deep + ")";
+  }
+  expressions.push_back(deep);
+
+  for (std::string &text : expressions) {
+    s21::CompiledExpression interpreted = pn.Compile(text);
+    s21::CompiledExpression compiled = interpreted;
+    compiled.SetJitMode(s21::CompiledExpression::jit_always);
+    EXPECT_EQ(compiled.IsJitCompiled(), s21::JitFunction::IsSupported());
+    compiled.Evaluate(x_values.data(), results.data(), x_values.size());
+    for (size_t i = 0; i < x_values.size(); ++i) {
+      double expected = interpreted.Evaluate(x_values[i]);
+      double actual = compiled.Evaluate(x_values[i]);
+      if (std::isnan(expected)) {
+        EXPECT_TRUE(std::isnan(actual) && std::isnan(results[i]));
+      } else {
+        EXPECT_EQ(actual, expected) << text << " at " << x_values[i];
+        EXPECT_EQ(results[i], expected) << text << " at " << x_values[i];
+      }
+    }
+    for (size_t count = 1; count < 8; ++count) {
+      std::vector<double> tail(count);
+      compiled.Evaluate(x_values.data() + 1, tail.data(), count);
+      for (size_t i = 0; i < count; ++i) {
+        double expected = interpreted.Evaluate(x_values[i + 1]);
+        EXPECT_TRUE(tail[i] == expected ||
+                    (std::isnan(tail[i]) && std::isnan(expected)))
+            << text << " at " << x_values[i + 1];
+      }
+    }
+  }
+
+  input = "x * 2";
+  pn.SetJitMode(s21::CompiledExpression::jit_auto);
+  s21::CompiledExpression expression = pn.Compile(input);
+  EXPECT_FALSE(expression.IsJitCompiled());
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(expression.Evaluate(i), i * 2);
+  }
+  EXPECT_EQ(expression.IsJitCompiled(), s21::JitFunction::IsSupported());
+  EXPECT_EQ(expression.Evaluate(21), 42);
+}
+
+TEST_F(PNTest, BatchEvaluation) {
+  input = "(x + 1.5) * x / 3 - 2 ^ x + x mod 0.7 - sqrt(x) + cos(x)";
+  s21::CompiledExpression expression = pn.Compile(input);
+  std::vector<double> x_values(1003);
+  for (size_t i = 0; i < x_values.size(); ++i) {
+    x_values[i] = -3 + 0.01 * i;
+  }
+  std::vector<double> results(x_values.size());
+  expression.Evaluate(x_values.data(), results.data(), x_values.size());
+  for (size_t i = 0; i < x_values.size(); ++i) {
+    double expected = expression.Evaluate(x_values[i]);
+    if (std::isnan(expected)) {
+      EXPECT_TRUE(std::isnan(results[i]));
+    } else {
+      EXPECT_EQ(results[i], expected);
+    }
+  }
+
+  expression = pn.Compile("sqrt(x) * x / (x + 1) - x");
+  for (size_t count = 1; count <= 9; ++count) {
+    expression.Evaluate(x_values.data() + 400, results.data(), count);
+    for (size_t i = 0; i < count; ++i) {
+      EXPECT_EQ(results[i], expression.Evaluate(x_values[400 + i]));
+    }
+  }
+
+  expression = pn.Compile("sin(a) * x + sin(a) - cos(a) ^ 2 / x + a mod x");
+  for (size_t slot = 0; slot < 2; ++slot) {
+    double bindings[2] = {0.7, -1.3};
+    expression.Evaluate(bindings, slot, x_values.data(), results.data(),
+                        x_values.size());
+    for (size_t i = 0; i < x_values.size(); ++i) {
+      bindings[slot] = x_values[i];
+      double expected = expression.Evaluate(bindings, 2);
+      if (std::isnan(expected)) {
+        EXPECT_TRUE(std::isnan(results[i]));
+      } else {
+        EXPECT_EQ(results[i], expected);
+      }
+    }
+  }
+
+  s21::Controller controller;
+  input = "2 * x";
+  controller.CalculateBatch(input, {1, 2, 3}, results);
+  EXPECT_EQ(results, std::vector<double>({2, 4, 6}));
+}
+
+TEST_F(PNTest, ParallelGraph) {
+  input = "sin(x) * x";
+  std::vector<double> x_data;
+  std::vector<double> y_data;
+  pn.SetThreadsCount(4);
+  EXPECT_EQ(pn.GetThreadsCount(), 4);
+
+  pn.GetGraph(input, -100, 100, x_data, y_data, 100001);
+  EXPECT_EQ(x_data.size(), 100001);
+  EXPECT_EQ(y_data.size(), 100001);
+  EXPECT_EQ(x_data.front(), -100);
+  EXPECT_EQ(x_data.back(), 100);
+  for (size_t i = 0; i < x_data.size(); i += 997) {
+    EXPECT_EQ(y_data[i], sin(x_data[i]) * x_data[i]);
+  }
+}
+
+TEST_F(PNTest, AdaptiveGraph) {
+  std::vector<double> x_data;
+  std::vector<double> y_data;
+  s21::AdaptiveSampling settings;
+  settings.x_pixel = 20.0 / 800;
+  settings.y_pixel = 20.0 / 600;
+
+  input = "2 * x + 1";
+  pn.GetAdaptiveGraph(input, -10, 10, settings, x_data, y_data);
+  EXPECT_LE(x_data.size(), 2 * settings.initial_points);
+  EXPECT_EQ(x_data.front(), -10);
+  EXPECT_EQ(x_data.back(), 10);
+  EXPECT_TRUE(std::is_sorted(x_data.begin(), x_data.end()));
+
+  input = "sin(1 / x)";
+  pn.GetAdaptiveGraph(input, -1, 1, settings, x_data, y_data);
+  EXPECT_LE(x_data.size(), settings.max_points);
+  EXPECT_GT(x_data.size(), 2 * settings.initial_points);
+  for (size_t i = 0; i < x_data.size(); ++i) {
+    EXPECT_EQ(y_data[i], sin(1 / x_data[i]));
+  }
+
+  input = "sqrt(x)";
+  pn.GetAdaptiveGraph(input, -1, 1, settings, x_data, y_data);
+  size_t first_finite = std::find_if(y_data.begin(), y_data.end(),
+                                     [](double y) { return !std::isnan(y); }) -
+                        y_data.begin();
+  EXPECT_LT(x_data[first_finite] - x_data[first_finite - 1],
+            settings.x_pixel / 32);
+}
+
+TEST_F(PNTest, IntervalEvaluation) {
+  const char *expressions[] = {"x^2 - 3*x + 1", "sin(x) * cos(2*x)",
+                               "sqrt(x + 2) / (x + 3)", "atan(x) - ln(x + 4)",
+                               "x mod 0.7 + 2^x"};
+  for (const char *text : expressions) {
+    s21::CompiledExpression expression = pn.Compile(text);
+    for (double low = -1.5; low < 1.5; low += 0.37) {
+      s21::Interval enclosure = expression.EvaluateInterval({low, low + 0.4});
+      for (double x = low; x <= low + 0.4; x += 0.01) {
+        EXPECT_TRUE(enclosure.Contains(expression.Evaluate(x))) << text;
+      }
+    }
+  }
+
+  s21::CompiledExpression tangent = pn.Compile("tan(x)");
+  EXPECT_TRUE(tangent.EvaluateInterval({0, 1}).continuous);
+  EXPECT_FALSE(tangent.EvaluateInterval({1, 2}).continuous);
+  EXPECT_TRUE(pn.Compile("ln(x)").EvaluateInterval({-2, -1}).IsEmpty());
+
+  s21::Interval range = pn.GetGraphRange("x^2", -2, 3);
+  EXPECT_LE(range.low, 0);
+  EXPECT_GE(range.high, 9);
+  EXPECT_LT(range.high - range.low, 9.5);
+
+  range = pn.GetGraphRange("tan(x)", -3, 3);
+  EXPECT_FALSE(range.continuous);
+  EXPECT_TRUE(std::isfinite(range.low) && std::isfinite(range.high));
+  EXPECT_THROW(pn.GetGraphRange("x + y", -1, 1), std::invalid_argument);
+
+  std::vector<double> x_data;
+  std::vector<double> y_data;
+  s21::AdaptiveSampling settings;
+  settings.x_pixel = 6.0 / 800;
+  settings.y_pixel = 10.0 / 600;
+  settings.y_min = -5;
+  settings.y_max = 5;
+  pn.GetAdaptiveGraph("tan(x)", -3, 3, settings, x_data, y_data);
+  size_t breaks = std::count_if(y_data.begin(), y_data.end(),
+                                [](double y) { return std::isnan(y); });
+  EXPECT_EQ(breaks, 2);
+
+  size_t visible_points = x_data.size();
+  settings.y_min = 100;
+  settings.y_max = 110;
+  pn.GetAdaptiveGraph("x^3 - x", -3, 3, settings, x_data, y_data);
+  EXPECT_LE(x_data.size(), 2 * settings.initial_points);
+  settings.y_min = -5;
+  settings.y_max = 5;
+  pn.GetAdaptiveGraph("x^3 - x", -3, 3, settings, x_data, y_data);
+  EXPECT_GT(x_data.size(), 2 * settings.initial_points);
+  EXPECT_GT(visible_points, 2 * settings.initial_points);
+}
+
+TEST_F(PNTest, Derivatives) {
+  struct Case {
+    const char *text;
+    double (*first)(double);
+    double (*second)(double);
+  };
+  const Case cases[] = {
+      {"x^3 - 2*x", [](double x) { return 3 * x * x - 2; },
+       [](double x) { return 6 * x; }},
+      {"sin(x) * cos(x)", [](double x) { return cos(2 * x); },
+       [](double x) { return -2 * sin(2 * x); }},
+      {"sqrt(x) / x", [](double x) { return -0.5 * pow(x, -1.5); },
+       [](double x) { return 0.75 * pow(x, -2.5); }},
+      {"ln(x) + log(x)", [](double x) { return 1 / x + 1 / (x * log(10)); },
+       [](double x) { return -1 / (x * x) - 1 / (x * x * log(10)); }},
+      {"atan(x) + asin(x / 2)",
+       [](double x) { return 1 / (1 + x * x) + 1 / sqrt(4 - x * x); },
+       [](double x) {
+         return -2 * x / pow(1 + x * x, 2) + x / pow(4 - x * x, 1.5);
+       }},
+      {"x^x", [](double x) { return pow(x, x) * (log(x) + 1); },
+       [](double x) {
+         return pow(x, x) * (pow(log(x) + 1, 2) + 1 / x);
+       }},
+      {"tan(x) + x mod 0.3", [](double x) { return 1 / pow(cos(x), 2) + 1; },
+       [](double x) { return 2 * tan(x) / pow(cos(x), 2); }},
+  };
+  for (const Case &test : cases) {
+    s21::CompiledExpression expression = pn.Compile(test.text);
+    for (double x = 0.25; x < 1.5; x += 0.125) {
+      s21::Dual result = expression.EvaluateDerivative(x);
+      EXPECT_EQ(result.value, expression.Evaluate(x)) << test.text;
+      EXPECT_NEAR(result.first, test.first(x),
+                  1e-9 * fabs(test.first(x)) + 1e-12)
+          << test.text;
+      EXPECT_NEAR(result.second, test.second(x),
+                  1e-9 * fabs(test.second(x)) + 1e-12)
+          << test.text;
+    }
+  }
+
+  s21::CompiledExpression surface = pn.Compile("x * y^2");
+  double bindings[] = {3, 2};
+  EXPECT_EQ(surface.EvaluateDerivative(bindings, 2, 1).first, 12);
+  EXPECT_EQ(surface.EvaluateDerivative(bindings, 2, 0).first, 4);
+
+  std::vector<double> x_data;
+  std::vector<double> y_data;
+  std::vector<double> dy_data;
+  pn.GetDerivativeGraph("x^2 + 1", -1, 1, x_data, y_data, dy_data, 101);
+  ASSERT_EQ(dy_data.size(), 101);
+  for (size_t i = 0; i < x_data.size(); ++i) {
+    EXPECT_EQ(y_data[i], x_data[i] * x_data[i] + 1);
+    EXPECT_DOUBLE_EQ(dy_data[i], 2 * x_data[i]);
+  }
+}
+
+TEST_F(PNTest, SymbolicDerivatives) {
+  EXPECT_EQ(pn.Differentiate("x^3 + 2*x + 1"), "3*x^2+2");
+  EXPECT_EQ(pn.Differentiate("sin(x)"), "cos(x)");
+  EXPECT_EQ(pn.Differentiate("-cos(X)"), "sin(x)");
+  EXPECT_EQ(pn.Differentiate("5 + y"), "0");
+  EXPECT_EQ(pn.Differentiate("x * y", "y"), "x");
+  EXPECT_EQ(pn.Differentiate("x^4", "x", 2), "12*x^2");
+  EXPECT_EQ(pn.Differentiate("x^2", "x", 0), "x^2");
+  EXPECT_THROW(pn.Differentiate("sin(x"), std::invalid_argument);
+
+  const char *expressions[] = {
+      "sin(x) * cos(2*x)", "tan(x) / (x + 2)",  "sqrt(x) + ln(x) - log(x)",
+      "acos(x / 2) * asin(x / 3)", "atan(x^2)", "x^x",
+      "2^x - x^0.5",         "x mod 0.3",        "-x^3 + (-2)*x",
+      "(x + 1)^(-2)"};
+  for (const char *text : expressions) {
+    s21::CompiledExpression expression = pn.Compile(text);
+    s21::CompiledExpression first = pn.Compile(pn.Differentiate(text));
+    s21::CompiledExpression second =
+        pn.Compile(pn.Differentiate(text, "x", 2));
+    for (double x = 0.3; x < 1.5; x += 0.1) {
+      s21::Dual exact = expression.EvaluateDerivative(x);
+      EXPECT_NEAR(first.Evaluate(x), exact.first,
+                  1e-9 * fabs(exact.first) + 1e-12)
+          << text;
+      EXPECT_NEAR(second.Evaluate(x), exact.second,
+                  1e-9 * fabs(exact.second) + 1e-12)
+          << text;
+    }
+  }
+
+  s21::Controller controller;
+  s21::CompiledExpression derivative =
+      controller.CompileDerivative("x^2 * sin(x)");
+  EXPECT_DOUBLE_EQ(derivative.Evaluate(1), 2 * sin(1) + cos(1));
+  EXPECT_EQ(controller.DifferentiateExpression("x^2"), "2*x");
+}
+
+TEST_F(PNTest, CriticalPoints) {
+  using Kind = s21::CriticalPoint::Kind;
+  std::vector<s21::CriticalPoint> points =
+      pn.FindCriticalPoints("x^3 - x", -2, 2);
+  ASSERT_EQ(points.size(), 5);
+  EXPECT_EQ(points[0].kind, Kind::cp_root);
+  EXPECT_NEAR(points[0].x, -1, 1e-12);
+  EXPECT_EQ(points[1].kind, Kind::cp_maximum);
+  EXPECT_NEAR(points[1].x, -1 / sqrt(3), 1e-12);
+  EXPECT_EQ(points[2].kind, Kind::cp_root);
+  EXPECT_NEAR(points[2].x, 0, 1e-12);
+  EXPECT_EQ(points[3].kind, Kind::cp_minimum);
+  EXPECT_NEAR(points[3].x, 1 / sqrt(3), 1e-12);
+  EXPECT_NEAR(points[3].y, -2 / (3 * sqrt(3)), 1e-12);
+  EXPECT_EQ(points[4].kind, Kind::cp_root);
+  EXPECT_NEAR(points[4].x, 1, 1e-12);
+
+  points = pn.FindCriticalPoints("tan(x)", -3, 3);
+  ASSERT_EQ(points.size(), 1);
+  EXPECT_NEAR(points[0].x, 0, 1e-12);
+
+  points = pn.FindCriticalPoints("sin(50 * x)", 0, 10);
+  size_t roots = std::count_if(points.begin(), points.end(), [](auto &p) {
+    return p.kind == Kind::cp_root;
+  });
+  EXPECT_EQ(roots, 160);
+  EXPECT_EQ(points.size(), 319);
+  for (const s21::CriticalPoint &point : points) {
+    double k = point.x * 50 / (M_PI / 2);
+    EXPECT_NEAR(k, std::round(k), 1e-9);
+  }
+  EXPECT_THROW(pn.FindCriticalPoints("x", 1, 1), std::invalid_argument);
+}
+
+TEST_F(PNTest, Integration) {
+  s21::IntegrationResult result = pn.Integrate("3 * x^2 - 2 * x + 1", 0, 2);
+  EXPECT_NEAR(result.value, 6, 1e-12);
+  EXPECT_TRUE(result.converged);
+  EXPECT_EQ(result.evaluations % 15, 0);
+  EXPECT_LE(result.error, 1e-10);
+
+  result = pn.Integrate("sqrt(x)", 0, 1);
+  EXPECT_NEAR(result.value, 2.0 / 3, 1e-10);
+  EXPECT_TRUE(result.converged);
+  EXPECT_LT(result.evaluations, 10000);
+
+  result = pn.Integrate("sin(x)", M_PI, 0);
+  EXPECT_NEAR(result.value, -2, 1e-12);
+
+  s21::Integration settings;
+  settings.absolute_tolerance = 1e-6;
+  settings.relative_tolerance = 0;
+  result = pn.Integrate("sin(1 / x)", 0, 1, settings);
+  EXPECT_NEAR(result.value, 0.504067061906928, 1e-5);
+  EXPECT_LE(result.intervals, settings.max_intervals);
+
+  EXPECT_EQ(pn.Integrate("x", 1, 1).value, 0);
+  EXPECT_THROW(pn.Integrate("x", 0, INFINITY), std::invalid_argument);
+  EXPECT_THROW(pn.Integrate("x * y", 0, 1), std::invalid_argument);
+}
+
+TEST_F(PNTest, CalculateMany) {
+  std::vector<std::string_view> expressions = {"x^2", "2 + 2", "x^2", "x",
+                                               "1 +* 2", "sin(x)"};
+  std::vector<std::string_view> x_values = {"3", "", "0.5", "", "1", "0"};
+  std::vector<s21::Result<double>> results(expressions.size(), 0.0);
+  pn.TryCalculateMany(expressions.data(), x_values.data(), expressions.size(),
+                      results.data());
+  EXPECT_EQ(results[0].GetValue(), 9);
+  EXPECT_EQ(results[1].GetValue(), 4);
+  EXPECT_EQ(results[2].GetValue(), 0.25);
+  EXPECT_EQ(results[3].GetError().code, s21::err_empty_x);
+  EXPECT_EQ(results[4].GetError().code, s21::err_incorrect_input);
+  EXPECT_EQ(results[5].GetValue(), 0);
+
+  size_t count = 100000;
+  std::vector<std::string> x_strings(count);
+  expressions.assign(count, "x * 2 + 1");
+  x_values.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    x_strings[i] = std::to_string(i);
+    x_values[i] = x_strings[i];
+  }
+  expressions[count / 2] = "ln(x)";
+  results.assign(count, 0.0);
+  s21::Controller controller;
+  controller.SetThreadsCount(4);
+  controller.TryCalculateMany(expressions.data(), x_values.data(), count,
+                              results.data());
+  for (size_t i = 0; i < count; ++i) {
+    double expected = i == count / 2 ? std::log(i) : i * 2.0 + 1;
+    ASSERT_EQ(results[i].GetValue(), expected);
+  }
+
+  count = 16 * 1024;
+  bool partial = false;
+  for (long failure = 0; failure < 40; ++failure) {
+    results.assign(count, 0.0);
+    allocations_before_failure = failure;
+    controller.TryCalculateMany(expressions.data(), x_values.data(), count,
+                                results.data());
+    allocations_before_failure = -1;
+    size_t computed = 0;
+    for (size_t i = 0; i < count; ++i) {
+      if (results[i]) {
+        ASSERT_EQ(results[i].GetValue(), i * 2.0 + 1);
+        ++computed;
+      } else {
+        ASSERT_EQ(results[i].GetError().code, s21::err_out_of_memory);
+      }
+    }
+    partial = partial || (computed != 0 && computed != count);
+  }
+  EXPECT_TRUE(partial);
+}
+
+TEST_F(PNTest, EvaluateColumn) {
+  std::filesystem::path directory = std::filesystem::temp_directory_path();
+  std::string input_path = (directory / "smartcalc_column_x.bin").string();
+  std::string output_path = (directory / "smartcalc_column_y.bin").string();
+  size_t count = (1 << 20) * 2 + 3;
+  std::vector<double> x_values(count);
+  for (size_t i = 0; i < count; ++i) {
+    x_values[i] = i * 0.001;
+  }
+  std::ofstream(input_path, std::ios::binary)
+      .write(reinterpret_cast<const char *>(x_values.data()),
+             count * sizeof(double));
+
+  EXPECT_EQ(pn.EvaluateColumn("x^2 - 1", input_path, output_path), count);
+  std::vector<double> y_values(count + 1);
+  std::ifstream output(output_path, std::ios::binary);
+  output.read(reinterpret_cast<char *>(y_values.data()),
+              (count + 1) * sizeof(double));
+  ASSERT_EQ(output.gcount(), count * sizeof(double));
+  for (size_t i = 0; i < count; ++i) {
+    ASSERT_EQ(y_values[i], x_values[i] * x_values[i] - 1);
+  }
+
+  s21::Controller controller;
+  EXPECT_THROW(controller.EvaluateColumn("x", input_path, input_path),
+               std::invalid_argument);
+  EXPECT_THROW(controller.EvaluateColumn("x * y", input_path, output_path),
+               std::invalid_argument);
+  std::ofstream(input_path, std::ios::binary).write("1234", 4);
+  EXPECT_THROW(controller.EvaluateColumn("x", input_path, output_path),
+               std::invalid_argument);
+  std::ofstream(input_path, std::ios::binary | std::ios::trunc);
+  EXPECT_EQ(controller.EvaluateColumn("x", input_path, output_path), 0);
+  EXPECT_EQ(std::filesystem::file_size(output_path), 0);
+
+  s21::PolishNotation fresh;
+  fresh.SetThreadsCount(2);
+  s21::CompiledExpression column = fresh.Compile("x");
+  allocations_before_failure = 0;
+  s21::Result<size_t> failed =
+      fresh.TryEvaluateColumn(column, input_path, output_path);
+  allocations_before_failure = -1;
+  ASSERT_FALSE(failed);
+  EXPECT_EQ(failed.GetError().code, s21::err_out_of_memory);
+  EXPECT_EQ(s21::GetErrorMessage(s21::err_system_resource),
+            "System resource unavailable");
+  std::filesystem::remove(input_path);
+  std::filesystem::remove(output_path);
+  EXPECT_THROW(controller.EvaluateColumn("x", input_path, output_path),
+               std::invalid_argument);
+}
+
+TEST_F(PNTest, ExpressionCache) {
+  EXPECT_EQ(pn.Normalize("2.50*X + SIN( x )"), "2.5*x+sin(x)");
+  EXPECT_EQ(pn.Normalize("1 2"), "1 2");
+  EXPECT_EQ(pn.Normalize("x mod 0.70"), "x mod 0.7");
+
+  s21::Controller controller;
+  input = "2.50*X";
+  x = "2";
+  EXPECT_EQ(controller.CalculateValue(input, x), 5);
+  input = "2.5 * x";
+  EXPECT_EQ(controller.CalculateValue(input, x), 5);
+  s21::CacheStatistics statistics = controller.GetCacheStatistics();
+  EXPECT_EQ(statistics.hits, 1);
+  EXPECT_EQ(statistics.misses, 1);
+  EXPECT_EQ(statistics.entries, 1);
+
+  input = "1 2";
+  EXPECT_THROW(controller.CalculateValue(input, x), std::invalid_argument);
+  EXPECT_EQ(controller.GetCacheStatistics().entries, 1);
+
+  size_t budget = statistics.bytes + statistics.bytes / 2;
+  controller.SetCacheBudget(budget);
+  input = "x + 1";
+  EXPECT_EQ(controller.CalculateValue(input, x), 3);
+  statistics = controller.GetCacheStatistics();
+  EXPECT_EQ(statistics.entries, 1);
+  EXPECT_LE(statistics.bytes, budget);
+  input = "2.5*x";
+  EXPECT_EQ(controller.CalculateValue(input, x), 5);
+  EXPECT_EQ(controller.GetCacheStatistics().misses, 4);
+
+  controller.SetCacheBudget(0);
+  EXPECT_EQ(controller.CalculateValue(input, x), 5);
+  EXPECT_EQ(controller.GetCacheStatistics().entries, 0);
+}
+
+TEST(ControllerTest, CacheGraphsAndJit) {
+  s21::Controller controller;
+  std::vector<double> x_data, y_data;
+  controller.GetDataForGraph("x^2", -1, 1, x_data, y_data);
+  EXPECT_LE(controller.GetRangeForGraph("x ^ 2", -1, 1).low, 0);
+  EXPECT_NEAR(controller.Integrate("X^2", 0, 3).value, 9, 1e-9);
+  s21::CacheStatistics statistics = controller.GetCacheStatistics();
+  EXPECT_EQ(statistics.misses, 1);
+  EXPECT_EQ(statistics.hits, 2);
+  EXPECT_THROW(controller.GetDataForGraph("x^", -1, 1, x_data, y_data),
+               std::invalid_argument);
+  EXPECT_EQ(controller.GetCacheStatistics().entries, 1);
+
+  if (!s21::JitFunction::IsSupported()) {
+    return;
+  }
+  controller.SetJitMode(s21::CompiledExpression::jit_auto);
+  std::vector<double> x_values(2000, 1.5), results;
+  controller.CalculateBatch("x * 3 + 1", x_values, results);
+  size_t bytes = controller.GetCacheStatistics().bytes;
+  controller.CalculateBatch("x * 3 + 1", x_values, results);
+  EXPECT_GE(controller.GetCacheStatistics().bytes, bytes + 4096);
+  EXPECT_EQ(results[0], 5.5);
+}
+
+TEST_F(PNTest, OperatorTable) {
+  const std::pair<const char *, double> cases[] = {
+      {"cos(0.3)", cos(0.3)},
+      {"sin(0.3)", sin(0.3)},
+      {"tan(0.3)", tan(0.3)},
+      {"acos(0.3)", acos(0.3)},
+      {"asin(0.3)", asin(0.3)},
+      {"atan(0.3)", atan(0.3)},
+      {"ln(0.3)", log(0.3)},
+      {"log(0.3)", log10(0.3)},
+      {"sqrt(0.3)", sqrt(0.3)},
+      {"0.3^0.7", pow(0.3, 0.7)},
+      {"0.3*0.7", 0.3 * 0.7},
+      {"0.3/0.7", 0.3 / 0.7},
+      {"0.7 mod 0.3", fmod(0.7, 0.3)},
+      {"0.3+0.7", 0.3 + 0.7},
+      {"0.3-0.7", 0.3 - 0.7},
+      {"-sqrt(4)^2", -4}};
+  for (const auto &[expression, expected] : cases) {
+    input = expression;
+    pn.Calculate(input, x);
+    EXPECT_DOUBLE_EQ(pn.GetAnswer(), expected) << expression;
+  }
+
+  s21::PolishNotation fresh;
+  fresh.SetThreadsCount(3);
+  EXPECT_EQ(fresh.GetThreadsCount(), 3);
+}
+
+TEST_F(PNTest, ErrorPositions) {
+  const std::pair<const char *, const char *> cases[] = {
+      {"2+*3", "Incorrect input at position 3"},
+      {"-5 +", "Incorrect input at position 4"},
+      {"(-x)(1)", "Incorrect input at position 5"},
+      {"2 $ 3", "Incorrect symbol in input expression at position 3"},
+      {"2+sin", "Incorrect input at position 3"},
+      {"1+2.5.1", "Incorrect number at position 3"}};
+  for (const auto &[expression, message] : cases) {
+    input = expression;
+    try {
+      pn.Calculate(input, x);
+      ADD_FAILURE() << expression;
+    } catch (const std::invalid_argument &ex) {
+      EXPECT_STREQ(ex.what(), message);
+    }
+  }
+}
+
+TEST_F(PNTest, ResultApi) {
+  const std::tuple<const char *, const char *, s21::ErrorCode, size_t> cases[] =
+      {{"2+*3", "1", s21::err_incorrect_input, 2},
+       {"2 $ 3", "1", s21::err_incorrect_symbol, 2},
+       {"1+2.5.1", "1", s21::err_incorrect_number, 2},
+       {"(1+2", "1", s21::err_incorrect_brackets,
+        s21::CalculationError::kNoPosition},
+       {"", "1", s21::err_empty_input, s21::CalculationError::kNoPosition},
+       {"x+1", "", s21::err_empty_x, s21::CalculationError::kNoPosition},
+       {"x+1", "1e", s21::err_invalid_x, s21::CalculationError::kNoPosition}};
+  for (const auto &[expression, x_value, code, position] : cases) {
+    s21::Result<double> result = pn.TryCalculate(expression, x_value);
+    ASSERT_FALSE(result) << expression;
+    EXPECT_EQ(result.GetError().code, code) << expression;
+    EXPECT_EQ(result.GetError().position, position) << expression;
+    try {
+      pn.Calculate(expression, x_value);
+      ADD_FAILURE() << expression;
+    } catch (const std::invalid_argument &ex) {
+      EXPECT_EQ(ex.what(), result.GetError().GetMessage());
+    }
+  }
+  s21::Result<double> answer = pn.TryCalculate("2^x mod 5", "3");
+  ASSERT_TRUE(answer);
+  EXPECT_EQ(answer.GetValue(), 3);
+  EXPECT_EQ(answer.GetError().code, s21::err_none);
+
+  s21::Controller controller;
+  std::vector<double> results;
+  s21::CalculationError error =
+      controller.TryCalculateBatch("1 +  * x", {1, 2}, results);
+  EXPECT_EQ(error.code, s21::err_incorrect_input);
+  EXPECT_EQ(error.position, 5);
+  EXPECT_EQ(controller.TryCalculateValue("x*x", "3").GetValue(), 9);
+  EXPECT_FALSE(controller.TryCompileExpression("sin("));
+  error = controller.TryCalculateBatch("2.50 * X +", {1}, results);
+  EXPECT_EQ(error.code, s21::err_incorrect_input);
+  EXPECT_EQ(error.position, 9);
+  EXPECT_EQ(controller.CompileExpression("OMEGA * X").GetVariables(),
+            std::vector<std::string>({"omega", "x"}));
+}
+
+TEST_F(PNTest, Variables) {
+  s21::CompiledExpression expression =
+      pn.Compile("a*X^2 + k*sin(omega*t) + x mod 3 + A");
+  EXPECT_EQ(expression.GetVariables(),
+            std::vector<std::string>({"a", "x", "k", "omega", "t"}));
+  EXPECT_EQ(expression.FindVariable("OMEGA"), 3);
+  EXPECT_EQ(expression.FindVariable("y"), -1);
+  EXPECT_TRUE(expression.UsesX());
+
+  auto expected = [](const std::vector<double> &v) {
+    return v[0] * pow(v[1], 2) + v[2] * sin(v[3] * v[4]) + fmod(v[1], 3) +
+           v[0];
+  };
+  std::vector<double> bindings = {2, 1.5, 0.5, 3, 0.25};
+  for (auto mode : {s21::CompiledExpression::jit_off,
+                    s21::CompiledExpression::jit_always}) {
+    expression.SetJitMode(mode);
+    for (double t : {0.0, 0.5, 1.0}) {
+      bindings[4] = t;
+      EXPECT_DOUBLE_EQ(expression.Evaluate(bindings.data(), bindings.size()),
+                       expected(bindings));
+    }
+    EXPECT_TRUE(std::isnan(expression.Evaluate(bindings.data(), 2)));
+    EXPECT_TRUE(std::isnan(expression.Evaluate(1.0)));
+
+    std::vector<double> times = {0.1, 0.2, 0.3, 0.4, 0.5};
+    std::vector<double> results(times.size());
+    expression.Evaluate(bindings.data(), 4, times.data(), results.data(),
+                        times.size());
+    for (size_t i = 0; i < times.size(); ++i) {
+      bindings[4] = times[i];
+      EXPECT_EQ(results[i],
+                expression.Evaluate(bindings.data(), bindings.size()));
+    }
+    expression.Evaluate(nullptr, 4, times.data(), results.data(),
+                        times.size());
+    for (double result : results) {
+      EXPECT_TRUE(std::isnan(result));
+    }
+
+    s21::CompiledExpression cubic = pn.Compile("y^3-y");
+    cubic.SetJitMode(mode);
+    cubic.Evaluate(nullptr, 0, times.data(), results.data(), times.size());
+    EXPECT_DOUBLE_EQ(results[1], pow(0.2, 3) - 0.2);
+    cubic.Evaluate(nullptr, 1, times.data(), results.data(), times.size());
+    EXPECT_TRUE(std::isnan(results[0]));
+  }
+
+  s21::CompiledExpression polynomial = pn.Compile("x^2 + y^2 + x*y");
+  double point[] = {3, 4};
+  EXPECT_EQ(polynomial.Evaluate(point, 2), 9 + 16 + 12);
+  EXPECT_EQ(pn.Compile("y^3-y").Evaluate(2), 6);
+  EXPECT_EQ(pn.Calculate("2.5*xmod2", "1.5"), fmod(2.5 * 1.5, 2));
+  EXPECT_EQ(pn.Calculate("7mod(x)", "4"), 3);
+  EXPECT_EQ(pn.Compile("model*2 + xmodk").GetVariables(),
+            std::vector<std::string>({"model", "xmodk"}));
+  EXPECT_EQ(pn.Compile("sinx").GetVariables(),
+            std::vector<std::string>({"sinx"}));
+  EXPECT_THROW(pn.Calculate("sinx", "1"), std::invalid_argument);
+  EXPECT_THROW(pn.Calculate("x + y", "1"), std::invalid_argument);
+  EXPECT_EQ(pn.Normalize("Omega * X"), "omega*x");
+}
+
+TEST(ArenaTest, Reset) {
+  s21::Arena arena(256);
+  void *first = arena.allocate(100, 8);
+  void *second = arena.allocate(100, 64);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(second) % 64, 0);
+  void *large = arena.allocate(1000, 8);
+  EXPECT_NE(first, second);
+  EXPECT_NE(second, large);
+  size_t capacity = arena.GetCapacity();
+  EXPECT_GE(capacity, 1200);
+
+  arena.Reset();
+  EXPECT_EQ(arena.allocate(100, 8), first);
+  for (int i = 0; i < 10; ++i) {
+    arena.Reset();
+    std::pmr::vector<int> values(&arena);
+    for (int j = 0; j < 200; ++j) {
+      values.push_back(j);
+    }
+  }
+  EXPECT_LE(arena.GetCapacity(), capacity + 4096);
+}
+
+TEST_F(PNTest, LongExpression) {
+  input = "0";
+  for (int i = 1; i <= 5000; ++i) {
+    input += "+sin(x*" + std::to_string(i) + ")";
+  }
+  x = "0.5";
+  double expected = 0;
+  for (int i = 1; i <= 5000; ++i) {
+    expected += sin(0.5 * i);
+  }
+  for (int repeat = 0; repeat < 3; ++repeat) {
+    pn.Calculate(input, x);
+    EXPECT_NEAR(pn.GetAnswer(), expected, 1e-9);
+  }
+}
+
+TEST(LexerTest, ToLower) {
+  EXPECT_EQ(s21::ToLower('Q'), 'q');
+  EXPECT_EQ(s21::ToLower('q'), 'q');
+  EXPECT_EQ(s21::ToLower('@'), '@');
+  EXPECT_EQ(s21::ToLower('_'), '_');
+  EXPECT_EQ(s21::ToLower('['), '[');
+  EXPECT_TRUE(s21::IsSameName("Omega_1", "oMEGA_1"));
+  EXPECT_FALSE(s21::IsSameName("a_", "A\x7f"));
+  EXPECT_FALSE(s21::IsSameName("a@", "a`"));
+  EXPECT_FALSE(s21::IsSameName("ab", "abc"));
+
+  s21::CompiledExpression expression = s21::PolishNotation().Compile("Xy_2");
+  EXPECT_EQ(expression.FindVariable("XY_2"), 0);
+  EXPECT_EQ(expression.FindVariable("xy\x7f" "2"), -1);
+}
+
+TEST(LexerTest, Tokens) {
+  std::string expression = "2.5E3*Sqrt(x) mod 1e-2";
+  s21::Lexer lexer(expression);
+  std::vector<s21::Lexer::TokenKind> kinds;
+  for (s21::Lexer::Token token = lexer.Next(); token.kind != s21::Lexer::tk_end;
+       token = lexer.Next()) {
+    kinds.push_back(token.kind);
+    if (token.position == 0) {
+      EXPECT_EQ(token.value, 2500);
+      EXPECT_EQ(token.length, 5);
+    } else if (token.position == 6) {
+      EXPECT_EQ(token.keyword, s21::Lexer::kw_sqrt);
+    } else if (token.position == 14) {
+      EXPECT_EQ(token.keyword, s21::Lexer::kw_mod);
+    } else if (token.position == 18) {
+      EXPECT_EQ(token.value, 0.01);
+    }
+  }
+  EXPECT_EQ(kinds.size(), 8);
+  EXPECT_EQ(expression, "2.5E3*Sqrt(x) mod 1e-2");
+
+  std::string_view truncated("2+1e5", 4);
+  s21::Lexer truncated_lexer(truncated);
+  truncated_lexer.Next();
+  truncated_lexer.Next();
+  EXPECT_THROW(truncated_lexer.Next(), std::invalid_argument);
+
+  s21::Lexer words("Omega_2*xmod k sinx model");
+  std::vector<s21::Lexer::TokenKind> word_kinds;
+  for (s21::Lexer::Token token = words.Next(); token.kind != s21::Lexer::tk_end;
+       token = words.Next()) {
+    word_kinds.push_back(token.kind);
+  }
+  EXPECT_EQ(word_kinds, std::vector<s21::Lexer::TokenKind>(
+                            {s21::Lexer::tk_name, s21::Lexer::tk_symbol,
+                             s21::Lexer::tk_name, s21::Lexer::tk_keyword,
+                             s21::Lexer::tk_name, s21::Lexer::tk_name,
+                             s21::Lexer::tk_name}));
+
+  size_t position = 0;
+  EXPECT_THROW(s21::Lexer::ParseNumber("1e400", position),
+               std::invalid_argument);
+  position = 0;
+  EXPECT_THROW(s21::Lexer::ParseNumber("1e5.3", position),
+               std::invalid_argument);
+  position = 0;
+  EXPECT_EQ(s21::Lexer::ParseNumber("1.e2+x", position), 100);
+  EXPECT_EQ(position, 4);
+}
+
+TEST(ControllerTest, ConcurrentCalls) {
+  s21::Controller controller;
+  controller.SetCacheBudget(4096);
+  const char *expressions[] = {"sin(x)^2+cos(x)^2", "x^3-2*x", "ln(x)+1",
+                               "sqrt(x)*(x mod 3)", "2+*3"};
+  std::vector<std::thread> threads;
+  std::vector<int> mismatches(4);
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < 200; ++i) {
+        double x = 1 + (t * 200 + i) * 0.01;
+        std::string x_value = std::to_string(x);
+        for (const char *expression : expressions) {
+          try {
+            double actual = controller.CalculateValue(expression, x_value);
+            double expected =
+                s21::PolishNotation().Calculate(expression, x_value);
+            mismatches[t] += actual != expected;
+          } catch (const std::invalid_argument &ex) {
+            mismatches[t] += std::string(ex.what()) !=
+                             "Incorrect input at position 3";
+          }
+        }
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(std::count(mismatches.begin(), mismatches.end(), 0), 4);
+  s21::CacheStatistics statistics = controller.GetCacheStatistics();
+  EXPECT_EQ(statistics.hits + statistics.misses, 4 * 200 * 5);
+}
+
+TEST(ThreadPoolTest, ParallelFor) {
+  s21::ThreadPool pool(3);
+  std::vector<int> visits(10000);
+  pool.ParallelFor(visits.size(), 64, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      ++visits[i];
+    }
+  });
+  EXPECT_EQ(std::count(visits.begin(), visits.end(), 1), 10000);
+
+  EXPECT_THROW(pool.ParallelFor(1000, 10,
+                                [](size_t begin, size_t) {
+                                  if (begin == 500) {
+                                    throw std::runtime_error("chunk");
+                                  }
+                                }),
+               std::runtime_error);
+
+  for (long failure = 0; failure < 40; ++failure) {
+    std::vector<std::atomic<int>> chunk_visits(64);
+    bool failed = false;
+    allocations_before_failure = failure;
+    try {
+      pool.ParallelFor(
+          chunk_visits.size() * 10, 10,
+          [&](size_t begin, size_t) { ++chunk_visits[begin / 10]; });
+    } catch (const std::bad_alloc &ex) {
+      failed = true;
+    }
+    allocations_before_failure = -1;
+    size_t visited = 0;
+    for (std::atomic<int> &visits : chunk_visits) {
+      EXPECT_LE(visits.load(), 1);
+      visited += visits.load();
+    }
+    if (!failed) {
+      EXPECT_EQ(visited, chunk_visits.size());
+    }
+  }
+
+  for (long failure = 0; failure < 20; ++failure) {
+    allocations_before_failure = failure;
+    try {
+      s21::ThreadPool failing(4);
+      allocations_before_failure = -1;
+      EXPECT_EQ(failing.GetThreadsCount(), 4);
+    } catch (const std::bad_alloc &ex) {
+    }
+    allocations_before_failure = -1;
+  }
+}
+
+TEST_F(PNTest, Surface) {
+  s21::SurfaceGrid grid;
+  grid.x_min = -2;
+  grid.x_max = 3;
+  grid.y_min = -1;
+  grid.y_max = 4;
+  grid.width = 1500;
+  grid.height = 37;
+  std::vector<double> z(grid.width * grid.height);
+  pn.GetSurface("Y*sin(x) + x^2", grid, z.data());
+  double x_step = (grid.x_max - grid.x_min) / (grid.width - 1);
+  double y_step = (grid.y_max - grid.y_min) / (grid.height - 1);
+  for (size_t row = 0; row < grid.height; row += 4) {
+    double y_value = grid.y_min + row * y_step;
+    for (size_t column = 0; column < grid.width; column += 7) {
+      double x_value = grid.x_min + column * x_step;
+      EXPECT_NEAR(z[row * grid.width + column],
+                  y_value * sin(x_value) + x_value * x_value, 1e-9);
+    }
+  }
+  EXPECT_NEAR(z.back(), 4 * sin(3) + 9, 1e-9);
+
+  pn.GetSurface("2*y", grid, z.data());
+  EXPECT_DOUBLE_EQ(z[0], -2);
+  EXPECT_DOUBLE_EQ(z[grid.width - 1], -2);
+  EXPECT_DOUBLE_EQ(z.back(), 8);
+
+  EXPECT_THROW(pn.GetSurface("x*z", grid, z.data()), std::invalid_argument);
+  grid.width = 1;
+  EXPECT_THROW(pn.GetSurface("x*y", grid, z.data()), std::invalid_argument);
 }
 
 int main(int argc, char **argv) {
@@ -1,7 +1,33 @@
 #include "graph.h"
 
+#include <algorithm>
+#include <memory>
+
 #include "./ui_graph.h"
 
+namespace {
+
+/**
+ * @brief Данные тепловой карты с доступом к внутреннему буферу.
+ * @details QCPColorMapData хранит значения по строкам (строка - значение Y),
+ * как и SurfaceGrid, поэтому модель пишет z прямо в этот буфер без
+ * промежуточной копии и вызовов setCell.
+ */
+class SurfaceData : public QCPColorMapData {
+ public:
+  using QCPColorMapData::QCPColorMapData;
+
+  /**
+   * @brief Функция-геттер, возвращающая буфер значений для записи.
+   */
+  double *GetCells() {
+    mDataModified = true;
+    return mData;
+  }
+};
+
+}  // namespace
+
 graph::graph(QWidget *parent) : QMainWindow(parent), ui(new Ui::graph) {
   ui->setupUi(this);
 }
@@ -23,27 +49,57 @@ void graph::SetController(s21::Controller *controller) {
  * @param x_max Максимальное значение X для графика.
  * @param y_min Минимальное значение Y для графика.
  * @param y_max Максимальное значение Y для графика.
+ * @details Выражение от x и y строится как тепловая карта z = f(x, y), по
+ * узлу сетки на пиксель. Для функции от x точки не тратятся на участки,
+ * которые гарантированно вне видимой области, а у полюсов линия рвется.
  */
 void graph::build(std::string &input_expr, double x_min, double x_max,
                   double y_min, double y_max) {
   try {
-    std::vector<double> x_vector;
-    std::vector<double> y_vector;
+    QCustomPlot *plot = ui->widget_graph;
+    plot->clearPlottables();
+    plot->xAxis->setRange(x_min, x_max);
+    plot->yAxis->setRange(y_min, y_max);
+
+    if (controller_->CompileExpression(input_expr).FindVariable("y") >= 0) {
+      s21::SurfaceGrid grid;
+      grid.x_min = x_min;
+      grid.x_max = x_max;
+      grid.y_min = y_min;
+      grid.y_max = y_max;
+      grid.width = std::max(plot->width(), 2);
+      grid.height = std::max(plot->height(), 2);
 
-    controller_->GetDataForGraph(input_expr, x_min, x_max, x_vector, y_vector);
-    QVector<double> x_qvector =
-        QVector<double>(x_vector.begin(), x_vector.end());
-    QVector<double> y_qvector =
-        QVector<double>(y_vector.begin(), y_vector.end());
+      auto data = std::make_unique<SurfaceData>(
+          grid.width, grid.height, QCPRange(x_min, x_max),
+          QCPRange(y_min, y_max));
+      controller_->GetDataForSurface(input_expr, grid, data->GetCells());
+      data->recalculateDataBounds();
 
-    ui->widget_graph->clearGraphs();
-    ui->widget_graph->addGraph();
+      QCPColorMap *map = new QCPColorMap(plot->xAxis, plot->yAxis);
+      map->setData(data.release(), false);
+      map->setGradient(QCPColorGradient::gpThermal);
+      map->rescaleDataRange();
+    } else {
+      std::vector<double> x_vector;
+      std::vector<double> y_vector;
 
-    ui->widget_graph->xAxis->setRange(x_min, x_max);
-    ui->widget_graph->yAxis->setRange(y_min, y_max);
+      s21::AdaptiveSampling settings;
+      settings.x_pixel = (x_max - x_min) / plot->width();
+      settings.y_pixel = (y_max - y_min) / plot->height();
+      settings.y_min = y_min;
+      settings.y_max = y_max;
+      controller_->GetAdaptiveDataForGraph(input_expr, x_min, x_max, settings,
+                                           x_vector, y_vector);
+      QVector<double> x_qvector =
+          QVector<double>(x_vector.begin(), x_vector.end());
+      QVector<double> y_qvector =
+          QVector<double>(y_vector.begin(), y_vector.end());
 
-    ui->widget_graph->graph(0)->setData(x_qvector, y_qvector);
-    ui->widget_graph->replot();
+      plot->addGraph();
+      plot->graph(0)->setData(x_qvector, y_qvector);
+    }
+    plot->replot();
   } catch (const std::exception &ex) {
     QMessageBox::warning(this, "Error", ex.what());
     throw;
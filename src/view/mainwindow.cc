@@ -1,5 +1,8 @@
 #include "mainwindow.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "./ui_mainwindow.h"
 
 MainWindow::MainWindow(QWidget *parent)
@@ -27,6 +30,7 @@ std::string MainWindow::GetXString() const {
 /* Сеттер, задающий вычисленный ответ. */
 void MainWindow::SetAnswer(double answer) {
   ui->label_result->setText(QString::number(answer, 'g', 10));
+  ui->label_result->setToolTip("");
 }
 
 /* Соединение всех сигналов от нажатия кнопок со слотами. */
@@ -136,7 +140,8 @@ void MainWindow::on_pushButton_eq_clicked() {
 }
 
 /* Действия при нажатии на кнопку "build": обращение к контроллеру и построение
- * графика.*/
+ * графика. Если поля границ по Y пустые, границы вычисляются автоматически по
+ * гарантированной интервальной оценке значений функции. */
 void MainWindow::on_pushButton_build_3_clicked() {
   bool x_min_check, x_max_check, y_min_check, y_max_check;
   double x_min = ui->lineEdit_x_min->text().toDouble(&x_min_check);
@@ -144,6 +149,28 @@ void MainWindow::on_pushButton_build_3_clicked() {
   double y_min = ui->lineEdit_y_min->text().toDouble(&y_min_check);
   double y_max = ui->lineEdit_y_max->text().toDouble(&y_max_check);
   std::string input_str = GetInputString();
+  bool auto_y = ui->lineEdit_y_min->text().trimmed().isEmpty() &&
+                ui->lineEdit_y_max->text().trimmed().isEmpty();
+
+  if (auto_y && x_min_check && x_max_check && x_min < x_max) {
+    try {
+      s21::Interval range =
+          controller_.GetRangeForGraph(input_str, x_min, x_max);
+      y_min_check = y_max_check = !range.IsEmpty() &&
+                                  std::isfinite(range.low) &&
+                                  std::isfinite(range.high);
+      double scale = std::max(std::fabs(range.low), 1.0);
+      double margin = (range.high - range.low) / 20;
+      if (margin < 1e-6 * scale) {
+        margin = scale;
+      }
+      y_min = range.low - margin;
+      y_max = range.high + margin;
+    } catch (const std::exception &ex) {
+      QMessageBox::warning(this, "Error", ex.what());
+      return;
+    }
+  }
 
   if (!(x_min_check && x_max_check && y_min_check && y_max_check) ||
       x_min >= x_max || y_min >= y_max) {
@@ -156,3 +183,33 @@ void MainWindow::on_pushButton_build_3_clicked() {
     }
   }
 }
+
+/* Действия при нажатии на кнопку "integrate": вычисление определенного
+ * интеграла по границам X графика. Оценка ошибки и количество вычислений
+ * функции показываются во всплывающей подсказке к ответу. */
+void MainWindow::on_pushButton_integrate_clicked() {
+  bool a_check, b_check;
+  double a = ui->lineEdit_x_min->text().toDouble(&a_check);
+  double b = ui->lineEdit_x_max->text().toDouble(&b_check);
+  if (!a_check || !b_check) {
+    QMessageBox::warning(this, "Error", "Incorrect borders for integral");
+    return;
+  }
+  try {
+    s21::IntegrationResult result =
+        controller_.Integrate(GetInputString(), a, b);
+    SetAnswer(result.value);
+    ui->label_result->setToolTip(
+        QString("error estimate: %1, evaluations: %2")
+            .arg(result.error, 0, 'g', 3)
+            .arg(result.evaluations));
+    if (!result.converged) {
+      QMessageBox::warning(
+          this, "Warning",
+          QString("Integral did not reach the tolerance, error estimate: %1")
+              .arg(result.error, 0, 'g', 3));
+    }
+  } catch (const std::exception &ex) {
+    QMessageBox::warning(this, "Error", ex.what());
+  }
+}
@@ -62,6 +62,8 @@ class MainWindow : public QMainWindow {
   void on_pushButton_eq_clicked();
 
   void on_pushButton_build_3_clicked();
+
+  void on_pushButton_integrate_clicked();
 };
 
 #endif  // MAINWINDOW_H